@@ -0,0 +1,73 @@
+#include "adaptiveThreshold.hpp"
+
+#include <string>
+#include <cassert>
+#include <cmath>
+
+#include "api/api_sfm.hpp"
+#include "api/api_photoshop.hpp"
+#include "api/api_bar.hpp"
+#include "api/api_canvas.hpp"
+
+#include "pluginLib/bars/ps_bar.hpp"
+#include "pluginLib/filters/filters.hpp"
+#include "pluginLib/filters/sliderFilterButton.hpp"
+
+using namespace ps;
+using namespace psapi;
+using namespace psapi::sfm;
+
+namespace
+{
+
+const char* const kAdaptiveThresholdTitle = "Adaptive Threshold";
+
+// parameters - window radius, offset below the local mean in luminance levels
+Pixels2D adaptiveThresholdFilter(const Pixels2D& pixels, const std::vector<float>& parameters, float scale)
+{
+    assert(parameters.size() == 2);
+
+    long radius = std::max(std::lround(parameters[0] * scale), 1l);
+
+    return getAdaptiveThreshold(pixels, static_cast<int>(radius), static_cast<int>(std::lround(parameters[1])));
+}
+
+size_t adaptiveThresholdHalo(const std::vector<float>& parameters)
+{
+    assert(parameters.size() == 2);
+
+    return static_cast<size_t>(std::lround(parameters[0]));
+}
+
+} // namespace anonymous
+
+bool onLoadPlugin()
+{
+    std::unique_ptr<IText> text = IText::create();
+    std::unique_ptr<IFont> font = IFont::create();
+    font->loadFromFile("assets/fonts/arial.ttf");
+    text->setFont(font.get());
+
+    const float maxRadius = 100;
+    const float maxOffset = 50;
+    std::vector<SliderParameters> sliders = {{"Radius: ", 1, maxRadius, 15},
+                                             {"Offset: ", -maxOffset, maxOffset, 5}};
+
+    auto button = std::make_unique<SliderFilterButton>(std::move(text), std::move(font), kAdaptiveThresholdTitle,
+                                                       std::move(sliders), adaptiveThresholdFilter,
+                                                       adaptiveThresholdHalo);
+
+    IWindowContainer* rootWindow = getRootWindow();
+    assert(rootWindow);
+    auto filterMenu = dynamic_cast<IMenuButton*>(rootWindow->getWindowById(kMenuFilterId));
+    assert(filterMenu);
+
+    filterMenu->addMenuItem(std::move(button));
+
+    return true;
+}
+
+void onUnloadPlugin()
+{
+    return;
+}
@@ -0,0 +1,12 @@
+#ifndef PLUGINS_ADAPTIVE_THRESHOLD_ADAPTIVE_THRESHOLD_HPP
+#define PLUGINS_ADAPTIVE_THRESHOLD_ADAPTIVE_THRESHOLD_HPP
+
+extern "C"
+{
+
+bool onLoadPlugin();
+void onUnloadPlugin();
+
+}
+
+#endif // PLUGINS_ADAPTIVE_THRESHOLD_ADAPTIVE_THRESHOLD_HPP
\ No newline at end of file
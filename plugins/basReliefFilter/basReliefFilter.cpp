@@ -4,18 +4,21 @@
 
 #include <string>
 #include <cassert>
+#include <cmath>
 
 #include "api/api_sfm.hpp"
 #include "api/api_photoshop.hpp"
 #include "api/api_bar.hpp"
 #include "api/api_canvas.hpp"
 
-#include "pluginLib/actions/actions.hpp"
 #include "pluginLib/canvas/canvas.hpp"
 #include "pluginLib/bars/ps_bar.hpp"
 #include "pluginLib/windows/windows.hpp"
 
+#include "pluginLib/filters/edgeDetection.hpp"
 #include "pluginLib/filters/filters.hpp"
+#include "pluginLib/filters/gaussianBlur.hpp"
+#include "pluginLib/filters/sliderFilterButton.hpp"
 
 #include <iostream>
 
@@ -26,72 +29,60 @@ using namespace psapi::sfm;
 namespace
 {
 
-class BasReliefButton : public ANamedBarButton 
+// parameters - sigma, low threshold, high threshold
+std::vector<std::vector<Color>> cannyFilter(const std::vector<std::vector<Color>>& pixels,
+                                            const std::vector<float>& parameters, float scale)
 {
-public:
-    BasReliefButton(std::unique_ptr<IText> name, std::unique_ptr<IFont> font);
+    assert(parameters.size() == 3);
 
-    std::unique_ptr<IAction> createAction(const IRenderWindow* renderWindow, 
-                                          const Event& event) override;
-    
-    bool update(const IRenderWindow* renderWindow, const Event& event);
-};
-
-BasReliefButton::BasReliefButton(std::unique_ptr<IText> name, std::unique_ptr<IFont> font)
-{
-    name_ = std::move(name);
-    font_ = std::move(font);
+    return getCannyEdges(pixels, parameters[0] * scale, static_cast<int>(std::lround(parameters[1])),
+                         static_cast<int>(std::lround(parameters[2])));
 }
 
-std::unique_ptr<IAction> BasReliefButton::createAction(const IRenderWindow* renderWindow, 
-                                                        const Event& event)
+// blur, then the 3x3 Sobel of the blurred pixels
+size_t cannyHalo(const std::vector<float>& parameters)
 {
-    return std::make_unique<UpdateCallbackAction<BasReliefButton>>(*this, renderWindow, event);
+    return getGaussianReach(parameters[0]) + 1;
 }
 
-bool BasReliefButton::update(const IRenderWindow* renderWindow, const Event& event)
+void createFonts(std::unique_ptr<IText>& text, std::unique_ptr<IFont>& font)
 {
-    bool updateStateRes = updateState(renderWindow, event);
-
-    if (state_ != State::Released)
-        return updateStateRes;
-
-    ICanvas* canvas = static_cast<ICanvas*>(getRootWindow()->getWindowById(kCanvasWindowId));
-    assert(canvas);
-    
-    size_t activeLayerIndex = canvas->getActiveLayerIndex();
-    ILayer* activeLayer = canvas->getLayer(activeLayerIndex);
-
-    vec2u canvasSize = canvas->getSize();
-
-    std::vector<std::vector<Color>> pixels = getLayerScreenIn2D(activeLayer, canvasSize);
-    std::vector<std::vector<Color>> basRelief = getBasRelief(pixels, getNegative(pixels));
-    
-    copyPixelsToLayer(activeLayer, basRelief);
-    
-    state_ = State::Normal;
-
-    return true;
+    text = IText::create();
+    font = IFont::create();
+    font->loadFromFile("assets/fonts/arial.ttf");
+    text->setFont(font.get());
 }
 
 } // namespace anonymous
 
 bool onLoadPlugin()
 {
-    std::unique_ptr<IText> text = IText::create();
-    std::unique_ptr<IFont> font = IFont::create();
-    font->loadFromFile("assets/fonts/arial.ttf");
-    text->setFont(font.get());
-    text->setString("Bas Relief");
-    
-    auto button = std::make_unique<BasReliefButton>(std::move(text), std::move(font));
+    std::unique_ptr<IText> text;
+    std::unique_ptr<IFont> font;
 
     IWindowContainer* rootWindow = getRootWindow();
     assert(rootWindow);
     auto filterMenu = static_cast<IMenuButton*>(rootWindow->getWindowById(kMenuFilterId));
     assert(filterMenu);
 
-    filterMenu->addMenuItem(std::move(button));
+    createFonts(text, font);
+    filterMenu->addMenuItem(std::make_unique<FilterButton>(std::move(text), std::move(font), "Bas Relief", 1,
+                                                           getBasRelief));
+
+    // gradient based filters are kept next to each other
+    createFonts(text, font);
+    filterMenu->addMenuItem(std::make_unique<FilterButton>(std::move(text), std::move(font), "Sobel Edges", 1,
+                                                           getSobelMagnitude));
+
+    const float maxSigma = 5;
+    std::vector<SliderParameters> sliders = {{"Sigma: ", 0, maxSigma, 1.4f, 0.1f},
+                                             {"Low: ", 0, 255, 20},
+                                             {"High: ", 0, 255, 60}};
+
+    createFonts(text, font);
+    filterMenu->addMenuItem(std::make_unique<SliderFilterButton>(std::move(text), std::move(font), "Canny Edges",
+                                                                 std::move(sliders), cannyFilter, cannyHalo,
+                                                                 FilterPreview::getWholeLayerTiling));
 
     return true;
 }
@@ -1,24 +1,26 @@
 #include "pluginLib/bars/ps_bar.hpp"
 
 #include "blurFilter.hpp"
-#include "pluginLib/filters/slider.hpp"
 
+#include <algorithm>
 #include <string>
 #include <cassert>
+#include <cmath>
 
 #include "api/api_sfm.hpp"
 #include "api/api_photoshop.hpp"
 #include "api/api_bar.hpp"
 #include "api/api_canvas.hpp"
 
-#include "pluginLib/actions/actions.hpp"
 #include "pluginLib/canvas/canvas.hpp"
 #include "pluginLib/bars/ps_bar.hpp"
 #include "pluginLib/windows/windows.hpp"
-#include "pluginLib/timer/timer.hpp"
 #include "pluginLib/filters/filters.hpp"
-
-#include "pluginLib/filters/filterWindows.hpp"
+#include "pluginLib/filters/bilateralGrid.hpp"
+#include "pluginLib/filters/convolution.hpp"
+#include "pluginLib/filters/directionalBlur.hpp"
+#include "pluginLib/filters/gaussianBlur.hpp"
+#include "pluginLib/filters/sliderFilterButton.hpp"
 
 #include <iostream>
 
@@ -29,122 +31,210 @@ using namespace psapi::sfm;
 namespace
 {
 
-class BlurFilterButton : public ANamedBarButton 
+const char* const kBlurTitle = "Box Blur";
+const char* const kBilateralBlurTitle = "Bilateral Blur";
+const char* const kLensBlurTitle = "Lens Blur";
+const char* const kGaussianBlurTitle = "Gaussian Blur";
+const char* const kMotionBlurTitle = "Motion Blur";
+const char* const kRadialBlurTitle = "Radial Blur";
+
+// indexed by the "Mode" slider of radial blur
+const RadialBlurMode kRadialBlurModes[] = {
+    RadialBlurMode::Spin,
+    RadialBlurMode::Zoom,
+};
+
+const size_t kRadialBlurModesCount = sizeof(kRadialBlurModes) / sizeof(kRadialBlurModes[0]);
+
+std::vector<std::vector<Color>> blurFilter(const std::vector<std::vector<Color>>& pixels, 
+                                           const std::vector<float>& parameters, float scale)
+{
+    assert(parameters.size() == 1);
+
+    int radius = static_cast<int>(std::lround(parameters[0] * scale));
+
+    return getBoxBlured(pixels, radius, radius);
+}
+
+size_t blurHalo(const std::vector<float>& parameters)
 {
-public:
-    BlurFilterButton(std::unique_ptr<IText> name, std::unique_ptr<IFont> font);
+    assert(parameters.size() == 1);
 
-    std::unique_ptr<IAction> createAction(const IRenderWindow* renderWindow, 
-                                          const Event& event) override;
-    
-    bool update(const IRenderWindow* renderWindow, const Event& event);
-    void draw(IRenderWindow* renderWindow) override;
+    return static_cast<size_t>(std::lround(parameters[0]));
+}
 
-private:
-    std::vector<std::vector<Color>> beginLayer_;
+// parameters - spatial sigma, range sigma. Grid cells are aligned to the layer, so the tiles match.
+std::vector<std::vector<Color>> bilateralBlurFilter(const std::vector<std::vector<Color>>& pixels,
+                                                    const std::vector<float>& parameters, float scale,
+                                                    const LayerPlacement& placement)
+{
+    assert(parameters.size() == 2);
 
-    std::unique_ptr<FilterWindow> filterWindow_;
-    Timer timer_;
+    float spatialSigma = std::max(parameters[0] * scale, 1.f);
 
-};
+    vec2i origin = {static_cast<int>(std::lround(static_cast<float>(placement.pos.x) * scale)),
+                    static_cast<int>(std::lround(static_cast<float>(placement.pos.y) * scale))};
 
-BlurFilterButton::BlurFilterButton(std::unique_ptr<IText> name, std::unique_ptr<IFont> font)
+    return getBilateralFiltered(pixels, spatialSigma, parameters[1], origin);
+}
+
+// grid blur reaches two cells, slicing one more
+size_t bilateralBlurHalo(const std::vector<float>& parameters)
+{
+    assert(parameters.size() == 2);
+
+    return static_cast<size_t>(std::ceil(3 * parameters[0]));
+}
+
+std::vector<std::vector<Color>> gaussianBlurFilter(const std::vector<std::vector<Color>>& pixels,
+                                                   const std::vector<float>& parameters, float scale)
 {
-    name_ = std::move(name);
-    font_ = std::move(font);
+    assert(parameters.size() == 1);
+
+    return getGaussianBlured(pixels, parameters[0] * scale);
 }
 
-std::unique_ptr<IAction> BlurFilterButton::createAction(const IRenderWindow* renderWindow, 
-                                                        const Event& event)
+size_t gaussianBlurHalo(const std::vector<float>& parameters)
 {
-    return std::make_unique<UpdateCallbackAction<BlurFilterButton>>(*this, renderWindow, event);
+    assert(parameters.size() == 1);
+
+    return getGaussianReach(parameters[0]);
 }
 
-bool BlurFilterButton::update(const IRenderWindow* renderWindow, const Event& event)
+// flat disk kernel, big ones are convolved through FFT
+std::vector<std::vector<Color>> lensBlurFilter(const std::vector<std::vector<Color>>& pixels,
+                                               const std::vector<float>& parameters, float scale)
 {
-    bool updateStateRes = updateState(renderWindow, event);
+    assert(parameters.size() == 1);
+
+    int radius = static_cast<int>(std::lround(parameters[0] * scale));
+    int size   = 2 * radius + 1;
 
-    if (state_ != State::Released)
+    RuntimeKernel kernel;
+    kernel.size = static_cast<size_t>(size);
+    kernel.divisor = 0;
+
+    for (int y = -radius; y <= radius; ++y)
     {
-        if (filterWindow_)
+        for (int x = -radius; x <= radius; ++x)
         {
-            filterWindow_->close();
-            filterWindow_.reset();
-        }
+            int weight = x * x + y * y <= radius * radius ? 1 : 0;
 
-        return updateStateRes;
+            kernel.weights.push_back(weight);
+            kernel.divisor += weight;
+        }
     }
 
-    ICanvas* canvas = static_cast<ICanvas*>(getRootWindow()->getWindowById(kCanvasWindowId));
-    assert(canvas);
-    
-    size_t activeLayerIndex = canvas->getActiveLayerIndex();
-    ILayer* activeLayer = canvas->getLayer(activeLayerIndex);
+    return convolve(pixels, kernel, AlphaMode::Convolve);
+}
 
-    vec2u canvasSize = canvas->getSize();
+// parameters - angle, distance
+std::vector<std::vector<Color>> motionBlurFilter(const std::vector<std::vector<Color>>& pixels,
+                                                 const std::vector<float>& parameters, float scale)
+{
+    assert(parameters.size() == 2);
 
-    if (updateStateRes)
-    {
-        timer_.start();
-        beginLayer_ = getLayerScreenIn2D(activeLayer, canvasSize);
-        filterWindow_ = createSimpleFilterWindow("Box Blur");
-    }
+    return getMotionBlured(pixels, parameters[0], parameters[1] * scale);
+}
 
-    assert(filterWindow_);
+size_t motionBlurHalo(const std::vector<float>& parameters)
+{
+    assert(parameters.size() == 2);
 
-    AActionController* actionController = getActionController();
+    return static_cast<size_t>(std::ceil(parameters[1] / 2)) + 1;
+}
 
-    if (!actionController->execute(filterWindow_->createAction(renderWindow, event)))
-    {
-        state_ = State::Normal;
-        return false;
-    }
+// parameters - amount, mode, center x and y in percents of the layer size. Amount is the angle in degrees
+// for spin and percents of the distance to the center for zoom, both don't depend on the proxy scale.
+std::vector<std::vector<Color>> radialBlurFilter(const std::vector<std::vector<Color>>& pixels,
+                                                 const std::vector<float>& parameters, float scale,
+                                                 const LayerPlacement& placement)
+{
+    assert(parameters.size() == 4);
 
-    static const long long waitTime = 2000;
+    if (pixels.empty())
+        return pixels;
 
-    if (timer_.deltaInMs() < waitTime)
-        return false;
+    long mode = std::clamp(std::lround(parameters[1]), 0l, static_cast<long>(kRadialBlurModesCount - 1));
+    RadialBlurMode blurMode = kRadialBlurModes[mode];
 
-    timer_.start();    
-    NamedSlider* radiusSlider = dynamic_cast<NamedSlider*>(filterWindow_->getWindowById(kRadiusSliderId));
-    
-    if (radiusSlider)
-    {
-        int radius = static_cast<int>(radiusSlider->getCurrentValue());
+    float amount = blurMode == RadialBlurMode::Spin ? parameters[0] : parameters[0] / 100.f;
 
-        std::vector<std::vector<Color>> blured = getBoxBlured(beginLayer_, radius, radius);
-        
-        copyPixelsToLayer(activeLayer, blured);
-    }
+    // in the layer, then relative to the pixels at their scale
+    vec2f layerCenter = {parameters[2] / 100.f * static_cast<float>(placement.layerSize.x - 1),
+                         parameters[3] / 100.f * static_cast<float>(placement.layerSize.y - 1)};
 
-    return true;
+    vec2f center = {(layerCenter.x - static_cast<float>(placement.pos.x)) * scale,
+                    (layerCenter.y - static_cast<float>(placement.pos.y)) * scale};
+
+    return getRadialBlured(pixels, blurMode, center, amount);
 }
 
-void BlurFilterButton::draw(IRenderWindow* renderWindow)
+size_t noHalo(const std::vector<float>&)
 {
-    ANamedBarButton::draw(renderWindow);
-
-    if (filterWindow_)
-        filterWindow_->draw(renderWindow);
+    return 0;
 }
-} // namespace anonymous
 
-bool onLoadPlugin()
+template <typename Filter>
+std::unique_ptr<SliderFilterButton> createBlurButton(const char* title, std::vector<SliderParameters> sliders,
+                                                     Filter filter, FilterPreview::Halo halo,
+                                                     FilterPreview::Tiling tiling = nullptr)
 {
     std::unique_ptr<IText> text = IText::create();
     std::unique_ptr<IFont> font = IFont::create();
     font->loadFromFile("assets/fonts/arial.ttf");
     text->setFont(font.get());
-    text->setString("Box Blur");
-    
-    auto button = std::make_unique<BlurFilterButton>(std::move(text), std::move(font));
 
+    return std::make_unique<SliderFilterButton>(std::move(text), std::move(font), title,
+                                                std::move(sliders), std::move(filter), std::move(halo),
+                                                std::move(tiling));
+}
+
+} // namespace anonymous
+
+bool onLoadPlugin()
+{
     IWindowContainer* rootWindow = getRootWindow();
     assert(rootWindow);
     auto filterMenu = dynamic_cast<IMenuButton*>(rootWindow->getWindowById(kMenuFilterId));
     assert(filterMenu);
 
-    filterMenu->addMenuItem(std::move(button));
+    // wide radii are blurred through summed area table, cost doesn't grow with them
+    const float maxRadius = 50;
+    filterMenu->addMenuItem(createBlurButton(kBlurTitle, {{"Radius: ", 0, maxRadius, 0}},
+                                             blurFilter, blurHalo));
+
+    // grid has a cell per spatial sigma square and range sigma levels, smaller sigmas make it
+    // bigger than the tile itself
+    const float minSpatialSigma = 4;
+    const float maxSpatialSigma = 32;
+    const float minRangeSigma   = 8;
+    const float maxRangeSigma   = 128;
+    filterMenu->addMenuItem(createBlurButton(kBilateralBlurTitle, {{"Spatial: ", minSpatialSigma, maxSpatialSigma, 8},
+                                                                   {"Range: ",   minRangeSigma,   maxRangeSigma,   20}},
+                                             bilateralBlurFilter, bilateralBlurHalo));
+
+    const float maxSigma = 50;
+    filterMenu->addMenuItem(createBlurButton(kGaussianBlurTitle, {{"Radius: ", 0, maxSigma, 4}},
+                                             gaussianBlurFilter, gaussianBlurHalo));
+
+    const float maxLensRadius = 50;
+    filterMenu->addMenuItem(createBlurButton(kLensBlurTitle, {{"Radius: ", 0, maxLensRadius, 10}},
+                                             lensBlurFilter, blurHalo));
+
+    // running sums along the lines, cost doesn't grow with the distance
+    const float maxDistance = 200;
+    filterMenu->addMenuItem(createBlurButton(kMotionBlurTitle, {{"Angle: ",    0, 180,         0},
+                                                                {"Distance: ", 0, maxDistance, 20}},
+                                             motionBlurFilter, motionBlurHalo));
+
+    // mode: 0 - spin, 1 - zoom. Samples reach across the whole layer, so the committed filter gets it in one tile
+    const float maxMode = static_cast<float>(kRadialBlurModesCount - 1);
+    filterMenu->addMenuItem(createBlurButton(kRadialBlurTitle, {{"Amount: ",     0, 100,     10},
+                                                                {"Mode: ",       0, maxMode, 0},
+                                                                {"Center X %: ", 0, 100,     50},
+                                                                {"Center Y %: ", 0, 100,     50}},
+                                             radialBlurFilter, noHalo, FilterPreview::getWholeLayerTiling));
 
     return true;
 }
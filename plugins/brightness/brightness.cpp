@@ -5,13 +5,20 @@
 #include "pluginLib/actions/actions.hpp"
 #include "pluginLib/filters/filters.hpp"
 #include "pluginLib/filters/filterWindows.hpp"
+#include "pluginLib/filters/filterGraph.hpp"
+#include "pluginLib/filters/filterPreview.hpp"
 #include "pluginLib/timer/timer.hpp"
 #include "pluginLib/canvas/canvas.hpp"
 #include "pluginLib/filters/slider.hpp"
 #include "catmullRom.hpp"
 
 #include <cassert>
+#include <cmath>
 #include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
 
 using namespace ps;
 using namespace psapi;
@@ -22,6 +29,7 @@ namespace
 {
 
 static const wid_t kGraphId = 88819302;
+static const char* const kBrightnessTitle = "Brightness Filter";
 
 class InteractivePoint : public ABarButton
 {
@@ -50,6 +58,17 @@ static const vec2i deltaFromGraphSpritePos = {63, 4};
 static const vec2u deltaFromGraphSpriteSize = {80, 56};
 static const int kInteractivePointRadius = 7;
 
+// Converts interpolator points to the filter data. Plain copy of the graph geometry,
+// so filter jobs never touch the graph window.
+struct GraphDataMapping
+{
+    vec2i pos;
+    vec2u size;
+    vec2f steps;
+
+    vec2f operator()(vec2f point) const;
+};
+
 class Graph : public AWindow
 {
 public:
@@ -69,7 +88,9 @@ public:
     void setSize(const vec2u& size) override;
 
     const CatmullRom& getInterpolator() const & { return catmullRom_; }
+    std::vector<float> getParameters() const;
     vec2f recalculateInterpolatorPointToData(vec2f point) const;
+    GraphDataMapping getDataMapping() const;
 
 private:
     CatmullRom catmullRom_;
@@ -171,6 +192,19 @@ void Graph::movePoint(vec2i point, vec2i newPos) { catmullRom_.setPoint(vec2f{(f
 
 vec2f Graph::getGraphSteps() const { return graphSteps_; }
 
+std::vector<float> Graph::getParameters() const
+{
+    std::vector<float> parameters;
+
+    for (const vec2f& point : catmullRom_.getPoints())
+    {
+        parameters.push_back(point.x);
+        parameters.push_back(point.y);
+    }
+
+    return parameters;
+}
+
 void Graph::setPos(const vec2i& pos)
 {
     AWindow::setPos(pos);
@@ -187,8 +221,20 @@ void Graph::setSize(const vec2u& size)
 
 vec2f Graph::recalculateInterpolatorPointToData(vec2f point) const
 {
-    return vec2f{((point.x - (float)pos_.x - (float)deltaFromGraphSpritePos.x - kInteractivePointRadius) * graphSteps_.x),
-                 ((float)pos_.y + (float)size_.y - point.y - (float)deltaFromGraphSpritePos.y) * graphSteps_.y};
+    return getDataMapping()(point);
+}
+
+GraphDataMapping Graph::getDataMapping() const
+{
+    return GraphDataMapping{pos_, size_, graphSteps_};
+}
+
+// Graph data mapping implementation
+
+vec2f GraphDataMapping::operator()(vec2f point) const
+{
+    return vec2f{((point.x - (float)pos.x - (float)deltaFromGraphSpritePos.x - kInteractivePointRadius) * steps.x),
+                 ((float)pos.y + (float)size.y - point.y - (float)deltaFromGraphSpritePos.y) * steps.y};
 }
 // Interactive point implementation
 
@@ -418,9 +464,10 @@ public:
     void draw(IRenderWindow* renderWindow) override;
 
 private:
-    std::vector<std::vector<Color>> beginLayer_;
-
     std::unique_ptr<FilterWindow> filterWindow_;
+    FilterPreview preview_;
+
+    std::shared_ptr<TiledLayerFilter> commitRun_;
 };
 
 std::unique_ptr<FilterWindow> createFilterWindow(const char* name)
@@ -461,28 +508,43 @@ std::unique_ptr<IAction> BrightnessFilter::createAction(const IRenderWindow* ren
     return std::make_unique<UpdateCallbackAction<BrightnessFilter>>(*this, renderWindow, event);
 }
 
-void setBrightness(std::vector<std::vector<Color>>& pixels, unsigned fromX, unsigned toX, float brightness)
+// Gain curve compiled into a bank of gain tables and index of the table for every canvas column
+struct CompiledBrightness
 {
-    for (unsigned y = 0; y < pixels.size(); ++y)
-    {
-        for (unsigned x = fromX; x < toX; ++x)
-        {
-            if (x >= pixels[y].size())
-                break;
-            
-            pixels[y][x].r = std::clamp(static_cast<int>(pixels[y][x].r * brightness), 0, 255);
-            pixels[y][x].g = std::clamp(static_cast<int>(pixels[y][x].g * brightness), 0, 255);
-            pixels[y][x].b = std::clamp(static_cast<int>(pixels[y][x].b * brightness), 0, 255);
-        }
-    }
-}
+    std::vector<ChannelsLut> bank;
+    std::vector<uint8_t> columnIndex;
+};
+
+// Gain of the curve over canvas columns [fromX, toX)
+struct GainSegment
+{
+    unsigned fromX;
+    unsigned toX;
+    float gain;
+};
 
-std::vector<std::vector<Color>> applyBrightness(const std::vector<std::vector<Color>>& pixels, 
-                                                const Graph* graph)
+// Key of a table in the bank, alpha is never changed by the gains
+std::string getTableKey(const ChannelsLut& lut)
 {
-    const CatmullRom& interpolator = graph->getInterpolator();
+    std::string key;
+    key.reserve(3 * 256);
 
-    std::vector<std::vector<Color>> result = pixels;
+    key.append(lut.r.begin(), lut.r.end());
+    key.append(lut.g.begin(), lut.g.end());
+    key.append(lut.b.begin(), lut.b.end());
+
+    return key;
+}
+
+// Every column gets the gain tables of all the curve segments covering it composed in the curve order,
+// each one clamped, as the per column tables did. Columns change their segments only at the segment
+// ends, so the tables are composed per run of columns between them and equal tables are shared.
+// Only more than 256 distinct tables are quantized by the total gain of the runs.
+std::shared_ptr<const CompiledBrightness> compileBrightness(const CatmullRom& interpolator, 
+                                                            const GraphDataMapping& toData, unsigned width)
+{
+    std::vector<GainSegment> segments;
+    std::vector<unsigned> ends = {0, width};
 
     double step = 0.01;
     vec2f prevPoint = interpolator[1.0];
@@ -490,47 +552,245 @@ std::vector<std::vector<Color>> applyBrightness(const std::vector<std::vector<Co
     {
         vec2f point = interpolator[a];
 
-        unsigned fromX = static_cast<unsigned>(graph->recalculateInterpolatorPointToData(prevPoint).x);
-        unsigned toX = static_cast<unsigned>(graph->recalculateInterpolatorPointToData(point).x);
-        #if 0
-        fprintf(stderr, "POINT - %u %u\n", static_cast<unsigned>(point.x), static_cast<unsigned>(point.y));
-        fprintf(stderr, "FROM %u TO %u\n", fromX, toX);
-        #endif
+        unsigned fromX = std::min(static_cast<unsigned>(std::max(toData(prevPoint).x, 0.f)), width);
+        unsigned toX = std::min(static_cast<unsigned>(std::max(toData(point).x, 0.f)), width);
+
+        if (fromX < toX)
+        {
+            segments.push_back(GainSegment{fromX, toX, toData(point).y});
+            ends.push_back(fromX);
+            ends.push_back(toX);
+        }
 
-        setBrightness(result, fromX, toX, graph->recalculateInterpolatorPointToData(point).y);
         prevPoint = point;
     }
 
-    return result;
+    std::sort(ends.begin(), ends.end());
+    ends.erase(std::unique(ends.begin(), ends.end()), ends.end());
+
+    auto compiled = std::make_shared<CompiledBrightness>();
+    compiled->columnIndex.resize(width);
+
+    if (width == 0)
+        return compiled;
+
+    // runs of columns [ends[i], ends[i + 1])
+    size_t runsCount = ends.size() - 1;
+
+    std::vector<ChannelsLut> tables;
+    std::vector<size_t> runTable(runsCount);
+    std::vector<float> runGain(runsCount, 1.f);
+
+    std::map<std::string, size_t> tableByKey;
+
+    for (size_t run = 0; run < runsCount; ++run)
+    {
+        ChannelsLut lut = ChannelsLut::identity();
+
+        for (const GainSegment& segment : segments)
+        {
+            if (segment.fromX <= ends[run] && ends[run + 1] <= segment.toX)
+            {
+                lut = lut.then(makeGainLut(segment.gain));
+                runGain[run] *= segment.gain;
+            }
+        }
+
+        auto [found, isInserted] = tableByKey.emplace(getTableKey(lut), tables.size());
+        if (isInserted)
+            tables.push_back(lut);
+
+        runTable[run] = found->second;
+    }
+
+    const size_t kMaxTables = 256;
+
+    if (tables.size() > kMaxTables)
+    {
+        // the first run of a gain level gives the table of the level
+        auto [minGain, maxGain] = std::minmax_element(runGain.begin(), runGain.end());
+        float gainStep = (*maxGain - *minGain) / static_cast<float>(kMaxTables - 1);
+
+        std::vector<int> levelTable(kMaxTables, -1);
+        std::vector<ChannelsLut> quantized;
+
+        for (size_t run = 0; run < runsCount; ++run)
+        {
+            size_t level = gainStep > 0.f ? static_cast<size_t>(std::lround((runGain[run] - *minGain) / gainStep)) : 0;
+            level = std::min(level, kMaxTables - 1);
+
+            if (levelTable[level] < 0)
+            {
+                levelTable[level] = static_cast<int>(quantized.size());
+                quantized.push_back(tables[runTable[run]]);
+            }
+
+            runTable[run] = static_cast<size_t>(levelTable[level]);
+        }
+
+        tables = std::move(quantized);
+    }
+
+    compiled->bank = std::move(tables);
+
+    for (size_t run = 0; run < runsCount; ++run)
+    {
+        for (unsigned x = ends[run]; x < ends[run + 1]; ++x)
+            compiled->columnIndex[x] = static_cast<uint8_t>(runTable[run]);
+    }
+
+    return compiled;
+}
+
+// Keeps the last compiled curve: proxy levels and full resolution of one edit share the tables
+class BrightnessCompiler
+{
+public:
+    BrightnessCompiler(const GraphDataMapping& toData, unsigned canvasWidth);
+
+    std::shared_ptr<const CompiledBrightness> get(const std::vector<float>& parameters);
+
+private:
+    GraphDataMapping toData_;
+    unsigned canvasWidth_;
+
+    std::mutex mutex_;
+    std::vector<float> parameters_;
+    std::shared_ptr<const CompiledBrightness> compiled_;
+};
+
+BrightnessCompiler::BrightnessCompiler(const GraphDataMapping& toData, unsigned canvasWidth)
+    : toData_(toData), canvasWidth_(canvasWidth)
+{
+}
+
+std::vector<vec2f> getCurvePoints(const std::vector<float>& parameters)
+{
+    assert(parameters.size() % 2 == 0);
+
+    std::vector<vec2f> points;
+
+    for (size_t i = 0; i + 1 < parameters.size(); i += 2)
+        points.push_back(vec2f{parameters[i], parameters[i + 1]});
+
+    return points;
+}
+
+std::shared_ptr<const CompiledBrightness> BrightnessCompiler::get(const std::vector<float>& parameters)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (!compiled_ || parameters != parameters_)
+    {
+        parameters_ = parameters;
+        compiled_ = compileBrightness(CatmullRom{getCurvePoints(parameters)}, toData_, canvasWidth_);
+    }
+
+    return compiled_;
+}
+
+// scale - scale of the pixels relatively to the canvas, left - canvas column of the first pixel column.
+// The curve is drawn over the canvas, columns outside of it are kept as they are.
+Pixels2D applyBrightness(Pixels2D pixels, const CompiledBrightness& compiled, float scale, int left)
+{
+    size_t width = pixels.empty() ? 0 : pixels[0].size();
+
+    if (compiled.bank.empty() || width == 0)
+        return pixels;
+
+    const float canvasWidth = static_cast<float>(compiled.columnIndex.size());
+
+    // pixel columns [first, last) are on the canvas
+    auto getFirstColumn = [&](float canvasX)
+    {
+        float column = std::ceil((canvasX - static_cast<float>(left)) * scale);
+        return static_cast<size_t>(std::clamp(column, 0.f, static_cast<float>(width)));
+    };
+
+    size_t first = getFirstColumn(0.f);
+    size_t last  = getFirstColumn(canvasWidth);
+
+    if (first >= last)
+        return pixels;
+
+    std::vector<uint8_t> columnIndex(last - first, 0);
+
+    for (size_t x = first; x < last; ++x)
+    {
+        long canvasX = left + static_cast<long>(std::floor(static_cast<float>(x) / scale));
+        canvasX = std::clamp(canvasX, 0l, static_cast<long>(compiled.columnIndex.size()) - 1);
+
+        columnIndex[x - first] = compiled.columnIndex[static_cast<size_t>(canvasX)];
+    }
+
+    if (first == 0 && last == width)
+    {
+        applyColumnLuts(pixels, compiled.bank, columnIndex);
+        return pixels;
+    }
+
+    Pixels2D visible(pixels.size());
+    for (size_t y = 0; y < pixels.size(); ++y)
+        visible[y].assign(pixels[y].begin() + static_cast<long>(first), pixels[y].begin() + static_cast<long>(last));
+
+    applyColumnLuts(visible, compiled.bank, columnIndex);
+
+    for (size_t y = 0; y < pixels.size(); ++y)
+        std::copy(visible[y].begin(), visible[y].end(), pixels[y].begin() + static_cast<long>(first));
+
+    return pixels;
 }
 
 bool BrightnessFilter::update(const IRenderWindow* renderWindow, const Event& event)
 {
     bool updateStateRes = updateState(renderWindow, event);
 
+    ICanvas* canvas = static_cast<ICanvas*>(getRootWindow()->getWindowById(kCanvasWindowId));
+    assert(canvas);
+
     if (state_ != State::Released)
     {
         if (filterWindow_)
         {
             filterWindow_->close();
             filterWindow_.reset();
+            preview_.cancel(canvas);
         }
 
         return updateStateRes;
     }
 
-    ICanvas* canvas = static_cast<ICanvas*>(getRootWindow()->getWindowById(kCanvasWindowId));
-    assert(canvas);
-    
-    size_t activeLayerIndex = canvas->getActiveLayerIndex();
-    ILayer* activeLayer = canvas->getLayer(activeLayerIndex);
-
-    vec2u canvasSize = canvas->getSize();
-
     if (updateStateRes)
     {
-        beginLayer_ = getLayerScreenIn2D(activeLayer, canvasSize);
-        filterWindow_ = createFilterWindow("Brightness Filter");
+        // previous run is not finished yet
+        if (commitRun_ && !commitRun_->isDone())
+        {
+            state_ = State::Normal;
+            return true;
+        }
+
+        filterWindow_ = createFilterWindow(kBrightnessTitle);
+
+        const Graph* graph = dynamic_cast<const Graph*>(filterWindow_->getWindowById(kGraphId));
+        assert(graph);
+
+        // parameters are the curve control points, curve is rebuilt from them once per edit
+        auto compiler = std::make_shared<BrightnessCompiler>(graph->getDataMapping(), canvas->getSize().x);
+
+        // the curve is over the canvas as it is now, placements are in the layer
+        ILayer* layer = canvas->getLayer(canvas->getActiveLayerIndex());
+        vec2i visiblePos = layer ? getLayerVisiblePos(layer) : vec2i{0, 0};
+
+        auto brightnessFilter = [compiler, visiblePos](const Pixels2D& pixels, const std::vector<float>& parameters,
+                                                       float scale, const LayerPlacement& placement)
+        {
+            return applyBrightness(pixels, *compiler->get(parameters), scale, placement.pos.x - visiblePos.x);
+        };
+
+        // every pixel is mapped on its own
+        auto noHalo = [](const std::vector<float>& /* parameters */) { return size_t{0}; };
+
+        preview_.begin(canvas, "brightness", brightnessFilter, noHalo);
     }
 
     assert(filterWindow_);
@@ -539,6 +799,12 @@ bool BrightnessFilter::update(const IRenderWindow* renderWindow, const Event& ev
 
     if (!actionController->execute(filterWindow_->createAction(renderWindow, event)))
     {
+        if (filterWindow_->isConfirmed())
+            commitRun_ = preview_.commit(canvas);
+        else
+            preview_.cancel(canvas);
+
+        filterWindow_.reset();
         state_ = State::Normal;
         return false;
     }
@@ -548,13 +814,16 @@ bool BrightnessFilter::update(const IRenderWindow* renderWindow, const Event& ev
     if (!graph)
         return false;
 
-    copyPixelsToLayer(activeLayer, applyBrightness(beginLayer_, graph));
+    preview_.setParameters(graph->getParameters());
+    preview_.update(canvas);
     
     return true;
 }
 
 void BrightnessFilter::draw(IRenderWindow* renderWindow)
 {
+    name_->setString(getJobTitle(kBrightnessTitle, commitRun_.get()));
+
     ANamedBarButton::draw(renderWindow);
 
     if (filterWindow_)
@@ -570,7 +839,7 @@ bool onLoadPlugin()
     std::unique_ptr<IFont> font = IFont::create();
     font->loadFromFile("assets/fonts/arial.ttf");
     text->setFont(font.get());
-    text->setString("Brightness Filter");
+    text->setString(kBrightnessTitle);
     
     auto button = std::make_unique<BrightnessFilter>(std::move(text), std::move(font));
 
@@ -95,6 +95,11 @@ size_t CatmullRom::getSize() const
     return points_.size();
 }
 
+const std::vector<vec2f>& CatmullRom::getPoints() const
+{
+    return points_;
+}
+
 bool operator==(const vec2f& a, const vec2f& b)
 {
     return eq(a, b);
@@ -36,6 +36,7 @@ public:
     void setPoint(const vec2f& prevPoint, const vec2f& newPoint);
 
     size_t getSize() const;
+    const std::vector<vec2f>& getPoints() const;
 
     vec2f operator[](float t) const;
 };
@@ -5,6 +5,7 @@
 #include "interfaceInfo/interfaceInfo.hpp"
 #include "pluginLib/windows/windows.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 
@@ -16,6 +17,9 @@ namespace ps
 namespace 
 {
 
+// layer ids are never reused, so (id, version) identifies layer content
+uint64_t nextLayerId = 1;
+
 vec2u calculateFullSize(vec2u size)
 {
     static const size_t prettyCoeff = 2;
@@ -71,9 +75,10 @@ std::vector<Color> LayerSnapshot::getPixels() const { return pixels_; }
 // Layer implementation
 
 Layer::Layer(vec2u size, vec2u fullSize) 
-    : size_(size), fullSize_(fullSize),
+    : id_(nextLayerId++), size_(size), fullSize_(fullSize),
       pixels_(fullSize_.x * fullSize_.y, Color{}.getStandardColor(Color::Type::White))
 {
+    markAllTilesChanged();
 }
 
 drawable_id_t Layer::addDrawable(std::unique_ptr<Drawable> object)
@@ -81,6 +86,8 @@ drawable_id_t Layer::addDrawable(std::unique_ptr<Drawable> object)
     // TODO: pretty bad logic, cleaning vector only on removeAllDrawables.
 
     drawables_.push_back(std::move(object));
+    ++version_;
+
     return static_cast<drawable_id_t>(drawables_.size()) - 1;
 }
 
@@ -90,11 +97,13 @@ void Layer::removeDrawable(drawable_id_t id)
     assert(id >= 0);
     
     drawables_[static_cast<size_t>(id)].reset();
+    ++version_;
 }
 
 void Layer::removeAllDrawables()
 {
     drawables_.clear();
+    ++version_;
 }
 
 vec2u Layer::getSize() const
@@ -119,6 +128,10 @@ void Layer::setPixel(vec2i pos, Color pixel)
 
     size_t pixelPos = getCutRectPosInFullPixelsArray(area_, pos, fullSize_);
     pixels_.at(pixelPos) = pixel;
+    ++version_;
+
+    markTilesChanged(vec2u{static_cast<unsigned>(pixelPos % fullSize_.x), 
+                           static_cast<unsigned>(pixelPos / fullSize_.x)}, vec2u{1, 1});
 }
 
 void Layer::changeFullSize(vec2u size) 
@@ -138,6 +151,9 @@ void Layer::changeFullSize(vec2u size)
 
     fullSize_ = size;
     pixels_.swap(newPixels);
+    ++version_;
+
+    markAllTilesChanged();
 }
 
 void Layer::changeArea(const CutRect& area)
@@ -157,6 +173,122 @@ void Layer::restore(ILayerSnapshot* snapshot)
 
     drawables_ = layerSnapshot->getDrawables();
     pixels_ = layerSnapshot->getPixels();
+    ++version_;
+
+    markAllTilesChanged();
+}
+
+uint64_t Layer::getLayerId() const
+{
+    return id_;
+}
+
+uint64_t Layer::getVersion() const
+{
+    return version_;
+}
+
+uint64_t Layer::getTileVersion(const vec2u& tile) const
+{
+    vec2u tilesCount = getTilesCount();
+    assert(tile.x < tilesCount.x && tile.y < tilesCount.y);
+
+    return tileVersions_[tile.y * tilesCount.x + tile.x];
+}
+
+vec2u Layer::getTilesCount() const
+{
+    return vec2u{(fullSize_.x + kLayerTileSize - 1) / kLayerTileSize, 
+                 (fullSize_.y + kLayerTileSize - 1) / kLayerTileSize};
+}
+
+void Layer::markTilesChanged(const vec2u& pos, const vec2u& size)
+{
+    if (size.x == 0 || size.y == 0)
+        return;
+
+    vec2u tilesCount = getTilesCount();
+
+    unsigned xBegin = pos.x / kLayerTileSize;
+    unsigned yBegin = pos.y / kLayerTileSize;
+    unsigned xEnd   = std::min((pos.x + size.x - 1) / kLayerTileSize + 1, tilesCount.x);
+    unsigned yEnd   = std::min((pos.y + size.y - 1) / kLayerTileSize + 1, tilesCount.y);
+
+    for (unsigned y = yBegin; y < yEnd; ++y)
+        for (unsigned x = xBegin; x < xEnd; ++x)
+            tileVersions_[y * tilesCount.x + x] = version_;
+}
+
+void Layer::markAllTilesChanged()
+{
+    vec2u tilesCount = getTilesCount();
+    tileVersions_.assign(tilesCount.x * tilesCount.y, version_);
+}
+
+vec2i Layer::getVisiblePos() const
+{
+    return area_.pos;
+}
+
+vec2u Layer::getFullSize() const
+{
+    return fullSize_;
+}
+
+void Layer::readRegion(const vec2i& pos, const vec2u& size, Color* pixels) const
+{
+    assert(pixels);
+
+    std::fill(pixels, pixels + size.x * size.y, Color{0, 0, 0, 0});
+
+    for (unsigned y = 0; y < size.y; ++y)
+    {
+        int layerY = pos.y + static_cast<int>(y);
+        if (layerY < 0 || layerY >= static_cast<int>(fullSize_.y))
+            continue;
+
+        int xBegin = std::max(pos.x, 0);
+        int xEnd   = std::min(pos.x + static_cast<int>(size.x), static_cast<int>(fullSize_.x));
+        if (xBegin >= xEnd)
+            continue;
+
+        const Color* source = pixels_.data() + static_cast<size_t>(layerY) * fullSize_.x;
+        std::copy(source + xBegin, source + xEnd, pixels + y * size.x + (xBegin - pos.x));
+    }
+}
+
+void Layer::writeRegion(const vec2i& pos, const vec2u& size, const Color* pixels)
+{
+    assert(pixels);
+
+    ++version_;
+
+    for (unsigned y = 0; y < size.y; ++y)
+    {
+        int layerY = pos.y + static_cast<int>(y);
+        if (layerY < 0 || layerY >= static_cast<int>(fullSize_.y))
+            continue;
+
+        int xBegin = std::max(pos.x, 0);
+        int xEnd   = std::min(pos.x + static_cast<int>(size.x), static_cast<int>(fullSize_.x));
+        if (xBegin >= xEnd)
+            continue;
+
+        const Color* source = pixels + y * size.x + (xBegin - pos.x);
+        Color* destination = pixels_.data() + static_cast<size_t>(layerY) * fullSize_.x + xBegin;
+
+        std::copy(source, source + (xEnd - xBegin), destination);
+    }
+
+    int changedLeft = std::max(pos.x, 0);
+    int changedTop  = std::max(pos.y, 0);
+    int changedRight  = std::min(pos.x + static_cast<int>(size.x), static_cast<int>(fullSize_.x));
+    int changedBottom = std::min(pos.y + static_cast<int>(size.y), static_cast<int>(fullSize_.y));
+
+    if (changedLeft < changedRight && changedTop < changedBottom)
+        markTilesChanged(vec2u{static_cast<unsigned>(changedLeft), static_cast<unsigned>(changedTop)},
+                         vec2u{static_cast<unsigned>(changedRight  - changedLeft), 
+                               static_cast<unsigned>(changedBottom - changedTop)});
 }
 
 // Canvas snapshot implementation
@@ -214,6 +346,7 @@ void Canvas::draw(IRenderWindow* renderWindow)
     
     drawLayer(*tempLayer_.get(), renderWindow);
 
+    drawSelection(renderWindow);
 }
 
 std::unique_ptr<IAction> Canvas::createAction(const IRenderWindow* renderWindow, 
@@ -302,6 +435,63 @@ void Canvas::drawLayer(const Layer& layer, IRenderWindow* renderWindow)
     drawDrawables(layer, renderWindow);
 }
 
+// selection border is drawn with black and white dashes, only its visible spans are visited
+void Canvas::updateSelectionSprite(const vec2i& topLeft)
+{
+    const int dashLength = 4;
+
+    std::vector<Color> pixels(size_.x * size_.y, Color{0, 0, 0, 0});
+
+    for (int y = 0; y < static_cast<int>(size_.y); ++y)
+    {
+        for (const SelectionSpan& span : selectionOutline_.getRow(topLeft.y + y))
+        {
+            int begin = std::max(span.begin - topLeft.x, 0);
+            int end   = std::min(span.end   - topLeft.x, static_cast<int>(size_.x));
+
+            for (int x = begin; x < end; ++x)
+            {
+                uint8_t value = ((x + topLeft.x + y + topLeft.y) / dashLength) % 2 ? 255 : 0;
+                size_t index = static_cast<size_t>(y) * size_.x + static_cast<size_t>(x);
+                pixels[index] = Color{value, value, value, 255};
+            }
+        }
+    }
+
+    if (!selectionTexture_ || selectionSize_.x != size_.x || selectionSize_.y != size_.y)
+    {
+        selectionTexture_ = ITexture::create();
+        selectionTexture_->create(size_.x, size_.y);
+
+        selectionSprite_ = ISprite::create();
+    }
+
+    selectionTexture_->update(pixels.data(), size_.x, size_.y, 0, 0);
+    selectionSprite_->setTexture(selectionTexture_.get());
+
+    isSelectionChanged_ = false;
+    selectionTopLeft_ = topLeft;
+    selectionSize_ = size_;
+}
+
+void Canvas::drawSelection(IRenderWindow* renderWindow)
+{
+    if (selectionOutline_.isEmpty())
+        return;
+
+    vec2i topLeft = calculateCutRectangleTopLeft(fullSize_, size_, scroll_);
+
+    if (isSelectionChanged_ || topLeft.x != selectionTopLeft_.x || topLeft.y != selectionTopLeft_.y ||
+        size_.x != selectionSize_.x || size_.y != selectionSize_.y)
+    {
+        updateSelectionSprite(topLeft);
+    }
+
+    selectionSprite_->setPosition(static_cast<float>(pos_.x), static_cast<float>(pos_.y));
+
+    renderWindow->draw(selectionSprite_.get());
+}
+
 vec2i Canvas::getMousePosition() const
 {
     return { lastMousePosRelatively_.x, lastMousePosRelatively_.y };
@@ -597,6 +787,19 @@ void Canvas::restore(ICanvasSnapshot* snapshot)
     }
 }
 
+const Selection& Canvas::getSelection() const
+{
+    return selection_;
+}
+
+void Canvas::setSelection(const Selection& selection)
+{
+    selection_ = selection;
+    selectionOutline_ = selection_.getMask().getOutline();
+
+    isSelectionChanged_ = true;
+}
+
 } // namespace ps
 
 namespace
@@ -5,6 +5,9 @@
 #include "api/api_sfm.hpp"
 #include "pluginLib/windows/windows.hpp"
 #include "pluginLib/scrollbar/scrollbar.hpp"
+#include "pluginLib/canvas/versionedLayer.hpp"
+#include "pluginLib/canvas/regionLayer.hpp"
+#include "pluginLib/selection/selection.hpp"
 
 #include <iostream>
 
@@ -43,7 +46,7 @@ private:
     std::vector<Color> pixels_;
 };
 
-class Layer : public ILayer
+class Layer : public ILayer, public IVersionedLayer, public IRegionLayer
 {
 public:
     Layer(vec2u size, vec2u fullSize);
@@ -59,8 +62,21 @@ public:
     std::unique_ptr<ILayerSnapshot> save() override;
     void restore(ILayerSnapshot* snapshot) override;
 
+    uint64_t getLayerId() const override;
+    uint64_t getVersion() const override;
+    uint64_t getTileVersion(const vec2u& tile) const override;
+    vec2i getVisiblePos() const override;
+
+    vec2u getFullSize() const override;
+    void readRegion (const vec2i& pos, const vec2u& size, Color* pixels) const override;
+    void writeRegion(const vec2i& pos, const vec2u& size, const Color* pixels) override;
+
 private:
     friend class Canvas;
+
+    uint64_t id_;
+    uint64_t version_ = 0;
+    std::vector<uint64_t> tileVersions_; // row by row
     
     vec2u size_;
     vec2u fullSize_;
@@ -72,6 +88,13 @@ private:
 protected:
     void changeFullSize(vec2u size);
     void changeArea(const CutRect& area);
+
+private:
+    vec2u getTilesCount() const;
+
+    // pixels of the full layer in [pos, pos + size) were changed, version_ has to be already increased
+    void markTilesChanged(const vec2u& pos, const vec2u& size);
+    void markAllTilesChanged();
 };
 
 class Canvas;
@@ -90,7 +113,7 @@ private:
     std::vector<std::unique_ptr<LayerSnapshot>> layers_;
 };
 
-class Canvas : public ICanvas, public IScrollable
+class Canvas : public ICanvas, public IScrollable, public ISelectableCanvas
 {
 public:
     Canvas(vec2i pos, vec2u size);
@@ -159,6 +182,9 @@ public:
     std::unique_ptr<ICanvasSnapshot> save() override;
     void restore(ICanvasSnapshot* snapshot) override;
 
+    const Selection& getSelection() const override;
+    void setSelection(const Selection& selection) override;
+
 private:
     enum class PressType
     {
@@ -189,11 +215,23 @@ private:
 
     uint8_t pressType_ = 0;
 
+    Selection selection_;
+    SelectionMask selectionOutline_;
+
+    // dashed outline is redrawn only when the selection or the visible part of the canvas changes
+    std::unique_ptr<ITexture> selectionTexture_ = nullptr;
+    std::unique_ptr<ISprite> selectionSprite_ = nullptr;
+    bool isSelectionChanged_ = true;
+    vec2i selectionTopLeft_ = {0, 0};
+    vec2u selectionSize_ = {0, 0};
+
     // private functions
 private:
     void drawLayer(const Layer& layer, IRenderWindow* renderWindow);
     void drawPixels(const Layer& layer, IRenderWindow* renderWindow);
     void drawDrawables(const Layer& layer, IRenderWindow* renderWindow);
+    void drawSelection(IRenderWindow* renderWindow);
+    void updateSelectionSprite(const vec2i& topLeft);
     
     uint8_t updatePressType(uint8_t pressType, const Event& event);
 };
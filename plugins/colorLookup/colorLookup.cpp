@@ -0,0 +1,126 @@
+#include "colorLookup.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <dirent.h>
+#include <string>
+#include <vector>
+
+#include "api/api_sfm.hpp"
+#include "api/api_photoshop.hpp"
+#include "api/api_bar.hpp"
+#include "api/api_canvas.hpp"
+
+#include "pluginLib/bars/ps_bar.hpp"
+#include "pluginLib/filters/colorLookup.hpp"
+#include "pluginLib/filters/sliderFilterButton.hpp"
+
+using namespace ps;
+using namespace psapi;
+using namespace psapi::sfm;
+
+namespace
+{
+
+const char* const kLutsDirectory = "assets/luts";
+const char* const kCubeExtension = ".cube";
+
+ColorLutCache& getColorLutCache()
+{
+    static ColorLutCache cache;
+    return cache;
+}
+
+bool isCubeFile(const std::string& filename)
+{
+    const size_t extensionLength = std::char_traits<char>::length(kCubeExtension);
+
+    return filename.size() > extensionLength &&
+           filename.compare(filename.size() - extensionLength, extensionLength, kCubeExtension) == 0;
+}
+
+// sorted, so the menu order doesn't depend on the file system
+std::vector<std::string> findCubeFiles(const char* directory)
+{
+    std::vector<std::string> filenames;
+
+    DIR* dir = opendir(directory);
+    if (!dir)
+        return filenames;
+
+    struct dirent* entry;
+
+    while ((entry = readdir(dir)) != nullptr)
+    {
+        std::string filename(entry->d_name);
+
+        if (entry->d_type == DT_REG && isCubeFile(filename))
+            filenames.push_back(filename);
+    }
+
+    closedir(dir);
+
+    std::sort(filenames.begin(), filenames.end());
+
+    return filenames;
+}
+
+// The table is taken from the cache once the window is opened, so the file is checked once per use
+// and dragging the slider only interpolates. Files that can't be loaded leave the pixels as they are.
+// parameters - strength in percents
+SliderFilterButton::FilterFactory makeColorLookupFilter(const std::string& path)
+{
+    return [path]() -> FilterPreview::Filter
+    {
+        std::shared_ptr<const ColorLut3D> lut = getColorLutCache().get(path);
+
+        return [lut](const Pixels2D& pixels, const std::vector<float>& parameters, float /* scale */)
+        {
+            assert(parameters.size() == 1);
+
+            if (!lut)
+                return pixels;
+
+            return applyColorLut(pixels, *lut, parameters[0] / 100.f);
+        };
+    };
+}
+
+size_t noHalo(const std::vector<float>&)
+{
+    return 0;
+}
+
+} // namespace anonymous
+
+bool onLoadPlugin()
+{
+    IWindowContainer* rootWindow = getRootWindow();
+    assert(rootWindow);
+    auto filterMenu = dynamic_cast<IMenuButton*>(rootWindow->getWindowById(kMenuFilterId));
+    assert(filterMenu);
+
+    for (const std::string& filename : findCubeFiles(kLutsDirectory))
+    {
+        std::string name  = filename.substr(0, filename.size() - std::char_traits<char>::length(kCubeExtension));
+        std::string title = "LUT: " + name;
+
+        std::unique_ptr<IText> text = IText::create();
+        std::unique_ptr<IFont> font = IFont::create();
+        font->loadFromFile("assets/fonts/arial.ttf");
+        text->setFont(font.get());
+
+        std::vector<SliderParameters> sliders = {{"Strength: ", 0, 100, 100}};
+
+        filterMenu->addMenuItem(std::make_unique<SliderFilterButton>(
+            std::move(text), std::move(font), title, std::move(sliders),
+            makeColorLookupFilter(std::string(kLutsDirectory) + "/" + filename), noHalo));
+    }
+
+    return true;
+}
+
+void onUnloadPlugin()
+{
+    getColorLutCache().clear();
+}
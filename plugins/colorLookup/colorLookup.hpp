@@ -0,0 +1,12 @@
+#ifndef PLUGINS_COLOR_LOOKUP_COLOR_LOOKUP_HPP
+#define PLUGINS_COLOR_LOOKUP_COLOR_LOOKUP_HPP
+
+extern "C"
+{
+
+bool onLoadPlugin();
+void onUnloadPlugin();
+
+}
+
+#endif // PLUGINS_COLOR_LOOKUP_COLOR_LOOKUP_HPP
@@ -0,0 +1,136 @@
+#include "convolutionFilters.hpp"
+
+#include <string>
+#include <cassert>
+#include <cmath>
+
+#include "api/api_sfm.hpp"
+#include "api/api_photoshop.hpp"
+#include "api/api_bar.hpp"
+#include "api/api_canvas.hpp"
+
+#include "pluginLib/bars/ps_bar.hpp"
+#include "pluginLib/windows/windows.hpp"
+#include "pluginLib/filters/filters.hpp"
+#include "pluginLib/filters/convolution.hpp"
+#include "pluginLib/filters/sliderFilterButton.hpp"
+
+using namespace ps;
+using namespace psapi;
+using namespace psapi::sfm;
+
+namespace
+{
+
+const size_t kCustomKernelSize = 3;
+const float  kMaxCustomWeight  = 10;
+
+std::vector<std::vector<Color>> sharpenFilter(const std::vector<std::vector<Color>>& pixels)
+{
+    return convolve(pixels, kSharpenKernel);
+}
+
+std::vector<std::vector<Color>> embossFilter(const std::vector<std::vector<Color>>& pixels)
+{
+    return convolve(pixels, kEmbossKernel);
+}
+
+std::vector<std::vector<Color>> edgeDetectFilter(const std::vector<std::vector<Color>>& pixels)
+{
+    return convolve(pixels, kEdgeDetectKernel);
+}
+
+// weights are taken from sliders row by row, kernel is normalized by the sum of its weights
+std::vector<std::vector<Color>> customKernelFilter(const std::vector<std::vector<Color>>& pixels, 
+                                                   const std::vector<float>& parameters, float /* scale */)
+{
+    assert(parameters.size() == kCustomKernelSize * kCustomKernelSize);
+
+    RuntimeKernel kernel;
+    kernel.size = kCustomKernelSize;
+
+    int sum = 0;
+    for (float parameter : parameters)
+    {
+        kernel.weights.push_back(static_cast<int>(std::lround(parameter)));
+        sum += kernel.weights.back();
+    }
+
+    kernel.divisor = sum > 0 ? sum : 1;
+
+    return convolve(pixels, kernel);
+}
+
+std::vector<SliderParameters> getCustomKernelSliders()
+{
+    std::vector<SliderParameters> sliders;
+
+    for (size_t y = 0; y < kCustomKernelSize; ++y)
+    {
+        for (size_t x = 0; x < kCustomKernelSize; ++x)
+        {
+            bool isCenter = (x == kCustomKernelSize / 2 && y == kCustomKernelSize / 2);
+
+            std::string caption = "w" + std::to_string(y) + std::to_string(x) + ": ";
+            sliders.push_back({caption, -kMaxCustomWeight, kMaxCustomWeight, isCenter ? 1.f : 0.f});
+        }
+    }
+
+    return sliders;
+}
+
+std::unique_ptr<IText> createButtonText(IFont* font)
+{
+    std::unique_ptr<IText> text = IText::create();
+    text->setFont(font);
+
+    return text;
+}
+
+std::unique_ptr<IFont> createButtonFont()
+{
+    std::unique_ptr<IFont> font = IFont::create();
+    font->loadFromFile("assets/fonts/arial.ttf");
+
+    return font;
+}
+
+// all the kernels are 3x3, so one row around the pixel is read
+std::unique_ptr<IBarButton> createKernelButton(const std::string& title, FilterButton::Filter filter)
+{
+    std::unique_ptr<IFont> font = createButtonFont();
+    std::unique_ptr<IText> text = createButtonText(font.get());
+
+    return std::make_unique<FilterButton>(std::move(text), std::move(font), title, 
+                                          kCustomKernelSize / 2, std::move(filter));
+}
+
+} // namespace anonymous
+
+bool onLoadPlugin()
+{
+    IWindowContainer* rootWindow = getRootWindow();
+    assert(rootWindow);
+    auto filterMenu = dynamic_cast<IMenuButton*>(rootWindow->getWindowById(kMenuFilterId));
+    assert(filterMenu);
+
+    filterMenu->addMenuItem(createKernelButton("Sharpen",     sharpenFilter));
+    filterMenu->addMenuItem(createKernelButton("Emboss",      embossFilter));
+    filterMenu->addMenuItem(createKernelButton("Edge Detect", edgeDetectFilter));
+
+    std::unique_ptr<IFont> font = createButtonFont();
+    std::unique_ptr<IText> text = createButtonText(font.get());
+
+    auto customKernelHalo = [](const std::vector<float>&) { return kCustomKernelSize / 2; };
+
+    filterMenu->addMenuItem(std::make_unique<SliderFilterButton>(std::move(text), std::move(font), "Custom Kernel",
+                                                                 getCustomKernelSliders(), customKernelFilter,
+                                                                 customKernelHalo));
+
+    return true;
+}
+
+void onUnloadPlugin()
+{
+    return;
+}
@@ -0,0 +1,12 @@
+#ifndef PLUGINS_CONVOLUTION_FILTERS_CONVOLUTION_FILTERS_HPP
+#define PLUGINS_CONVOLUTION_FILTERS_CONVOLUTION_FILTERS_HPP
+
+extern "C"
+{
+
+bool onLoadPlugin();
+void onUnloadPlugin();
+
+}
+
+#endif // PLUGINS_CONVOLUTION_FILTERS_CONVOLUTION_FILTERS_HPP
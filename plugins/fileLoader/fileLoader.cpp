@@ -7,7 +7,9 @@
 #include "pluginLib/bars/menu.hpp"
 #include "pluginLib/actions/actions.hpp"
 #include "pluginLib/canvas/canvas.hpp"
+#include "pluginLib/filters/resampler.hpp"
 
+#include <algorithm>
 #include <dirent.h>
 #include <string>
 #include <cassert>
@@ -109,6 +111,39 @@ void updateMenuChildren(SubMenuBar* menu)
     }
 }
 
+// images that don't fit into the canvas are scaled down keeping the aspect ratio
+std::unique_ptr<IImage> fitImage(std::unique_ptr<IImage> image, const vec2u& maxSize)
+{
+    vec2u size = image->getSize();
+    if (size.x <= maxSize.x && size.y <= maxSize.y)
+        return image;
+
+    float scale = std::min(static_cast<float>(maxSize.x) / static_cast<float>(size.x),
+                           static_cast<float>(maxSize.y) / static_cast<float>(size.y));
+
+    vec2u fittedSize = {std::max(static_cast<unsigned>(static_cast<float>(size.x) * scale), 1u),
+                        std::max(static_cast<unsigned>(static_cast<float>(size.y) * scale), 1u)};
+
+    Pixels2D pixels(size.y, std::vector<Color>(size.x));
+    for (unsigned y = 0; y < size.y; ++y)
+        for (unsigned x = 0; x < size.x; ++x)
+            pixels[y][x] = image->getPixel(x, y);
+
+    Pixels2D fitted = resample(pixels, fittedSize, ResampleFilter::Lanczos3);
+
+    std::vector<Color> fittedPixels;
+    fittedPixels.reserve(fittedSize.x * fittedSize.y);
+    for (const std::vector<Color>& row : fitted)
+        fittedPixels.insert(fittedPixels.end(), row.begin(), row.end());
+
+    vec2i pos = image->getPos();
+
+    image->create(fittedSize, fittedPixels.data());
+    image->setPos(pos);
+
+    return image;
+}
+
 }
 
 template<typename SubButtonsType>
@@ -153,6 +188,7 @@ bool FileOpenButton::update(const IRenderWindow* renderWindow, const Event& even
 
     ILayer* activeLayer = canvas->getLayer(canvas->getActiveLayerIndex());
 
+    image = fitImage(std::move(image), canvas->getSize());
     copyImageToLayer(activeLayer, image.get(), image->getPos());
 
     state_ = State::Normal;
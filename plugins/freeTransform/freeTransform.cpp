@@ -0,0 +1,463 @@
+#include "freeTransform.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <string>
+
+#include "api/api_sfm.hpp"
+#include "api/api_photoshop.hpp"
+#include "api/api_bar.hpp"
+#include "api/api_canvas.hpp"
+
+#include "pluginLib/actions/actions.hpp"
+#include "pluginLib/bars/ps_bar.hpp"
+#include "pluginLib/canvas/canvas.hpp"
+#include "pluginLib/filters/affineTransform.hpp"
+#include "pluginLib/filters/filterJobs.hpp"
+#include "pluginLib/filters/filterWindows.hpp"
+#include "pluginLib/selection/selection.hpp"
+
+using namespace ps;
+using namespace psapi;
+using namespace psapi::sfm;
+
+namespace
+{
+
+const char* const kTransformTitle = "Free Transform";
+
+enum TransformParameter
+{
+    kAngle,
+    kScaleX,
+    kScaleY,
+    kSkew,
+    kMethod,
+
+    kParametersCount,
+};
+
+// Transforms the selected pixels of the active layer, or the whole layer without selection, around
+// the center of their bounds. While sliders are dragged the untransformed pixels are shown by a rotated
+// and scaled sprite, skew can't be done by sprite, so it is previewed on CPU in the visible region only.
+// Full quality resampling runs once, on "Ok".
+class FreeTransformButton : public ANamedBarButton
+{
+public:
+    FreeTransformButton(std::unique_ptr<IText> name, std::unique_ptr<IFont> font);
+
+    std::unique_ptr<IAction> createAction(const IRenderWindow* renderWindow,
+                                          const Event& event) override;
+
+    bool update(const IRenderWindow* renderWindow, const Event& event);
+    void draw(IRenderWindow* renderWindow) override;
+
+private:
+    void beginPreview(ICanvas* canvas);
+    void updatePreview(ICanvas* canvas, const std::vector<float>& parameters);
+    void endPreview(ICanvas* canvas);
+
+    void drawSpritePreview(ICanvas* canvas, const AffineTransform& transform, const std::vector<float>& parameters);
+    void drawCpuPreview(ICanvas* canvas, const AffineTransform& transform);
+    void drawBackground(ICanvas* canvas);
+
+    void commit(ICanvas* canvas, const std::vector<float>& parameters);
+
+private:
+    std::vector<SliderParameters> sliders_;
+    std::unique_ptr<FilterWindow> transformWindow_;
+
+    size_t layerIndex_ = 0;
+    Selection selection_;
+    IntRect sourceRect_;
+    std::shared_ptr<const Pixels2D> source_; // selected pixels of sourceRect_, others are transparent
+
+    vec2i visiblePos_;
+    Pixels2D background_; // visible region of the temp layer with the source hidden
+    bool isBackgroundDirty_ = false;
+
+    std::unique_ptr<ITexture> previewTexture_;
+    std::vector<float> previewParameters_;
+
+    std::shared_ptr<FilterJob> job_;
+};
+
+IntRect intersectRects(const IntRect& lhs, const IntRect& rhs)
+{
+    int left   = std::max(lhs.pos.x, rhs.pos.x);
+    int top    = std::max(lhs.pos.y, rhs.pos.y);
+    int right  = std::min(lhs.pos.x + static_cast<int>(lhs.size.x), rhs.pos.x + static_cast<int>(rhs.size.x));
+    int bottom = std::min(lhs.pos.y + static_cast<int>(lhs.size.y), rhs.pos.y + static_cast<int>(rhs.size.y));
+
+    if (right <= left || bottom <= top)
+        return IntRect{{left, top}, {0, 0}};
+
+    return IntRect{{left, top}, {static_cast<unsigned>(right - left), static_cast<unsigned>(bottom - top)}};
+}
+
+IntRect uniteRects(const IntRect& lhs, const IntRect& rhs)
+{
+    int left   = std::min(lhs.pos.x, rhs.pos.x);
+    int top    = std::min(lhs.pos.y, rhs.pos.y);
+    int right  = std::max(lhs.pos.x + static_cast<int>(lhs.size.x), rhs.pos.x + static_cast<int>(rhs.size.x));
+    int bottom = std::max(lhs.pos.y + static_cast<int>(lhs.size.y), rhs.pos.y + static_cast<int>(rhs.size.y));
+
+    return IntRect{{left, top}, {static_cast<unsigned>(right - left), static_cast<unsigned>(bottom - top)}};
+}
+
+uint8_t scaleAlpha(uint8_t alpha, uint8_t coverage)
+{
+    return static_cast<uint8_t>((alpha * coverage + 127) / 255);
+}
+
+// pixels at pos keep only the selected part of their alpha, or the unselected one if inverted
+void maskBySelection(Pixels2D& pixels, const vec2i& pos, const Selection& selection, bool inverted)
+{
+    for (size_t y = 0; y < pixels.size(); ++y)
+    {
+        for (size_t x = 0; x < pixels[y].size(); ++x)
+        {
+            vec2i layerPos = {pos.x + static_cast<int>(x), pos.y + static_cast<int>(y)};
+            uint8_t coverage = selection.isActive() ? selection.getCoverage(layerPos) : 255;
+
+            if (inverted)
+                coverage = static_cast<uint8_t>(255 - coverage);
+
+            pixels[y][x].a = scaleAlpha(pixels[y][x].a, coverage);
+        }
+    }
+}
+
+AffineTransform makeTransform(const IntRect& rect, const std::vector<float>& parameters)
+{
+    assert(parameters.size() == kParametersCount);
+
+    vec2f center = {static_cast<float>(rect.pos.x) + static_cast<float>(rect.size.x) / 2.f,
+                    static_cast<float>(rect.pos.y) + static_cast<float>(rect.size.y) / 2.f};
+
+    vec2f scale = {parameters[kScaleX] / 100.f, parameters[kScaleY] / 100.f};
+
+    return AffineTransform::create(center, parameters[kAngle], scale, parameters[kSkew]);
+}
+
+bool hasSkew(const std::vector<float>& parameters)
+{
+    return std::fabs(parameters[kSkew]) >= 0.5f;
+}
+
+AffineSampling getSampling(const std::vector<float>& parameters)
+{
+    return parameters[kMethod] >= 0.5f ? AffineSampling::Bicubic : AffineSampling::Bilinear;
+}
+
+FreeTransformButton::FreeTransformButton(std::unique_ptr<IText> name, std::unique_ptr<IFont> font)
+{
+    name_ = std::move(name);
+    font_ = std::move(font);
+
+    name_->setString(kTransformTitle);
+
+    // method: 0 - bilinear, 1 - bicubic
+    sliders_ = {{"Angle: ", -180, 180, 0},
+                {"Scale X %: ", 10, 400, 100},
+                {"Scale Y %: ", 10, 400, 100},
+                {"Skew: ", -60, 60, 0},
+                {"Method: ", 0, 1, 1}};
+}
+
+std::unique_ptr<IAction> FreeTransformButton::createAction(const IRenderWindow* renderWindow,
+                                                           const Event& event)
+{
+    return std::make_unique<UpdateCallbackAction<FreeTransformButton>>(*this, renderWindow, event);
+}
+
+bool FreeTransformButton::update(const IRenderWindow* renderWindow, const Event& event)
+{
+    bool updateStateRes = updateState(renderWindow, event);
+
+    ICanvas* canvas = static_cast<ICanvas*>(getRootWindow()->getWindowById(kCanvasWindowId));
+    assert(canvas);
+
+    if (state_ != State::Released)
+    {
+        if (transformWindow_)
+        {
+            transformWindow_->close();
+            transformWindow_.reset();
+            endPreview(canvas);
+        }
+
+        return updateStateRes;
+    }
+
+    if (updateStateRes)
+    {
+        beginPreview(canvas);
+        transformWindow_ = createSlidersFilterWindow(kTransformTitle, sliders_);
+    }
+
+    assert(transformWindow_);
+
+    AActionController* actionController = getActionController();
+
+    if (!actionController->execute(transformWindow_->createAction(renderWindow, event)))
+    {
+        std::vector<float> parameters = getSlidersValues(transformWindow_.get(), sliders_);
+
+        endPreview(canvas);
+
+        if (transformWindow_->isConfirmed())
+            commit(canvas, parameters);
+
+        transformWindow_.reset();
+        state_ = State::Normal;
+        return false;
+    }
+
+    updatePreview(canvas, getSlidersValues(transformWindow_.get(), sliders_));
+
+    return true;
+}
+
+void FreeTransformButton::beginPreview(ICanvas* canvas)
+{
+    layerIndex_ = canvas->getActiveLayerIndex();
+    const ILayer* layer = canvas->getLayer(layerIndex_);
+    assert(layer);
+
+    vec2u fullSize = getLayerFullSize(layer, canvas->getSize());
+    IntRect layerRect = {{0, 0}, fullSize};
+
+    selection_  = getCanvasSelection(canvas);
+    sourceRect_ = selection_.isActive() ? intersectRects(selection_.getBounds(), layerRect) : layerRect;
+
+    Pixels2D source = getLayerRegion(layer, sourceRect_);
+    maskBySelection(source, sourceRect_.pos, selection_, false);
+    source_ = std::make_shared<const Pixels2D>(std::move(source));
+
+    // the source is hidden under canvas colored pixels, transformed copy is drawn over them
+    visiblePos_ = getLayerVisiblePos(layer);
+    vec2u screenSize = canvas->getSize();
+
+    Color hidden = canvas->getCanvasBaseColor();
+    hidden.a = 255;
+
+    background_.assign(screenSize.y, std::vector<Color>(screenSize.x, Color{0, 0, 0, 0}));
+
+    for (size_t y = 0; y < screenSize.y; ++y)
+    {
+        for (size_t x = 0; x < screenSize.x; ++x)
+        {
+            vec2i layerPos = {visiblePos_.x + static_cast<int>(x), visiblePos_.y + static_cast<int>(y)};
+            uint8_t coverage = selection_.isActive() ? selection_.getCoverage(layerPos) : 255;
+
+            if (layerPos.x < static_cast<int>(fullSize.x) && layerPos.y < static_cast<int>(fullSize.y))
+                background_[y][x] = Color{hidden.r, hidden.g, hidden.b, coverage};
+        }
+    }
+
+    drawBackground(canvas);
+
+    std::vector<Color> texturePixels;
+    texturePixels.reserve(sourceRect_.size.x * sourceRect_.size.y);
+    for (const std::vector<Color>& row : *source_)
+        texturePixels.insert(texturePixels.end(), row.begin(), row.end());
+
+    previewTexture_ = ITexture::create();
+    previewTexture_->create(sourceRect_.size.x, sourceRect_.size.y);
+    previewTexture_->update(texturePixels.data());
+
+    previewParameters_.clear();
+}
+
+void FreeTransformButton::updatePreview(ICanvas* canvas, const std::vector<float>& parameters)
+{
+    if (!source_ || parameters == previewParameters_)
+        return;
+
+    previewParameters_ = parameters;
+
+    AffineTransform transform = makeTransform(sourceRect_, parameters);
+
+    ILayer* tempLayer = canvas->getTempLayer();
+    tempLayer->removeAllDrawables();
+
+    if (hasSkew(parameters))
+    {
+        drawCpuPreview(canvas, transform);
+        return;
+    }
+
+    if (isBackgroundDirty_)
+        drawBackground(canvas);
+
+    drawSpritePreview(canvas, transform, parameters);
+}
+
+void FreeTransformButton::drawSpritePreview(ICanvas* canvas, const AffineTransform& transform,
+                                            const std::vector<float>& parameters)
+{
+    vec2f topLeft = transform.apply(vec2f{static_cast<float>(sourceRect_.pos.x),
+                                          static_cast<float>(sourceRect_.pos.y)});
+
+    vec2i canvasPos = canvas->getPos();
+
+    auto sprite = ISprite::create();
+    sprite->setTexture(previewTexture_.get(), true);
+    sprite->setScale(parameters[kScaleX] / 100.f, parameters[kScaleY] / 100.f);
+    sprite->setRotation(parameters[kAngle]);
+    sprite->setPosition(static_cast<float>(canvasPos.x - visiblePos_.x) + topLeft.x,
+                        static_cast<float>(canvasPos.y - visiblePos_.y) + topLeft.y);
+
+    canvas->getTempLayer()->addDrawable(std::move(sprite));
+}
+
+void FreeTransformButton::drawCpuPreview(ICanvas* canvas, const AffineTransform& transform)
+{
+    vec2u screenSize = canvas->getSize();
+    IntRect visibleRect = {visiblePos_, screenSize};
+
+    Pixels2D transformed = transformPixels(*source_, sourceRect_.pos, transform, visibleRect,
+                                           AffineSampling::Bilinear);
+
+    ILayer* tempLayer = canvas->getTempLayer();
+
+    for (size_t y = 0; y < screenSize.y; ++y)
+    {
+        for (size_t x = 0; x < screenSize.x; ++x)
+        {
+            vec2i pos = {static_cast<int>(x), static_cast<int>(y)};
+            tempLayer->setPixel(pos, compositeOver(background_[y][x], transformed[y][x]));
+        }
+    }
+
+    isBackgroundDirty_ = true;
+}
+
+void FreeTransformButton::drawBackground(ICanvas* canvas)
+{
+    ILayer* tempLayer = canvas->getTempLayer();
+
+    for (size_t y = 0; y < background_.size(); ++y)
+    {
+        for (size_t x = 0; x < background_[y].size(); ++x)
+            tempLayer->setPixel(vec2i{static_cast<int>(x), static_cast<int>(y)}, background_[y][x]);
+    }
+
+    isBackgroundDirty_ = false;
+}
+
+void FreeTransformButton::endPreview(ICanvas* canvas)
+{
+    // sprite refers to the texture, so it has to go first
+    canvas->getTempLayer()->removeAllDrawables();
+    canvas->cleanTempLayer();
+
+    previewTexture_.reset();
+    background_.clear();
+    previewParameters_.clear();
+}
+
+void FreeTransformButton::commit(ICanvas* canvas, const std::vector<float>& parameters)
+{
+    if (!source_ || (job_ && !job_->isDone()))
+        return;
+
+    if (layerIndex_ >= canvas->getNumLayers())
+        return;
+
+    const ILayer* layer = canvas->getLayer(layerIndex_);
+    IntRect layerRect = {{0, 0}, getLayerFullSize(layer, canvas->getSize())};
+
+    AffineTransform transform = makeTransform(sourceRect_, parameters);
+    AffineSampling sampling = getSampling(parameters);
+
+    IntRect targetRect = uniteRects(sourceRect_, getTransformedBounds(sourceRect_, transform));
+    targetRect = intersectRects(targetRect, layerRect);
+
+    if (targetRect.size.x == 0 || targetRect.size.y == 0)
+        return;
+
+    auto original = std::make_shared<Pixels2D>(getLayerRegion(layer, targetRect));
+
+    job_ = getFilterJobsWindow()->submit(
+        [original, source = source_, sourceRect = sourceRect_, targetRect,
+         selection = selection_, transform, sampling]()
+        {
+            Pixels2D result = *original;
+            maskBySelection(result, targetRect.pos, selection, true);
+
+            Pixels2D moved = transformPixels(*source, sourceRect.pos, transform, targetRect, sampling);
+
+            parallelForRows(result.size(), [&](size_t rowBegin, size_t rowEnd)
+            {
+                for (size_t y = rowBegin; y < rowEnd; ++y)
+                    for (size_t x = 0; x < result[y].size(); ++x)
+                        result[y][x] = compositeOver(result[y][x], moved[y][x]);
+            });
+
+            return result;
+        },
+        [canvas, layerIndex = layerIndex_, targetRect, hadSelection = selection_.isActive()](const Pixels2D& result)
+        {
+            if (layerIndex >= canvas->getNumLayers())
+                return;
+
+            auto saving = std::make_unique<CanvasSaverAction>();
+            saving->setPastSnapshot(canvas->save());
+
+            setLayerRegion(canvas->getLayer(layerIndex), targetRect.pos, result);
+
+            // selection no longer matches the moved pixels
+            if (hadSelection)
+                setCanvasSelection(canvas, Selection());
+
+            saving->setFutureSnapshot(canvas->save());
+            getActionController()->execute(std::move(saving));
+        });
+
+    source_.reset();
+}
+
+void FreeTransformButton::draw(IRenderWindow* renderWindow)
+{
+    std::string title = kTransformTitle;
+
+    if (job_ && !job_->isDone())
+        title += " " + std::to_string(static_cast<int>(job_->getProgress() * 100.f)) + "%";
+
+    name_->setString(title);
+
+    ANamedBarButton::draw(renderWindow);
+
+    if (transformWindow_)
+        transformWindow_->draw(renderWindow);
+}
+
+} // namespace anonymous
+
+bool onLoadPlugin()
+{
+    std::unique_ptr<IText> text = IText::create();
+    std::unique_ptr<IFont> font = IFont::create();
+    font->loadFromFile("assets/fonts/arial.ttf");
+    text->setFont(font.get());
+
+    auto button = std::make_unique<FreeTransformButton>(std::move(text), std::move(font));
+
+    IWindowContainer* rootWindow = getRootWindow();
+    assert(rootWindow);
+    auto layerMenu = dynamic_cast<IMenuButton*>(rootWindow->getWindowById(kMenuLayerId));
+    assert(layerMenu);
+
+    layerMenu->addMenuItem(std::move(button));
+
+    return true;
+}
+
+void onUnloadPlugin()
+{
+    return;
+}
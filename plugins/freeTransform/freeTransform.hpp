@@ -0,0 +1,12 @@
+#ifndef PLUGINS_FREE_TRANSFORM_FREE_TRANSFORM_HPP
+#define PLUGINS_FREE_TRANSFORM_FREE_TRANSFORM_HPP
+
+extern "C"
+{
+
+bool onLoadPlugin();
+void onUnloadPlugin();
+
+}
+
+#endif // PLUGINS_FREE_TRANSFORM_FREE_TRANSFORM_HPP
@@ -0,0 +1,116 @@
+#include "hueSaturation.hpp"
+
+#include <string>
+#include <cassert>
+#include <algorithm>
+#include <cmath>
+
+#include "api/api_sfm.hpp"
+#include "api/api_photoshop.hpp"
+#include "api/api_bar.hpp"
+#include "api/api_canvas.hpp"
+
+#include "pluginLib/bars/ps_bar.hpp"
+#include "pluginLib/filters/colorSpace.hpp"
+#include "pluginLib/filters/filterExecutor.hpp"
+#include "pluginLib/filters/sliderFilterButton.hpp"
+
+using namespace ps;
+using namespace psapi;
+using namespace psapi::sfm;
+
+namespace
+{
+
+const char* const kHueSaturationTitle = "Hue/Saturation";
+
+struct HslAdjustment
+{
+    float hueShift;   // in turns
+    float saturation; // factor
+    float lightness;  // in [-1, 1], positive moves to white, negative to black
+};
+
+void adjustBlock(ColorBlock& block, const HslAdjustment& adjustment)
+{
+    for (size_t i = 0; i < block.size; ++i)
+    {
+        float hue = block.c0[i] + adjustment.hueShift;
+        block.c0[i] = hue - std::floor(hue);
+
+        block.c1[i] = std::clamp(block.c1[i] * adjustment.saturation, 0.f, 1.f);
+
+        float lightness = block.c2[i];
+        block.c2[i] = adjustment.lightness > 0 ? lightness + (1.f - lightness) * adjustment.lightness
+                                               : lightness * (1.f + adjustment.lightness);
+    }
+}
+
+// parameters - hue in degrees, saturation and lightness in percents
+Pixels2D hueSaturationFilter(const Pixels2D& pixels, const std::vector<float>& parameters, float /* scale */)
+{
+    assert(parameters.size() == 3);
+
+    HslAdjustment adjustment{parameters[0] / 360.f, 1.f + parameters[1] / 100.f, parameters[2] / 100.f};
+
+    Pixels2D result = pixels;
+
+    parallelForRows(result.size(), [&](size_t rowBegin, size_t rowEnd)
+    {
+        ColorBlock block;
+
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+        {
+            std::vector<Color>& row = result[y];
+
+            for (size_t x = 0; x < row.size(); x += ColorBlock::kCapacity)
+            {
+                size_t count = std::min(ColorBlock::kCapacity, row.size() - x);
+
+                loadColorBlock(row.data() + x, count, block);
+                convertRgbToHsl(block);
+                adjustBlock(block, adjustment);
+                convertHslToRgb(block);
+                storeColorBlock(block, row.data() + x);
+            }
+        }
+    });
+
+    return result;
+}
+
+size_t noHalo(const std::vector<float>& /* parameters */)
+{
+    return 0;
+}
+
+} // namespace anonymous
+
+bool onLoadPlugin()
+{
+    std::unique_ptr<IText> text = IText::create();
+    std::unique_ptr<IFont> font = IFont::create();
+    font->loadFromFile("assets/fonts/arial.ttf");
+    text->setFont(font.get());
+
+    std::vector<SliderParameters> sliders = {{"Hue: ",        -180, 180, 0},
+                                             {"Saturation: ", -100, 100, 0},
+                                             {"Lightness: ",  -100, 100, 0}};
+
+    auto button = std::make_unique<SliderFilterButton>(std::move(text), std::move(font), kHueSaturationTitle,
+                                                       std::move(sliders), hueSaturationFilter, noHalo);
+
+    IWindowContainer* rootWindow = getRootWindow();
+    assert(rootWindow);
+    auto filterMenu = dynamic_cast<IMenuButton*>(rootWindow->getWindowById(kMenuFilterId));
+    assert(filterMenu);
+
+    filterMenu->addMenuItem(std::move(button));
+
+    return true;
+}
+
+void onUnloadPlugin()
+{
+    return;
+}
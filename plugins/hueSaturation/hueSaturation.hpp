@@ -0,0 +1,12 @@
+#ifndef PLUGINS_HUE_SATURATION_HUE_SATURATION_HPP
+#define PLUGINS_HUE_SATURATION_HUE_SATURATION_HPP
+
+extern "C"
+{
+
+bool onLoadPlugin();
+void onUnloadPlugin();
+
+}
+
+#endif // PLUGINS_HUE_SATURATION_HUE_SATURATION_HPP
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "indexedColor.hpp"
+
+#include <algorithm>
+#include <string>
+#include <cassert>
+#include <cmath>
+
+#include "api/api_sfm.hpp"
+#include "api/api_photoshop.hpp"
+#include "api/api_bar.hpp"
+#include "api/api_canvas.hpp"
+
+#include "pluginLib/bars/ps_bar.hpp"
+#include "pluginLib/filters/colorQuantization.hpp"
+#include "pluginLib/filters/sliderFilterButton.hpp"
+
+using namespace ps;
+using namespace psapi;
+using namespace psapi::sfm;
+
+namespace
+{
+
+const char* const kIndexedColorTitle = "Indexed Color";
+
+// indexed by the "Dither" slider
+const DitherMethod kDitherMethods[] = {
+    DitherMethod::None,
+    DitherMethod::FloydSteinberg,
+    DitherMethod::Ordered,
+};
+
+const size_t kDitherMethodsCount = sizeof(kDitherMethods) / sizeof(kDitherMethods[0]);
+
+// parameters - colors count, dither method
+Pixels2D indexedColorFilter(const Pixels2D& pixels, const std::vector<float>& parameters, float /* scale */)
+{
+    assert(parameters.size() == 2);
+
+    size_t colorsCount = static_cast<size_t>(std::max(std::lround(parameters[0]), 1l));
+    long dither = std::clamp(std::lround(parameters[1]), 0l, static_cast<long>(kDitherMethodsCount - 1));
+
+    return getQuantized(pixels, colorsCount, kDitherMethods[dither]);
+}
+
+size_t noHalo(const std::vector<float>&)
+{
+    return 0;
+}
+
+} // namespace anonymous
+
+bool onLoadPlugin()
+{
+    std::unique_ptr<IText> text = IText::create();
+    std::unique_ptr<IFont> font = IFont::create();
+    font->loadFromFile("assets/fonts/arial.ttf");
+    text->setFont(font.get());
+
+    // dither: 0 - none, 1 - Floyd-Steinberg, 2 - ordered
+    const float maxDither = static_cast<float>(kDitherMethodsCount - 1);
+    std::vector<SliderParameters> sliders = {{"Colors: ", 2, 256, 16},
+                                             {"Dither: ", 0, maxDither, 1}};
+
+    // palette and error diffusion are global, so the committed filter gets the whole layer in one tile
+    auto button = std::make_unique<SliderFilterButton>(std::move(text), std::move(font), kIndexedColorTitle,
+                                                       std::move(sliders), indexedColorFilter, noHalo,
+                                                       FilterPreview::getWholeLayerTiling);
+
+    IWindowContainer* rootWindow = getRootWindow();
+    assert(rootWindow);
+    auto filterMenu = dynamic_cast<IMenuButton*>(rootWindow->getWindowById(kMenuFilterId));
+    assert(filterMenu);
+
+    filterMenu->addMenuItem(std::move(button));
+
+    return true;
+}
+
+void onUnloadPlugin()
+{
+    return;
+}
@@ -0,0 +1,12 @@
+#ifndef PLUGINS_INDEXED_COLOR_INDEXED_COLOR_HPP
+#define PLUGINS_INDEXED_COLOR_INDEXED_COLOR_HPP
+
+extern "C"
+{
+
+bool onLoadPlugin();
+void onUnloadPlugin();
+
+}
+
+#endif // PLUGINS_INDEXED_COLOR_INDEXED_COLOR_HPP
@@ -0,0 +1,424 @@
+#include "layerEffects.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "api/api_sfm.hpp"
+#include "api/api_photoshop.hpp"
+#include "api/api_bar.hpp"
+#include "api/api_canvas.hpp"
+
+#include "pluginLib/actions/actions.hpp"
+#include "pluginLib/bars/ps_bar.hpp"
+#include "pluginLib/canvas/canvas.hpp"
+#include "pluginLib/filters/distanceTransform.hpp"
+#include "pluginLib/filters/filterExecutor.hpp"
+#include "pluginLib/filters/filterJobs.hpp"
+#include "pluginLib/filters/filterWindows.hpp"
+#include "pluginLib/selection/selection.hpp"
+
+using namespace ps;
+using namespace psapi;
+using namespace psapi::sfm;
+
+namespace
+{
+
+// coverage of the effect at (x, y) of the full layer, [0, 1]
+using EffectShader = std::function<float(const DistanceField& field, size_t x, size_t y)>;
+
+// Effect is drawn under the layer pixels in one color, its shape comes from the distance field
+struct LayerEffect
+{
+    const char* title;
+    std::vector<SliderParameters> sliders;
+
+    std::function<EffectShader(const std::vector<float>& parameters)> createShader;
+    std::function<Color(const std::vector<float>& parameters)> getColor; // alpha is the opacity
+};
+
+uint8_t toChannel(float value)
+{
+    return static_cast<uint8_t>(std::clamp(std::lround(value), 0l, 255l));
+}
+
+Color getSlidersColor(const std::vector<float>& parameters, size_t firstChannel)
+{
+    assert(parameters.size() == firstChannel + 4);
+
+    return Color{toChannel(parameters[firstChannel]), toChannel(parameters[firstChannel + 1]),
+                 toChannel(parameters[firstChannel + 2]), toChannel(parameters[firstChannel + 3] * 255.f / 100.f)};
+}
+
+// parameters: size, red, green, blue, opacity %
+LayerEffect createStroke()
+{
+    LayerEffect effect;
+
+    effect.title   = "Stroke";
+    effect.sliders = {{"Size: ", 1, 50, 3},
+                      {"Red: ", 0, 255, 0},
+                      {"Green: ", 0, 255, 0},
+                      {"Blue: ", 0, 255, 0},
+                      {"Opacity %: ", 0, 100, 100}};
+
+    // outer edge is antialiased over one pixel
+    effect.createShader = [](const std::vector<float>& parameters) -> EffectShader
+    {
+        float size = parameters[0];
+
+        return [size](const DistanceField& field, size_t x, size_t y)
+        {
+            return std::clamp(size + 0.5f - field.at(x, y), 0.f, 1.f);
+        };
+    };
+
+    effect.getColor = [](const std::vector<float>& parameters) { return getSlidersColor(parameters, 1); };
+
+    return effect;
+}
+
+// parameters: size, red, green, blue, opacity %
+LayerEffect createOuterGlow()
+{
+    LayerEffect effect;
+
+    effect.title   = "Outer Glow";
+    effect.sliders = {{"Size: ", 1, 100, 10},
+                      {"Red: ", 0, 255, 255},
+                      {"Green: ", 0, 255, 255},
+                      {"Blue: ", 0, 255, 190},
+                      {"Opacity %: ", 0, 100, 75}};
+
+    // quadratic falloff to zero at size
+    effect.createShader = [](const std::vector<float>& parameters) -> EffectShader
+    {
+        float size = parameters[0];
+
+        return [size](const DistanceField& field, size_t x, size_t y)
+        {
+            float falloff = std::max(1.f - field.at(x, y) / size, 0.f);
+            return falloff * falloff;
+        };
+    };
+
+    effect.getColor = [](const std::vector<float>& parameters) { return getSlidersColor(parameters, 1); };
+
+    return effect;
+}
+
+// parameters: distance, angle, size, opacity %
+LayerEffect createDropShadow()
+{
+    LayerEffect effect;
+
+    effect.title   = "Drop Shadow";
+    effect.sliders = {{"Distance: ", 0, 100, 10},
+                      {"Angle: ", -180, 180, 45},
+                      {"Size: ", 0, 50, 5},
+                      {"Opacity %: ", 0, 100, 75}};
+
+    // silhouette moved by distance in the angle direction, softened outwards by size
+    effect.createShader = [](const std::vector<float>& parameters) -> EffectShader
+    {
+        float angle = parameters[1] * static_cast<float>(M_PI) / 180.f;
+
+        long offsetX = std::lround(parameters[0] * std::cos(angle));
+        long offsetY = std::lround(parameters[0] * std::sin(angle));
+        float size   = parameters[2];
+
+        return [offsetX, offsetY, size](const DistanceField& field, size_t x, size_t y)
+        {
+            long sourceX = static_cast<long>(x) - offsetX;
+            long sourceY = static_cast<long>(y) - offsetY;
+
+            if (sourceX < 0 || sourceY < 0 ||
+                sourceX >= static_cast<long>(field.width) || sourceY >= static_cast<long>(field.height))
+                return 0.f;
+
+            float distance = field.at(static_cast<size_t>(sourceX), static_cast<size_t>(sourceY));
+
+            if (size < 1.f)
+                return distance < 0.5f ? 1.f : 0.f;
+
+            return std::max(1.f - distance / size, 0.f);
+        };
+    };
+
+    effect.getColor = [](const std::vector<float>& parameters)
+    {
+        return Color{0, 0, 0, toChannel(parameters[3] * 255.f / 100.f)};
+    };
+
+    return effect;
+}
+
+// pixels of rect of the full layer with the effect under them
+void applyEffect(Pixels2D& pixels, const IntRect& rect, const DistanceField& field,
+                 const EffectShader& shader, Color color)
+{
+    parallelForRows(pixels.size(), [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+        {
+            size_t layerY = static_cast<size_t>(rect.pos.y) + y;
+
+            for (size_t x = 0; x < pixels[y].size(); ++x)
+            {
+                size_t layerX = static_cast<size_t>(rect.pos.x) + x;
+
+                Color effectColor = color;
+                effectColor.a = toChannel(static_cast<float>(color.a) * shader(field, layerX, layerY));
+
+                pixels[y][x] = compositeOver(effectColor, pixels[y][x]);
+            }
+        }
+    });
+}
+
+// Layer menu button of an effect. The distance field of the layer is taken on opening, sliders
+// only reshade it: the preview redraws the visible region, "Ok" applies the effect to the whole layer
+// in background. The field is kept until the layer changes, so reopening the effects is free too.
+class LayerEffectButton : public ANamedBarButton
+{
+public:
+    LayerEffectButton(std::unique_ptr<IText> name, std::unique_ptr<IFont> font, LayerEffect effect);
+
+    std::unique_ptr<IAction> createAction(const IRenderWindow* renderWindow,
+                                          const Event& event) override;
+
+    bool update(const IRenderWindow* renderWindow, const Event& event);
+    void draw(IRenderWindow* renderWindow) override;
+
+private:
+    void beginPreview(ICanvas* canvas);
+    void updatePreview(ICanvas* canvas, const std::vector<float>& parameters);
+    void endPreview(ICanvas* canvas);
+
+    void commit(ICanvas* canvas, const std::vector<float>& parameters);
+
+private:
+    LayerEffect effect_;
+    std::unique_ptr<FilterWindow> effectWindow_;
+
+    size_t layerIndex_ = 0;
+    std::shared_ptr<const DistanceField> field_;
+
+    IntRect visibleRect_; // part of the full layer on the screen
+    Pixels2D visiblePixels_;
+    std::vector<float> previewParameters_;
+
+    std::shared_ptr<FilterJob> job_;
+};
+
+// layers of the canvas share one field, all the effects are opened on the active one
+LayerDistanceField& getLayerDistanceField()
+{
+    static LayerDistanceField field;
+    return field;
+}
+
+LayerEffectButton::LayerEffectButton(std::unique_ptr<IText> name, std::unique_ptr<IFont> font, LayerEffect effect)
+    : effect_(std::move(effect))
+{
+    name_ = std::move(name);
+    font_ = std::move(font);
+
+    name_->setString(effect_.title);
+}
+
+std::unique_ptr<IAction> LayerEffectButton::createAction(const IRenderWindow* renderWindow,
+                                                         const Event& event)
+{
+    return std::make_unique<UpdateCallbackAction<LayerEffectButton>>(*this, renderWindow, event);
+}
+
+bool LayerEffectButton::update(const IRenderWindow* renderWindow, const Event& event)
+{
+    bool updateStateRes = updateState(renderWindow, event);
+
+    ICanvas* canvas = static_cast<ICanvas*>(getRootWindow()->getWindowById(kCanvasWindowId));
+    assert(canvas);
+
+    if (state_ != State::Released)
+    {
+        if (effectWindow_)
+        {
+            effectWindow_->close();
+            effectWindow_.reset();
+            endPreview(canvas);
+        }
+
+        return updateStateRes;
+    }
+
+    if (updateStateRes)
+    {
+        beginPreview(canvas);
+        effectWindow_ = createSlidersFilterWindow(effect_.title, effect_.sliders);
+    }
+
+    assert(effectWindow_);
+
+    AActionController* actionController = getActionController();
+
+    if (!actionController->execute(effectWindow_->createAction(renderWindow, event)))
+    {
+        std::vector<float> parameters = getSlidersValues(effectWindow_.get(), effect_.sliders);
+
+        endPreview(canvas);
+
+        if (effectWindow_->isConfirmed())
+            commit(canvas, parameters);
+
+        field_.reset();
+
+        effectWindow_.reset();
+        state_ = State::Normal;
+        return false;
+    }
+
+    updatePreview(canvas, getSlidersValues(effectWindow_.get(), effect_.sliders));
+
+    return true;
+}
+
+void LayerEffectButton::beginPreview(ICanvas* canvas)
+{
+    layerIndex_ = canvas->getActiveLayerIndex();
+    const ILayer* layer = canvas->getLayer(layerIndex_);
+    assert(layer);
+
+    vec2u screenSize = canvas->getSize();
+    vec2u fullSize   = getLayerFullSize(layer, screenSize);
+    vec2i visiblePos = getLayerVisiblePos(layer);
+
+    field_ = getLayerDistanceField().update(layer, screenSize);
+
+    int right  = std::min(visiblePos.x + static_cast<int>(screenSize.x), static_cast<int>(fullSize.x));
+    int bottom = std::min(visiblePos.y + static_cast<int>(screenSize.y), static_cast<int>(fullSize.y));
+
+    visibleRect_ = IntRect{visiblePos, vec2u{static_cast<unsigned>(std::max(right  - visiblePos.x, 0)),
+                                             static_cast<unsigned>(std::max(bottom - visiblePos.y, 0))}};
+
+    visiblePixels_ = getLayerRegion(layer, visibleRect_);
+
+    previewParameters_.clear();
+}
+
+void LayerEffectButton::updatePreview(ICanvas* canvas, const std::vector<float>& parameters)
+{
+    if (!field_ || parameters == previewParameters_)
+        return;
+
+    previewParameters_ = parameters;
+
+    Pixels2D preview = visiblePixels_;
+    applyEffect(preview, visibleRect_, *field_, effect_.createShader(parameters), effect_.getColor(parameters));
+
+    // temp layer is in screen coordinates
+    ILayer* tempLayer = canvas->getTempLayer();
+
+    for (size_t y = 0; y < preview.size(); ++y)
+    {
+        for (size_t x = 0; x < preview[y].size(); ++x)
+            tempLayer->setPixel(vec2i{static_cast<int>(x), static_cast<int>(y)}, preview[y][x]);
+    }
+}
+
+void LayerEffectButton::endPreview(ICanvas* canvas)
+{
+    canvas->cleanTempLayer();
+
+    visiblePixels_.clear();
+    previewParameters_.clear();
+}
+
+void LayerEffectButton::commit(ICanvas* canvas, const std::vector<float>& parameters)
+{
+    if (!field_ || (job_ && !job_->isDone()))
+        return;
+
+    if (layerIndex_ >= canvas->getNumLayers())
+        return;
+
+    const ILayer* layer = canvas->getLayer(layerIndex_);
+    IntRect layerRect = {{0, 0}, vec2u{static_cast<unsigned>(field_->width), static_cast<unsigned>(field_->height)}};
+
+    auto original = std::make_shared<Pixels2D>(getLayerRegion(layer, layerRect));
+
+    job_ = getFilterJobsWindow()->submit(
+        [original, field = field_, layerRect, selection = getCanvasSelection(canvas),
+         shader = effect_.createShader(parameters), color = effect_.getColor(parameters)]()
+        {
+            Pixels2D result = *original;
+            applyEffect(result, layerRect, *field, shader, color);
+
+            if (selection.isActive())
+                applySelection(selection, layerRect.pos, *original, result);
+
+            return result;
+        },
+        [canvas, layerIndex = layerIndex_](const Pixels2D& result)
+        {
+            if (layerIndex >= canvas->getNumLayers())
+                return;
+
+            auto saving = std::make_unique<CanvasSaverAction>();
+            saving->setPastSnapshot(canvas->save());
+
+            setLayerRegion(canvas->getLayer(layerIndex), vec2i{0, 0}, result);
+
+            saving->setFutureSnapshot(canvas->save());
+            getActionController()->execute(std::move(saving));
+        });
+}
+
+void LayerEffectButton::draw(IRenderWindow* renderWindow)
+{
+    std::string title = effect_.title;
+
+    if (job_ && !job_->isDone())
+        title += " " + std::to_string(static_cast<int>(job_->getProgress() * 100.f)) + "%";
+
+    name_->setString(title);
+
+    ANamedBarButton::draw(renderWindow);
+
+    if (effectWindow_)
+        effectWindow_->draw(renderWindow);
+}
+
+} // namespace anonymous
+
+bool onLoadPlugin()
+{
+    IWindowContainer* rootWindow = getRootWindow();
+    assert(rootWindow);
+    auto layerMenu = dynamic_cast<IMenuButton*>(rootWindow->getWindowById(kMenuLayerId));
+    assert(layerMenu);
+
+    std::vector<LayerEffect> effects = {createStroke(), createOuterGlow(), createDropShadow()};
+
+    for (LayerEffect& effect : effects)
+    {
+        std::unique_ptr<IText> text = IText::create();
+        std::unique_ptr<IFont> font = IFont::create();
+        font->loadFromFile("assets/fonts/arial.ttf");
+        text->setFont(font.get());
+
+        layerMenu->addMenuItem(std::make_unique<LayerEffectButton>(std::move(text), std::move(font),
+                                                                   std::move(effect)));
+    }
+
+    return true;
+}
+
+void onUnloadPlugin()
+{
+    return;
+}
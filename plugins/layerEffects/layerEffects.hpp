@@ -0,0 +1,12 @@
+#ifndef PLUGINS_LAYER_EFFECTS_LAYER_EFFECTS_HPP
+#define PLUGINS_LAYER_EFFECTS_LAYER_EFFECTS_HPP
+
+extern "C"
+{
+
+bool onLoadPlugin();
+void onUnloadPlugin();
+
+}
+
+#endif // PLUGINS_LAYER_EFFECTS_LAYER_EFFECTS_HPP
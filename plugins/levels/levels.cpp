@@ -0,0 +1,117 @@
+#include "levels.hpp"
+
+#include <string>
+#include <cassert>
+#include <algorithm>
+
+#include "api/api_sfm.hpp"
+#include "api/api_photoshop.hpp"
+#include "api/api_bar.hpp"
+#include "api/api_canvas.hpp"
+
+#include "pluginLib/bars/ps_bar.hpp"
+#include "pluginLib/filters/filters.hpp"
+#include "pluginLib/filters/filterGraph.hpp"
+#include "pluginLib/filters/histogram.hpp"
+#include "pluginLib/filters/sliderFilterButton.hpp"
+#include "pluginLib/selection/selection.hpp"
+
+using namespace ps;
+using namespace psapi;
+using namespace psapi::sfm;
+
+namespace
+{
+
+const char* const kLevelsTitle       = "Levels";
+const char* const kAutoContrastTitle = "Auto Contrast";
+
+// darkest and brightest 0.1% of values are treated as noise
+const float kAutoContrastClipFraction = 0.001f;
+
+Pixels2D applyLutCopy(const Pixels2D& pixels, const ChannelsLut& lut)
+{
+    Pixels2D result = pixels;
+    applyLut(result, lut);
+
+    return result;
+}
+
+// parameters - black point, white point, gamma
+Pixels2D levelsFilter(const Pixels2D& pixels, const std::vector<float>& parameters, float /* scale */)
+{
+    assert(parameters.size() == 3);
+
+    int black = std::clamp(static_cast<int>(parameters[0]), 0, 254);
+    int white = std::clamp(static_cast<int>(parameters[1]), black + 1, 255);
+
+    ChannelsLut lut = makeLevelsLut(static_cast<uint8_t>(black), static_cast<uint8_t>(white), parameters[2]);
+
+    return applyLutCopy(pixels, lut);
+}
+
+size_t noHalo(const std::vector<float>& /* parameters */)
+{
+    return 0;
+}
+
+// tiles counted for the previous press are reused
+LayerHistogram& getLayerHistogram()
+{
+    static LayerHistogram histogram;
+    return histogram;
+}
+
+FilterButton::Filter createAutoContrastFilter(const ICanvas* canvas, size_t layerIndex)
+{
+    const ILayer* layer = canvas->getLayer(layerIndex);
+    assert(layer);
+
+    const Histogram& histogram = getLayerHistogram().update(layer, canvas->getSize(), getCanvasSelection(canvas));
+    ChannelsLut lut = makeAutoContrastLut(histogram, kAutoContrastClipFraction);
+
+    return [lut](const Pixels2D& pixels) { return applyLutCopy(pixels, lut); };
+}
+
+void createFonts(std::unique_ptr<IText>& text, std::unique_ptr<IFont>& font)
+{
+    text = IText::create();
+    font = IFont::create();
+    font->loadFromFile("assets/fonts/arial.ttf");
+    text->setFont(font.get());
+}
+
+} // namespace anonymous
+
+bool onLoadPlugin()
+{
+    IWindowContainer* rootWindow = getRootWindow();
+    assert(rootWindow);
+    auto filterMenu = dynamic_cast<IMenuButton*>(rootWindow->getWindowById(kMenuFilterId));
+    assert(filterMenu);
+
+    std::unique_ptr<IText> text;
+    std::unique_ptr<IFont> font;
+
+    createFonts(text, font);
+
+    const float maxGamma = 5;
+    std::vector<SliderParameters> sliders = {{"Black: ", 0,    254,      0},
+                                             {"White: ", 1,    255,      255},
+                                             {"Gamma: ", 0.1f, maxGamma, 1, 0.01f}};
+
+    filterMenu->addMenuItem(std::make_unique<SliderFilterButton>(std::move(text), std::move(font), kLevelsTitle,
+                                                                 std::move(sliders), levelsFilter, noHalo));
+
+    createFonts(text, font);
+
+    filterMenu->addMenuItem(std::make_unique<FilterButton>(std::move(text), std::move(font), kAutoContrastTitle, 0,
+                                                           FilterButton::FilterFactory{createAutoContrastFilter}));
+
+    return true;
+}
+
+void onUnloadPlugin()
+{
+    return;
+}
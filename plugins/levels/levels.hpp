@@ -0,0 +1,12 @@
+#ifndef PLUGINS_LEVELS_LEVELS_HPP
+#define PLUGINS_LEVELS_LEVELS_HPP
+
+extern "C"
+{
+
+bool onLoadPlugin();
+void onUnloadPlugin();
+
+}
+
+#endif // PLUGINS_LEVELS_LEVELS_HPP
\ No newline at end of file
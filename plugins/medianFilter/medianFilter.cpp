@@ -0,0 +1,116 @@
+#include "medianFilter.hpp"
+
+#include <algorithm>
+#include <string>
+#include <cassert>
+#include <cmath>
+
+#include "api/api_sfm.hpp"
+#include "api/api_photoshop.hpp"
+#include "api/api_bar.hpp"
+#include "api/api_canvas.hpp"
+
+#include "pluginLib/bars/ps_bar.hpp"
+#include "pluginLib/filters/medianFilter.hpp"
+#include "pluginLib/filters/nonLocalMeans.hpp"
+#include "pluginLib/filters/sliderFilterButton.hpp"
+
+using namespace ps;
+using namespace psapi;
+using namespace psapi::sfm;
+
+namespace
+{
+
+const char* const kMedianTitle = "Median";
+const char* const kReduceNoiseTitle = "Reduce Noise";
+
+// search window grows with the quality, cost grows with its area
+const size_t kBaseSearchRadius = 2;
+const size_t kPatchRadius      = 2;
+
+Pixels2D medianFilter(const Pixels2D& pixels, const std::vector<float>& parameters, float scale)
+{
+    assert(parameters.size() == 1);
+
+    long radius = std::lround(parameters[0] * scale);
+
+    return getMedianFiltered(pixels, static_cast<size_t>(radius));
+}
+
+size_t medianHalo(const std::vector<float>& parameters)
+{
+    assert(parameters.size() == 1);
+
+    return static_cast<size_t>(std::lround(parameters[0]));
+}
+
+size_t getSearchRadius(float quality)
+{
+    return kBaseSearchRadius + static_cast<size_t>(std::max(std::lround(quality), 1l));
+}
+
+// parameters - strength, quality. Radii are about the noise grain, they aren't scaled on proxies.
+Pixels2D reduceNoiseFilter(const Pixels2D& pixels, const std::vector<float>& parameters, float /* scale */)
+{
+    assert(parameters.size() == 2);
+
+    return getNonLocalMeansDenoised(pixels, parameters[0], getSearchRadius(parameters[1]), kPatchRadius);
+}
+
+size_t reduceNoiseHalo(const std::vector<float>& parameters)
+{
+    assert(parameters.size() == 2);
+
+    return getSearchRadius(parameters[1]) + kPatchRadius;
+}
+
+void addReduceNoiseButton(IMenuButton* filterMenu)
+{
+    std::unique_ptr<IText> text = IText::create();
+    std::unique_ptr<IFont> font = IFont::create();
+    font->loadFromFile("assets/fonts/arial.ttf");
+    text->setFont(font.get());
+
+    // quality 1 is a 7x7 search window
+    const float maxStrength = 50;
+    const float maxQuality  = 5;
+    std::vector<SliderParameters> sliders = {{"Strength: ", 1, maxStrength, 10},
+                                             {"Quality: ",  1, maxQuality,  1}};
+
+    filterMenu->addMenuItem(std::make_unique<SliderFilterButton>(std::move(text), std::move(font), kReduceNoiseTitle,
+                                                                 std::move(sliders), reduceNoiseFilter,
+                                                                 reduceNoiseHalo));
+}
+
+} // namespace anonymous
+
+bool onLoadPlugin()
+{
+    std::unique_ptr<IText> text = IText::create();
+    std::unique_ptr<IFont> font = IFont::create();
+    font->loadFromFile("assets/fonts/arial.ttf");
+    text->setFont(font.get());
+
+    const float maxRadius = 20;
+    std::vector<SliderParameters> sliders = {{"Radius: ", 0, maxRadius, 0}};
+
+    auto button = std::make_unique<SliderFilterButton>(std::move(text), std::move(font), kMedianTitle,
+                                                       std::move(sliders), medianFilter, medianHalo);
+
+    IWindowContainer* rootWindow = getRootWindow();
+    assert(rootWindow);
+    auto filterMenu = dynamic_cast<IMenuButton*>(rootWindow->getWindowById(kMenuFilterId));
+    assert(filterMenu);
+
+    filterMenu->addMenuItem(std::move(button));
+
+    addReduceNoiseButton(filterMenu);
+
+    return true;
+}
+
+void onUnloadPlugin()
+{
+    return;
+}
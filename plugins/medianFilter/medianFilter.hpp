@@ -0,0 +1,12 @@
+#ifndef PLUGINS_MEDIAN_FILTER_MEDIAN_FILTER_HPP
+#define PLUGINS_MEDIAN_FILTER_MEDIAN_FILTER_HPP
+
+extern "C"
+{
+
+bool onLoadPlugin();
+void onUnloadPlugin();
+
+}
+
+#endif // PLUGINS_MEDIAN_FILTER_MEDIAN_FILTER_HPP
\ No newline at end of file
@@ -0,0 +1,222 @@
+#include "morphology.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <string>
+
+#include "api/api_sfm.hpp"
+#include "api/api_photoshop.hpp"
+#include "api/api_bar.hpp"
+#include "api/api_canvas.hpp"
+
+#include "pluginLib/actions/actions.hpp"
+#include "pluginLib/bars/ps_bar.hpp"
+#include "pluginLib/canvas/canvas.hpp"
+#include "pluginLib/filters/filterWindows.hpp"
+#include "pluginLib/filters/morphology.hpp"
+#include "pluginLib/filters/sliderFilterButton.hpp"
+#include "pluginLib/selection/selection.hpp"
+
+using namespace ps;
+using namespace psapi;
+using namespace psapi::sfm;
+
+namespace
+{
+
+const float kMaxRadius = 50;
+
+struct MorphologyFilter
+{
+    const char* title;
+    MorphologyOperation operation;
+};
+
+const MorphologyFilter kMorphologyFilters[] = {
+    {"Minimum", MorphologyOperation::Erode },
+    {"Maximum", MorphologyOperation::Dilate},
+    {"Open",    MorphologyOperation::Open  },
+    {"Close",   MorphologyOperation::Close },
+};
+
+const MorphologyFilter kSelectionFilters[] = {
+    {"Expand Selection",   MorphologyOperation::Dilate},
+    {"Contract Selection", MorphologyOperation::Erode },
+};
+
+// parameters: radius, shape (0 - square, 1 - disk)
+std::vector<SliderParameters> getMorphologySliders()
+{
+    return {{"Radius: ", 1, kMaxRadius, 1},
+            {"Shape: ",  0, 1,          0}};
+}
+
+size_t getRadius(const std::vector<float>& parameters, float scale)
+{
+    assert(parameters.size() == 2);
+
+    return static_cast<size_t>(std::max(std::lround(parameters[0] * scale), 0l));
+}
+
+StructuringElement getElement(const std::vector<float>& parameters)
+{
+    assert(parameters.size() == 2);
+
+    return std::lround(parameters[1]) == 0 ? StructuringElement::Square : StructuringElement::Disk;
+}
+
+// Changes the mask of the canvas selection, feather radius is kept
+class SelectionMorphologyButton : public ANamedBarButton
+{
+public:
+    SelectionMorphologyButton(std::unique_ptr<IText> name, std::unique_ptr<IFont> font,
+                              const MorphologyFilter& filter);
+
+    std::unique_ptr<IAction> createAction(const IRenderWindow* renderWindow,
+                                          const Event& event) override;
+
+    bool update(const IRenderWindow* renderWindow, const Event& event);
+    void draw(IRenderWindow* renderWindow) override;
+
+private:
+    MorphologyFilter filter_;
+
+    std::vector<SliderParameters> sliders_;
+    std::unique_ptr<FilterWindow> window_;
+};
+
+SelectionMorphologyButton::SelectionMorphologyButton(std::unique_ptr<IText> name, std::unique_ptr<IFont> font,
+                                                     const MorphologyFilter& filter)
+    : filter_(filter), sliders_(getMorphologySliders())
+{
+    name_ = std::move(name);
+    font_ = std::move(font);
+
+    name_->setString(filter_.title);
+}
+
+std::unique_ptr<IAction> SelectionMorphologyButton::createAction(const IRenderWindow* renderWindow,
+                                                                 const Event& event)
+{
+    return std::make_unique<UpdateCallbackAction<SelectionMorphologyButton>>(*this, renderWindow, event);
+}
+
+bool SelectionMorphologyButton::update(const IRenderWindow* renderWindow, const Event& event)
+{
+    bool updateStateRes = updateState(renderWindow, event);
+
+    if (state_ != State::Released)
+    {
+        if (window_)
+        {
+            window_->close();
+            window_.reset();
+        }
+
+        return updateStateRes;
+    }
+
+    if (updateStateRes)
+        window_ = createSlidersFilterWindow(filter_.title, sliders_);
+
+    assert(window_);
+
+    if (!getActionController()->execute(window_->createAction(renderWindow, event)))
+    {
+        if (window_->isConfirmed())
+        {
+            ICanvas* canvas = static_cast<ICanvas*>(getRootWindow()->getWindowById(kCanvasWindowId));
+            assert(canvas);
+
+            Selection selection = getCanvasSelection(canvas);
+
+            if (selection.isActive())
+            {
+                std::vector<float> parameters = getSlidersValues(window_.get(), sliders_);
+
+                // expanded selection may grow past the layer
+                ILayer* layer = canvas->getLayer(canvas->getActiveLayerIndex());
+                vec2u layerSize = getLayerFullSize(layer, canvas->getSize());
+
+                SelectionMask mask = getMorphology(selection.getMask(), filter_.operation,
+                                                   getRadius(parameters, 1.f), getElement(parameters)).clip(layerSize);
+
+                // contracted away selection becomes inactive, the whole layer is editable again
+                setCanvasSelection(canvas, mask.isEmpty() ? Selection{}
+                                                          : Selection{std::move(mask), selection.getFeatherRadius()});
+            }
+        }
+
+        window_.reset();
+        state_ = State::Normal;
+        return false;
+    }
+
+    return true;
+}
+
+void SelectionMorphologyButton::draw(IRenderWindow* renderWindow)
+{
+    ANamedBarButton::draw(renderWindow);
+
+    if (window_)
+        window_->draw(renderWindow);
+}
+
+template <typename Button, typename... Args>
+void addMenuItem(IMenuButton* menu, Args&&... args)
+{
+    std::unique_ptr<IText> text = IText::create();
+    std::unique_ptr<IFont> font = IFont::create();
+    font->loadFromFile("assets/fonts/arial.ttf");
+    text->setFont(font.get());
+
+    menu->addMenuItem(std::make_unique<Button>(std::move(text), std::move(font), std::forward<Args>(args)...));
+}
+
+} // namespace anonymous
+
+bool onLoadPlugin()
+{
+    IWindowContainer* rootWindow = getRootWindow();
+    assert(rootWindow);
+
+    auto filterMenu = dynamic_cast<IMenuButton*>(rootWindow->getWindowById(kMenuFilterId));
+    assert(filterMenu);
+
+    for (const MorphologyFilter& filter : kMorphologyFilters)
+    {
+        MorphologyOperation operation = filter.operation;
+
+        auto morphologyFilter = [operation](const Pixels2D& pixels, const std::vector<float>& parameters, float scale)
+        {
+            return getMorphology(pixels, operation, getRadius(parameters, scale), getElement(parameters));
+        };
+
+        // open and close read the radius around the pixels the first pass reads
+        size_t haloFactor = operation == MorphologyOperation::Open || operation == MorphologyOperation::Close ? 2 : 1;
+
+        auto morphologyHalo = [haloFactor](const std::vector<float>& parameters)
+        {
+            return haloFactor * getRadius(parameters, 1.f);
+        };
+
+        addMenuItem<SliderFilterButton>(filterMenu, filter.title, getMorphologySliders(),
+                                        morphologyFilter, morphologyHalo);
+    }
+
+    auto layerMenu = dynamic_cast<IMenuButton*>(rootWindow->getWindowById(kMenuLayerId));
+    assert(layerMenu);
+
+    for (const MorphologyFilter& filter : kSelectionFilters)
+        addMenuItem<SelectionMorphologyButton>(layerMenu, filter);
+
+    return true;
+}
+
+void onUnloadPlugin()
+{
+    return;
+}
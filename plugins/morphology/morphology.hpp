@@ -0,0 +1,12 @@
+#ifndef PLUGINS_MORPHOLOGY_MORPHOLOGY_HPP
+#define PLUGINS_MORPHOLOGY_MORPHOLOGY_HPP
+
+extern "C"
+{
+
+bool onLoadPlugin();
+void onUnloadPlugin();
+
+}
+
+#endif // PLUGINS_MORPHOLOGY_MORPHOLOGY_HPP
@@ -0,0 +1,78 @@
+#include "mosaic.hpp"
+
+#include <string>
+#include <cassert>
+#include <cmath>
+
+#include "api/api_sfm.hpp"
+#include "api/api_photoshop.hpp"
+#include "api/api_bar.hpp"
+#include "api/api_canvas.hpp"
+
+#include "pluginLib/bars/ps_bar.hpp"
+#include "pluginLib/filters/filters.hpp"
+#include "pluginLib/filters/sliderFilterButton.hpp"
+
+using namespace ps;
+using namespace psapi;
+using namespace psapi::sfm;
+
+namespace
+{
+
+const char* const kMosaicTitle = "Mosaic";
+
+size_t getCellSize(const std::vector<float>& parameters, float scale)
+{
+    assert(parameters.size() == 1);
+
+    return static_cast<size_t>(std::max(std::lround(parameters[0] * scale), 1l));
+}
+
+Pixels2D mosaicFilter(const Pixels2D& pixels, const std::vector<float>& parameters, float scale)
+{
+    return getMosaic(pixels, getCellSize(parameters, scale));
+}
+
+// cells don't read outside of themselves
+size_t mosaicHalo(const std::vector<float>&)
+{
+    return 0;
+}
+
+// tiles have to start on the cells boundaries
+LayerTiling mosaicTiling(const std::vector<float>& parameters)
+{
+    return LayerTiling::alignedRows(getCellSize(parameters, 1.f));
+}
+
+} // namespace anonymous
+
+bool onLoadPlugin()
+{
+    std::unique_ptr<IText> text = IText::create();
+    std::unique_ptr<IFont> font = IFont::create();
+    font->loadFromFile("assets/fonts/arial.ttf");
+    text->setFont(font.get());
+
+    const float maxCellSize = 64;
+    std::vector<SliderParameters> sliders = {{"Cell size: ", 1, maxCellSize, 8}};
+
+    auto button = std::make_unique<SliderFilterButton>(std::move(text), std::move(font), kMosaicTitle,
+                                                       std::move(sliders), mosaicFilter, mosaicHalo,
+                                                       mosaicTiling);
+
+    IWindowContainer* rootWindow = getRootWindow();
+    assert(rootWindow);
+    auto filterMenu = dynamic_cast<IMenuButton*>(rootWindow->getWindowById(kMenuFilterId));
+    assert(filterMenu);
+
+    filterMenu->addMenuItem(std::move(button));
+
+    return true;
+}
+
+void onUnloadPlugin()
+{
+    return;
+}
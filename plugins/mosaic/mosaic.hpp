@@ -0,0 +1,12 @@
+#ifndef PLUGINS_MOSAIC_MOSAIC_HPP
+#define PLUGINS_MOSAIC_MOSAIC_HPP
+
+extern "C"
+{
+
+bool onLoadPlugin();
+void onUnloadPlugin();
+
+}
+
+#endif // PLUGINS_MOSAIC_MOSAIC_HPP
\ No newline at end of file
@@ -15,7 +15,7 @@
 #include "pluginLib/bars/ps_bar.hpp"
 #include "pluginLib/windows/windows.hpp"
 #include "pluginLib/filters/filters.hpp"
-#include "pluginLib/actions/actions.hpp"
+#include "pluginLib/filters/filterGraph.hpp"
 #include "pluginLib/bars/menu.hpp"
 
 #include <iostream>
@@ -27,54 +27,12 @@ using namespace psapi::sfm;
 namespace
 {
 
-class NegativeFilterButton : public ANamedBarButton 
+std::vector<std::vector<Color>> negativeFilter(const std::vector<std::vector<Color>>& pixels)
 {
-public:
-    NegativeFilterButton(std::unique_ptr<IText> text, std::unique_ptr<IFont> font);
-
-    std::unique_ptr<IAction> createAction(const IRenderWindow* renderWindow, const Event& event) override;
-    bool update(const IRenderWindow* renderWindow, const Event& event);
-};
-
-NegativeFilterButton::NegativeFilterButton(std::unique_ptr<IText> text, std::unique_ptr<IFont> font)
-{
-    name_ = std::move(text);
-    font_ = std::move(font);
-}
-
-std::unique_ptr<IAction> NegativeFilterButton::createAction(const IRenderWindow* renderWindow, 
-                                                            const Event& event)
-{
-    return std::make_unique<UpdateCallbackAction<NegativeFilterButton>>(*this, renderWindow, event);
+    return FilterGraph{}.addLut(makeNegativeLut()).apply(pixels);
 }
 
-bool NegativeFilterButton::update(const IRenderWindow* renderWindow, const Event& event)
-{
-    bool updateStateRes = updateState(renderWindow, event);
-
-    if (state_ != State::Released)
-        return updateStateRes;
-
-    ICanvas* canvas = static_cast<ICanvas*>(getRootWindow()->getWindowById(kCanvasWindowId));
-    assert(canvas);
-    
-    size_t activeLayerIndex = canvas->getActiveLayerIndex();
-    ILayer* activeLayer = canvas->getLayer(activeLayerIndex);
-
-    vec2u canvasSize = canvas->getSize();
-
-    std::vector<std::vector<Color>> pixels = getLayerScreenIn2D(activeLayer, canvasSize);
-    std::vector<std::vector<Color>> negative = getNegative(pixels);
-    
-    std::vector<std::vector<Color>> basRelief = getBasRelief(pixels, negative);
-    copyPixelsToLayer(activeLayer, negative);
-    
-    state_ = State::Normal;
-
-    return true;
-}
-
-}
+} // namespace anonymous
 
 bool onLoadPlugin()
 {
@@ -82,9 +40,8 @@ bool onLoadPlugin()
     std::unique_ptr<IFont> font = IFont::create();
     font->loadFromFile("assets/fonts/arial.ttf");
     text->setFont(font.get());
-    text->setString("Negative");
     
-    auto button = std::make_unique<NegativeFilterButton>(std::move(text), std::move(font));
+    auto button = std::make_unique<FilterButton>(std::move(text), std::move(font), "Negative", 0, negativeFilter);
 
     IWindowContainer* rootWindow = getRootWindow();
     assert(rootWindow);
@@ -1,5 +1,10 @@
 #include "canvas.hpp"
 
+#include "api/api_actions.hpp"
+
+#include "pluginLib/canvas/regionLayer.hpp"
+#include "pluginLib/canvas/versionedLayer.hpp"
+
 #include <cassert>
 #include <iostream>
 
@@ -132,4 +137,98 @@ void copyPixelsToLayer(ILayer* layer, const std::vector<std::vector<Color>>& pix
             layer->setPixel(vec2i{static_cast<int>(x), static_cast<int>(y)}, pixels[y][x]);
 }
 
+vec2u getLayerFullSize(const ILayer* layer, const vec2u& screenSize)
+{
+    auto regionLayer = dynamic_cast<const IRegionLayer*>(layer);
+
+    return regionLayer ? regionLayer->getFullSize() : screenSize;
+}
+
+std::vector<std::vector<Color>> getLayerRegion(const ILayer* layer, const IntRect& region)
+{
+    std::vector<std::vector<Color>> pixels(region.size.y, std::vector<Color>(region.size.x));
+
+    auto regionLayer = dynamic_cast<const IRegionLayer*>(layer);
+
+    for (unsigned y = 0; y < region.size.y; ++y)
+    {
+        std::vector<Color>& row = pixels[y];
+        int layerY = region.pos.y + static_cast<int>(y);
+
+        if (regionLayer)
+        {
+            regionLayer->readRegion(vec2i{region.pos.x, layerY}, vec2u{region.size.x, 1}, row.data());
+            continue;
+        }
+
+        for (unsigned x = 0; x < region.size.x; ++x)
+            row[x] = layer->getPixel(vec2i{region.pos.x + static_cast<int>(x), layerY});
+    }
+
+    return pixels;
+}
+
+void setLayerRegion(ILayer* layer, const vec2i& pos, const std::vector<std::vector<Color>>& pixels)
+{
+    auto regionLayer = dynamic_cast<IRegionLayer*>(layer);
+
+    for (size_t y = 0; y < pixels.size(); ++y)
+    {
+        const std::vector<Color>& row = pixels[y];
+        int layerY = pos.y + static_cast<int>(y);
+
+        if (regionLayer)
+        {
+            regionLayer->writeRegion(vec2i{pos.x, layerY}, vec2u{static_cast<unsigned>(row.size()), 1}, row.data());
+            continue;
+        }
+
+        for (size_t x = 0; x < row.size(); ++x)
+            layer->setPixel(vec2i{pos.x + static_cast<int>(x), layerY}, row[x]);
+    }
+}
+
+vec2i getLayerVisiblePos(const ILayer* layer)
+{
+    auto versionedLayer = dynamic_cast<const IVersionedLayer*>(layer);
+
+    return versionedLayer ? versionedLayer->getVisiblePos() : vec2i{0, 0};
+}
+
+void commitPixelsToLayer(ICanvas* canvas, size_t layerIndex, const std::vector<std::vector<Color>>& pixels)
+{
+    assert(canvas);
+
+    // layer may be removed while filter was running
+    if (layerIndex >= canvas->getNumLayers())
+        return;
+
+    auto canvasSaving = std::make_unique<CanvasSaverAction>();
+    canvasSaving->setPastSnapshot(canvas->save());
+
+    copyPixelsToLayer(canvas->getLayer(layerIndex), pixels);
+
+    canvasSaving->setFutureSnapshot(canvas->save());
+    getActionController()->execute(std::move(canvasSaving));
+}
+
+Color compositeOver(Color dst, Color src)
+{
+    if (src.a == 255 || dst.a == 0)
+        return src;
+
+    if (src.a == 0)
+        return dst;
+
+    int dstWeight = dst.a * (255 - src.a) / 255;
+    int alpha     = src.a + dstWeight;
+
+    auto blend = [&](uint8_t dstChannel, uint8_t srcChannel)
+    {
+        return static_cast<uint8_t>((srcChannel * src.a + dstChannel * dstWeight) / alpha);
+    };
+
+    return Color{blend(dst.r, src.r), blend(dst.g, src.g), blend(dst.b, src.b), static_cast<uint8_t>(alpha)};
+}
+
 } // namespace ps
\ No newline at end of file
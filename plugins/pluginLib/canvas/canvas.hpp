@@ -41,6 +41,20 @@ std::vector<Color> getLayerScreenIn1D(const ILayer* layer, const vec2u& size);
 
 void copyPixelsToLayer(ILayer* layer, const std::vector<std::vector<Color>>& pixels);
 
+// Whole layer access, layers without region support are limited to the visible screen
+vec2u getLayerFullSize(const ILayer* layer, const vec2u& screenSize);
+std::vector<std::vector<Color>> getLayerRegion(const ILayer* layer, const IntRect& region);
+void setLayerRegion(ILayer* layer, const vec2i& pos, const std::vector<std::vector<Color>>& pixels);
+
+// position of the visible part inside the full layer
+vec2i getLayerVisiblePos(const ILayer* layer);
+
+// copies pixels to the layer and records undoable action
+void commitPixelsToLayer(ICanvas* canvas, size_t layerIndex, const std::vector<std::vector<Color>>& pixels);
+
+// src over dst, colors are not premultiplied
+Color compositeOver(Color dst, Color src);
+
 } // namespace ps
 
 #endif // PLUGIN_LIB_CANVAS_CANVAS_HPP
\ No newline at end of file
@@ -0,0 +1,29 @@
+#ifndef PLUGINS_PLUGIN_LIB_CANVAS_REGION_LAYER_HPP
+#define PLUGINS_PLUGIN_LIB_CANVAS_REGION_LAYER_HPP
+
+#include "api/api_sfm.hpp"
+
+namespace ps
+{
+
+using namespace psapi::sfm;
+
+// Implemented by canvas layers in addition to ILayer, gives access to the whole layer,
+// not only to its visible part. Positions are in the full layer coordinates.
+class IRegionLayer
+{
+public:
+    virtual vec2u getFullSize() const = 0;
+
+    // pixels - size.x * size.y row by row, pixels outside of the layer are transparent
+    virtual void readRegion (const vec2i& pos, const vec2u& size, Color* pixels) const = 0;
+
+    // pixels outside of the layer are skipped
+    virtual void writeRegion(const vec2i& pos, const vec2u& size, const Color* pixels) = 0;
+
+    virtual ~IRegionLayer() = default;
+};
+
+} // namespace ps
+
+#endif // PLUGINS_PLUGIN_LIB_CANVAS_REGION_LAYER_HPP
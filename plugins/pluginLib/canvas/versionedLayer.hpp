@@ -0,0 +1,37 @@
+#ifndef PLUGINS_PLUGIN_LIB_CANVAS_VERSIONED_LAYER_HPP
+#define PLUGINS_PLUGIN_LIB_CANVAS_VERSIONED_LAYER_HPP
+
+#include "api/api_sfm.hpp"
+
+#include <cstdint>
+
+namespace ps
+{
+
+using namespace psapi::sfm;
+
+// side of the square tiles the full layer is split into for change tracking
+const unsigned kLayerTileSize = 256;
+
+// Implemented by canvas layers in addition to ILayer, lets caches recognize unchanged content.
+class IVersionedLayer
+{
+public:
+    // unique for the whole program run
+    virtual uint64_t getLayerId() const = 0;
+
+    // increases on every change of the layer content
+    virtual uint64_t getVersion() const = 0;
+
+    // layer version of the last change of pixels in tile (x, y), tiles cover the full layer row by row
+    virtual uint64_t getTileVersion(const vec2u& tile) const = 0;
+
+    // position of the visible area inside the full layer
+    virtual vec2i getVisiblePos() const = 0;
+
+    virtual ~IVersionedLayer() = default;
+};
+
+} // namespace ps
+
+#endif // PLUGINS_PLUGIN_LIB_CANVAS_VERSIONED_LAYER_HPP
@@ -0,0 +1,311 @@
+#include "affineTransform.hpp"
+
+#include "pluginLib/filters/filterExecutor.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+
+namespace ps
+{
+
+namespace
+{
+
+const float kPi = 3.14159265f;
+
+const int kCoordBits      = 16; // fractional bits of the stepped source coordinates
+const int kFractionBits   = 8;  // fractional bits used by the sampling weights
+const int kCubicBits      = 14;
+const size_t kTileWidth   = 64;
+
+const int64_t kCoordOne   = int64_t{1} << kCoordBits;
+const int kFractionsCount = 1 << kFractionBits;
+
+using CubicWeights = std::array<std::array<int, 4>, kFractionsCount>;
+
+float toRadians(float degrees)
+{
+    return degrees * kPi / 180.f;
+}
+
+int64_t toFixed(double value)
+{
+    return static_cast<int64_t>(std::llround(value * static_cast<double>(kCoordOne)));
+}
+
+int getFraction(int64_t coord)
+{
+    return static_cast<int>((coord >> (kCoordBits - kFractionBits)) & (kFractionsCount - 1));
+}
+
+int getIndex(int64_t coord)
+{
+    return static_cast<int>(coord >> kCoordBits);
+}
+
+size_t clampIndex(int index, int size)
+{
+    return static_cast<size_t>(std::clamp(index, 0, size - 1));
+}
+
+uint8_t toChannel(int64_t value)
+{
+    return static_cast<uint8_t>(std::clamp(value, int64_t{0}, int64_t{255}));
+}
+
+// Catmull-Rom weights of taps -1, 0, 1, 2 for every fraction, every row sums to 1 << kCubicBits
+CubicWeights computeCubicWeights()
+{
+    CubicWeights table;
+
+    for (size_t i = 0; i < static_cast<size_t>(kFractionsCount); ++i)
+    {
+        float t  = static_cast<float>(i) / static_cast<float>(kFractionsCount);
+        float t2 = t * t;
+        float t3 = t2 * t;
+
+        std::array<float, 4> weights = {(-t3 + 2.f * t2 - t) / 2.f,
+                                        (3.f * t3 - 5.f * t2 + 2.f) / 2.f,
+                                        (-3.f * t3 + 4.f * t2 + t) / 2.f,
+                                        (t3 - t2) / 2.f};
+
+        int sum = 0;
+        for (size_t k = 0; k < 4; ++k)
+        {
+            table[i][k] = static_cast<int>(std::lround(weights[k] * static_cast<float>(1 << kCubicBits)));
+            sum += table[i][k];
+        }
+
+        // rounding error goes to the bigger of two middle taps, so flat colors stay exact
+        size_t largest = weights[1] >= weights[2] ? 1 : 2;
+        table[i][largest] += (1 << kCubicBits) - sum;
+    }
+
+    return table;
+}
+
+const CubicWeights& getCubicWeights()
+{
+    static const CubicWeights weights = computeCubicWeights();
+    return weights;
+}
+
+Color sampleBilinear(const Pixels2D& source, int width, int height, int64_t u, int64_t v)
+{
+    int x = getIndex(u);
+    int y = getIndex(v);
+
+    int fx = getFraction(u);
+    int fy = getFraction(v);
+
+    const std::vector<Color>& row0 = source[clampIndex(y,     height)];
+    const std::vector<Color>& row1 = source[clampIndex(y + 1, height)];
+
+    size_t x0 = clampIndex(x,     width);
+    size_t x1 = clampIndex(x + 1, width);
+
+    const int one = kFractionsCount;
+    const int shift = 2 * kFractionBits;
+    const int half  = 1 << (shift - 1);
+
+    auto lerp2D = [&](uint8_t Color::* channel)
+    {
+        int top    = (row0[x0].*channel) * (one - fx) + (row0[x1].*channel) * fx;
+        int bottom = (row1[x0].*channel) * (one - fx) + (row1[x1].*channel) * fx;
+
+        return static_cast<uint8_t>((top * (one - fy) + bottom * fy + half) >> shift);
+    };
+
+    return Color{lerp2D(&Color::r), lerp2D(&Color::g), lerp2D(&Color::b), lerp2D(&Color::a)};
+}
+
+Color sampleBicubic(const Pixels2D& source, int width, int height, int64_t u, int64_t v)
+{
+    const CubicWeights& table = getCubicWeights();
+
+    int x = getIndex(u);
+    int y = getIndex(v);
+
+    const std::array<int, 4>& weightsX = table[static_cast<size_t>(getFraction(u))];
+    const std::array<int, 4>& weightsY = table[static_cast<size_t>(getFraction(v))];
+
+    std::array<size_t, 4> columns;
+    for (size_t k = 0; k < 4; ++k)
+        columns[k] = clampIndex(x - 1 + static_cast<int>(k), width);
+
+    int64_t r = 0, g = 0, b = 0, a = 0;
+
+    for (size_t ky = 0; ky < 4; ++ky)
+    {
+        const std::vector<Color>& row = source[clampIndex(y - 1 + static_cast<int>(ky), height)];
+
+        int rowR = 0, rowG = 0, rowB = 0, rowA = 0;
+
+        for (size_t kx = 0; kx < 4; ++kx)
+        {
+            const Color& pixel = row[columns[kx]];
+
+            rowR += weightsX[kx] * pixel.r;
+            rowG += weightsX[kx] * pixel.g;
+            rowB += weightsX[kx] * pixel.b;
+            rowA += weightsX[kx] * pixel.a;
+        }
+
+        r += static_cast<int64_t>(rowR) * weightsY[ky];
+        g += static_cast<int64_t>(rowG) * weightsY[ky];
+        b += static_cast<int64_t>(rowB) * weightsY[ky];
+        a += static_cast<int64_t>(rowA) * weightsY[ky];
+    }
+
+    const int shift = 2 * kCubicBits;
+    const int64_t half = int64_t{1} << (shift - 1);
+
+    return Color{toChannel((r + half) >> shift), toChannel((g + half) >> shift),
+                 toChannel((b + half) >> shift), toChannel((a + half) >> shift)};
+}
+
+template <typename Sampler>
+Pixels2D transformWith(const Pixels2D& source, const vec2i& sourcePos, const AffineTransform& transform,
+                       const IntRect& region, Sampler sample)
+{
+    Pixels2D result(region.size.y, std::vector<Color>(region.size.x, Color{0, 0, 0, 0}));
+
+    int height = static_cast<int>(source.size());
+    int width  = height > 0 ? static_cast<int>(source[0].size()) : 0;
+
+    if (width == 0 || region.size.x == 0)
+        return result;
+
+    AffineTransform inverse = transform.inverse();
+
+    // source covers [-0.5, size - 0.5) in the coordinates of its pixel centers
+    const int64_t minU = -kCoordOne / 2, maxU = static_cast<int64_t>(width)  * kCoordOne - kCoordOne / 2;
+    const int64_t minV = -kCoordOne / 2, maxV = static_cast<int64_t>(height) * kCoordOne - kCoordOne / 2;
+
+    const int64_t stepU = toFixed(inverse.a);
+    const int64_t stepV = toFixed(inverse.c);
+
+    parallelForRows(region.size.y, [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t tileBegin = 0; tileBegin < region.size.x; tileBegin += kTileWidth)
+        {
+            size_t tileEnd = std::min(tileBegin + kTileWidth, static_cast<size_t>(region.size.x));
+
+            for (size_t y = rowBegin; y < rowEnd; ++y)
+            {
+                // exact position at the start of every tile row keeps the accumulated error negligible
+                vec2f center = {static_cast<float>(region.pos.x) + static_cast<float>(tileBegin) + 0.5f,
+                                static_cast<float>(region.pos.y) + static_cast<float>(y) + 0.5f};
+                vec2f start = inverse.apply(center);
+
+                int64_t u = toFixed(static_cast<double>(start.x) - sourcePos.x - 0.5);
+                int64_t v = toFixed(static_cast<double>(start.y) - sourcePos.y - 0.5);
+
+                std::vector<Color>& row = result[y];
+
+                for (size_t x = tileBegin; x < tileEnd; ++x, u += stepU, v += stepV)
+                {
+                    if (u >= minU && u < maxU && v >= minV && v < maxV)
+                        row[x] = sample(source, width, height, u, v);
+                }
+            }
+        }
+    });
+
+    return result;
+}
+
+} // namespace anonymous
+
+AffineTransform AffineTransform::create(const vec2f& center, float angle, const vec2f& scale, float skew)
+{
+    float cosAngle = std::cos(toRadians(angle));
+    float sinAngle = std::sin(toRadians(angle));
+    float shear    = std::tan(toRadians(skew));
+
+    // rotation * skew * scale
+    AffineTransform transform;
+
+    transform.a = cosAngle * scale.x;
+    transform.b = (cosAngle * shear - sinAngle) * scale.y;
+    transform.c = sinAngle * scale.x;
+    transform.d = (sinAngle * shear + cosAngle) * scale.y;
+
+    transform.tx = center.x - (transform.a * center.x + transform.b * center.y);
+    transform.ty = center.y - (transform.c * center.x + transform.d * center.y);
+
+    return transform;
+}
+
+vec2f AffineTransform::apply(const vec2f& point) const
+{
+    return vec2f{a * point.x + b * point.y + tx, c * point.x + d * point.y + ty};
+}
+
+AffineTransform AffineTransform::inverse() const
+{
+    float determinant = a * d - b * c;
+    assert(std::fabs(determinant) > 1e-6f);
+
+    AffineTransform inverted;
+
+    inverted.a =  d / determinant;
+    inverted.b = -b / determinant;
+    inverted.c = -c / determinant;
+    inverted.d =  a / determinant;
+
+    inverted.tx = -(inverted.a * tx + inverted.b * ty);
+    inverted.ty = -(inverted.c * tx + inverted.d * ty);
+
+    return inverted;
+}
+
+IntRect getTransformedBounds(const IntRect& rect, const AffineTransform& transform)
+{
+    float left   = static_cast<float>(rect.pos.x);
+    float top    = static_cast<float>(rect.pos.y);
+    float right  = left + static_cast<float>(rect.size.x);
+    float bottom = top  + static_cast<float>(rect.size.y);
+
+    std::array<vec2f, 4> corners = {transform.apply({left, top}),    transform.apply({right, top}),
+                                    transform.apply({left, bottom}), transform.apply({right, bottom})};
+
+    float minX = corners[0].x, maxX = corners[0].x;
+    float minY = corners[0].y, maxY = corners[0].y;
+
+    for (const vec2f& corner : corners)
+    {
+        minX = std::min(minX, corner.x);
+        maxX = std::max(maxX, corner.x);
+        minY = std::min(minY, corner.y);
+        maxY = std::max(maxY, corner.y);
+    }
+
+    vec2i pos = {static_cast<int>(std::floor(minX)), static_cast<int>(std::floor(minY))};
+    vec2u size = {static_cast<unsigned>(static_cast<int>(std::ceil(maxX)) - pos.x),
+                  static_cast<unsigned>(static_cast<int>(std::ceil(maxY)) - pos.y)};
+
+    return IntRect{pos, size};
+}
+
+Pixels2D transformPixels(const Pixels2D& source, const vec2i& sourcePos, const AffineTransform& transform,
+                         const IntRect& region, AffineSampling sampling)
+{
+    switch (sampling)
+    {
+        case AffineSampling::Bilinear:
+            return transformWith(source, sourcePos, transform, region, sampleBilinear);
+
+        case AffineSampling::Bicubic:
+            return transformWith(source, sourcePos, transform, region, sampleBicubic);
+
+        default:
+            assert(false);
+            return Pixels2D{};
+    }
+}
+
+} // namespace ps
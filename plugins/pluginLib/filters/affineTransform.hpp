@@ -0,0 +1,43 @@
+#ifndef PLUGINS_PLUGIN_LIB_FILTERS_AFFINE_TRANSFORM_HPP
+#define PLUGINS_PLUGIN_LIB_FILTERS_AFFINE_TRANSFORM_HPP
+
+#include "pluginLib/filters/filterGraph.hpp"
+
+namespace ps
+{
+
+// point -> (a * x + b * y + tx, c * x + d * y + ty), pixel (x, y) covers [x, x + 1) x [y, y + 1)
+struct AffineTransform
+{
+    float a = 1.f, b = 0.f;
+    float c = 0.f, d = 1.f;
+
+    float tx = 0.f, ty = 0.f;
+
+    // scale, then horizontal skew, then clockwise rotation, all around center. Angles are in degrees.
+    static AffineTransform create(const vec2f& center, float angle, const vec2f& scale, float skew);
+
+    vec2f apply(const vec2f& point) const;
+
+    // transform has to be invertible
+    AffineTransform inverse() const;
+};
+
+enum class AffineSampling
+{
+    Bilinear,
+    Bicubic,  // Catmull-Rom
+};
+
+// bounding box of the transformed rectangle
+IntRect getTransformedBounds(const IntRect& rect, const AffineTransform& transform);
+
+// Inverse mapping: every pixel of region gets the source color at the inverse transformed position of its
+// center, pixels mapped outside of the source are transparent. Source coordinates are stepped incrementally
+// in fixed point along the rows of 64 pixels wide tiles, so there is no matrix multiply per pixel.
+Pixels2D transformPixels(const Pixels2D& source, const vec2i& sourcePos, const AffineTransform& transform,
+                         const IntRect& region, AffineSampling sampling);
+
+} // namespace ps
+
+#endif // PLUGINS_PLUGIN_LIB_FILTERS_AFFINE_TRANSFORM_HPP
@@ -0,0 +1,269 @@
+#include "bilateralGrid.hpp"
+
+#include "pluginLib/filters/filterExecutor.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+
+namespace ps
+{
+
+namespace
+{
+
+// empty cells around the image, so the blur and the slicing never check grid boundaries
+const size_t kGridPadding = 2;
+
+// binomial approximation of gaussian with sigma of one cell
+const float kGridBlurKernel[] = {1.f / 16, 4.f / 16, 6.f / 16, 4.f / 16, 1.f / 16};
+const size_t kGridBlurRadius = 2;
+
+const float kMinSliceWeight = 1e-4f;
+
+struct GridCell
+{
+    float r = 0;
+    float g = 0;
+    float b = 0;
+    float weight = 0;
+};
+
+class BilateralGrid
+{
+public:
+    BilateralGrid(size_t width, size_t height, size_t depth)
+        : width_(width), height_(height), depth_(depth), cells_(width * height * depth)
+    {
+    }
+
+    size_t getWidth () const { return width_;  }
+    size_t getHeight() const { return height_; }
+    size_t getDepth () const { return depth_;  }
+
+    GridCell& at(size_t x, size_t y, size_t z) { return cells_[(y * width_ + x) * depth_ + z]; }
+
+    const GridCell& at(size_t x, size_t y, size_t z) const { return cells_[(y * width_ + x) * depth_ + z]; }
+
+private:
+    size_t width_;
+    size_t height_;
+    size_t depth_;
+
+    std::vector<GridCell> cells_; // z is the fastest axis
+};
+
+// Grid position of the pixel in cells. Cell centers are at multiples of the sigma from the layer
+// origin, phase is the position of the first pixel relatively to the cell before it.
+struct GridMapping
+{
+    float spatialSigma;
+    float rangeSigma;
+    vec2f phase;
+
+    float getX(size_t x) const { return static_cast<float>(x) / spatialSigma + phase.x; }
+    float getY(size_t y) const { return static_cast<float>(y) / spatialSigma + phase.y; }
+    float getZ(uint8_t luminance) const { return static_cast<float>(luminance) / rangeSigma; }
+};
+
+float getGridPhase(int origin, float sigma)
+{
+    float cells = static_cast<float>(origin) / sigma;
+
+    return cells - std::floor(cells);
+}
+
+size_t getGridCoord(float cells)
+{
+    return static_cast<size_t>(std::lround(cells)) + kGridPadding;
+}
+
+size_t getGridSize(float lastCells)
+{
+    return getGridCoord(lastCells) + kGridPadding + 1;
+}
+
+// every band owns its grid rows, pixels are splatted to the nearest cell
+void splat(const Pixels2D& pixels, BilateralGrid& grid, const GridMapping& mapping)
+{
+    parallelForRows(grid.getHeight(), [&](size_t gridRowBegin, size_t gridRowEnd)
+    {
+        for (size_t y = 0; y < pixels.size(); ++y)
+        {
+            size_t gridY = getGridCoord(mapping.getY(y));
+            if (gridY < gridRowBegin || gridY >= gridRowEnd)
+                continue;
+
+            const std::vector<Color>& row = pixels[y];
+
+            for (size_t x = 0; x < row.size(); ++x)
+            {
+                Color color = row[x];
+
+                size_t gridX = getGridCoord(mapping.getX(x));
+                size_t gridZ = getGridCoord(mapping.getZ(getLuminance(color)));
+
+                GridCell& cell = grid.at(gridX, gridY, gridZ);
+                cell.r += color.r;
+                cell.g += color.g;
+                cell.b += color.b;
+                cell.weight += 1;
+            }
+        }
+    });
+}
+
+void addCell(GridCell& sum, const GridCell& cell, float weight)
+{
+    sum.r      += cell.r      * weight;
+    sum.g      += cell.g      * weight;
+    sum.b      += cell.b      * weight;
+    sum.weight += cell.weight * weight;
+}
+
+// one axis of the separable blur, cells beyond the grid are empty
+template <typename GetCell>
+GridCell blurCell(long long coord, long long size, GetCell getCell)
+{
+    GridCell sum;
+
+    for (size_t k = 0; k < std::size(kGridBlurKernel); ++k)
+    {
+        long long source = coord + static_cast<long long>(k) - static_cast<long long>(kGridBlurRadius);
+
+        if (source >= 0 && source < size)
+            addCell(sum, getCell(static_cast<size_t>(source)), kGridBlurKernel[k]);
+    }
+
+    return sum;
+}
+
+void blur(BilateralGrid& grid)
+{
+    BilateralGrid blurred(grid.getWidth(), grid.getHeight(), grid.getDepth());
+
+    long long width  = static_cast<long long>(grid.getWidth());
+    long long height = static_cast<long long>(grid.getHeight());
+    long long depth  = static_cast<long long>(grid.getDepth());
+
+    auto blurAxis = [&](const BilateralGrid& source, BilateralGrid& destination, size_t axis)
+    {
+        parallelForRows(grid.getHeight(), [&](size_t rowBegin, size_t rowEnd)
+        {
+            for (size_t y = rowBegin; y < rowEnd; ++y)
+            {
+                for (size_t x = 0; x < grid.getWidth(); ++x)
+                {
+                    for (size_t z = 0; z < grid.getDepth(); ++z)
+                    {
+                        GridCell& cell = destination.at(x, y, z);
+
+                        if (axis == 0)
+                            cell = blurCell(static_cast<long long>(x), width,
+                                            [&](size_t i) -> const GridCell& { return source.at(i, y, z); });
+                        else if (axis == 1)
+                            cell = blurCell(static_cast<long long>(y), height,
+                                            [&](size_t i) -> const GridCell& { return source.at(x, i, z); });
+                        else
+                            cell = blurCell(static_cast<long long>(z), depth,
+                                            [&](size_t i) -> const GridCell& { return source.at(x, y, i); });
+                    }
+                }
+            }
+        });
+    };
+
+    blurAxis(grid,    blurred, 0);
+    blurAxis(blurred, grid,    1);
+    blurAxis(grid,    blurred, 2);
+
+    grid = std::move(blurred);
+}
+
+uint8_t normalizeChannel(float value, float weight)
+{
+    return static_cast<uint8_t>(std::clamp(std::lround(value / weight), 0l, 255l));
+}
+
+void slice(const Pixels2D& pixels, const BilateralGrid& grid, Pixels2D& result, const GridMapping& mapping)
+{
+    const float padding = static_cast<float>(kGridPadding);
+
+    parallelForRows(pixels.size(), [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+        {
+            const std::vector<Color>& row = pixels[y];
+            std::vector<Color>& resultRow = result[y];
+            resultRow = row;
+
+            float gridY = mapping.getY(y) + padding;
+            size_t y0 = static_cast<size_t>(gridY);
+            float fy = gridY - static_cast<float>(y0);
+
+            for (size_t x = 0; x < row.size(); ++x)
+            {
+                float gridX = mapping.getX(x) + padding;
+                float gridZ = mapping.getZ(getLuminance(row[x])) + padding;
+
+                size_t x0 = static_cast<size_t>(gridX);
+                size_t z0 = static_cast<size_t>(gridZ);
+
+                float fx = gridX - static_cast<float>(x0);
+                float fz = gridZ - static_cast<float>(z0);
+
+                GridCell sum;
+
+                for (size_t corner = 0; corner < 8; ++corner)
+                {
+                    size_t dx = corner & 1;
+                    size_t dy = (corner >> 1) & 1;
+                    size_t dz = (corner >> 2) & 1;
+
+                    float weight = (dx ? fx : 1 - fx) * (dy ? fy : 1 - fy) * (dz ? fz : 1 - fz);
+
+                    addCell(sum, grid.at(x0 + dx, y0 + dy, z0 + dz), weight);
+                }
+
+                if (sum.weight < kMinSliceWeight)
+                    continue;
+
+                resultRow[x].r = normalizeChannel(sum.r, sum.weight);
+                resultRow[x].g = normalizeChannel(sum.g, sum.weight);
+                resultRow[x].b = normalizeChannel(sum.b, sum.weight);
+            }
+        }
+    });
+}
+
+} // namespace anonymous
+
+Pixels2D getBilateralFiltered(const Pixels2D& pixels, float spatialSigma, float rangeSigma, const vec2i& origin)
+{
+    assert(spatialSigma > 0);
+    assert(rangeSigma   > 0);
+
+    size_t height = pixels.size();
+    size_t width  = height > 0 ? pixels[0].size() : 0;
+
+    if (width == 0)
+        return pixels;
+
+    GridMapping mapping{spatialSigma, rangeSigma,
+                        vec2f{getGridPhase(origin.x, spatialSigma), getGridPhase(origin.y, spatialSigma)}};
+
+    BilateralGrid grid(getGridSize(mapping.getX(width - 1)), getGridSize(mapping.getY(height - 1)),
+                       getGridSize(mapping.getZ(255)));
+
+    splat(pixels, grid, mapping);
+    blur(grid);
+
+    Pixels2D result(height);
+    slice(pixels, grid, result, mapping);
+
+    return result;
+}
+
+} // namespace ps
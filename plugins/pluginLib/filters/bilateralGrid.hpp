@@ -0,0 +1,20 @@
+#ifndef PLUGINS_PLUGIN_LIB_FILTERS_BILATERAL_GRID_HPP
+#define PLUGINS_PLUGIN_LIB_FILTERS_BILATERAL_GRID_HPP
+
+#include "pluginLib/filters/filterGraph.hpp"
+
+namespace ps
+{
+
+// Edge preserving smoothing, alpha is kept. spatialSigma - in pixels, rangeSigma - in luminance levels.
+// Pixels are splatted into a grid downsampled by the sigmas in (x, y, luminance), the grid is blurred and
+// sliced back with trilinear interpolation, so the cost barely depends on spatialSigma. Grid memory grows
+// as 1 / (spatialSigma^2 * rangeSigma), callers have to keep the sigmas away from one.
+// origin - position of the first pixel in the layer, grid cells are aligned to the layer, so tiles
+// of one layer are filtered without seams.
+Pixels2D getBilateralFiltered(const Pixels2D& pixels, float spatialSigma, float rangeSigma,
+                              const vec2i& origin = {0, 0});
+
+} // namespace ps
+
+#endif // PLUGINS_PLUGIN_LIB_FILTERS_BILATERAL_GRID_HPP
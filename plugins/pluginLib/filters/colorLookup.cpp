@@ -0,0 +1,346 @@
+#include "colorLookup.hpp"
+
+#include "pluginLib/filters/filterExecutor.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sys/stat.h>
+
+namespace ps
+{
+
+namespace
+{
+
+const uint32_t kFractionBits = 12;
+const uint32_t kFractionOne  = 1 << kFractionBits;
+
+// fixed-point value of 1.0 in the entries, 8 bits of the color and 8 bits of precision
+const float kEntryOne = 255.f * 256.f;
+
+const int kStrengthOne = 256;
+
+const char* skipSpaces(const char* text)
+{
+    while (std::isspace(static_cast<unsigned char>(*text)))
+        ++text;
+
+    return text;
+}
+
+// count floats separated by spaces and nothing after them
+bool parseFloats(const char* text, float* values, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        char* end = nullptr;
+        values[i] = std::strtof(text, &end);
+
+        if (end == text || !std::isfinite(values[i]))
+            return false;
+
+        text = end;
+    }
+
+    return *skipSpaces(text) == '\0';
+}
+
+bool isKeyword(const char* text, const char* keyword)
+{
+    size_t length = std::strlen(keyword);
+
+    return std::strncmp(text, keyword, length) == 0 && std::isspace(static_cast<unsigned char>(text[length]));
+}
+
+bool isDataLine(const char* text)
+{
+    return std::isdigit(static_cast<unsigned char>(*text)) || *text == '-' || *text == '+' || *text == '.';
+}
+
+} // namespace anonymous
+
+ColorLut3D::ColorLut3D(size_t size, const std::vector<std::array<float, 3>>& values,
+                       const std::array<float, 3>& domainMin, const std::array<float, 3>& domainMax)
+    : size_(size), entries_(values.size()), axes_(), tetrahedra_(), farCorner_(0)
+{
+    assert(size >= kMinSize && size <= kMaxSize);
+    assert(values.size() == size * size * size);
+
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        uint16_t channels[3] = {};
+
+        for (size_t channel = 0; channel < 3; ++channel)
+        {
+            float value = std::clamp(values[i][channel], 0.f, 1.f);
+            channels[channel] = static_cast<uint16_t>(std::lround(value * kEntryOne));
+        }
+
+        entries_[i] = Entry{channels[0], channels[1], channels[2], 0};
+    }
+
+    const size_t strides[3] = {1, size, size * size};
+
+    farCorner_ = strides[0] + strides[1] + strides[2];
+
+    // bits of the order: red >= green, green >= blue, red >= blue; 3 and 4 are impossible
+    const size_t largest[8]  = {2, 2, 1, 0, 0, 0, 1, 0};
+    const size_t smallest[8] = {0, 1, 0, 2, 2, 1, 2, 2};
+
+    for (size_t order = 0; order < 8; ++order)
+        tetrahedra_[order] = {strides[largest[order]], farCorner_ - strides[smallest[order]]};
+
+    for (size_t channel = 0; channel < 3; ++channel)
+    {
+        assert(domainMax[channel] > domainMin[channel]);
+
+        for (size_t value = 0; value < 256; ++value)
+        {
+            float normalized = (static_cast<float>(value) / 255.f - domainMin[channel]) /
+                               (domainMax[channel] - domainMin[channel]);
+
+            float position = std::clamp(normalized, 0.f, 1.f) * static_cast<float>(size - 1);
+
+            // the last lattice point is the far corner of the last cell
+            size_t index = std::min(static_cast<size_t>(position), size - 2);
+            float fraction = position - static_cast<float>(index);
+
+            axes_[channel][value] = AxisPoint{
+                static_cast<uint32_t>(index * strides[channel]),
+                static_cast<uint32_t>(std::lround(fraction * static_cast<float>(kFractionOne)))
+            };
+        }
+    }
+}
+
+// The cell is split into 6 tetrahedra by the order of the fractions. Walking from the origin corner
+// along the axes in the descending order of their fractions gives the 4 corners of the tetrahedron.
+// The order is random for noisy images, so it is picked by the mask of comparisons without branches.
+Color ColorLut3D::apply(Color color) const
+{
+    const AxisPoint& red   = axes_[0][color.r];
+    const AxisPoint& green = axes_[1][color.g];
+    const AxisPoint& blue  = axes_[2][color.b];
+
+    const int redFraction   = static_cast<int>(red.fraction);
+    const int greenFraction = static_cast<int>(green.fraction);
+    const int blueFraction  = static_cast<int>(blue.fraction);
+
+    size_t order = static_cast<size_t>(redFraction >= greenFraction) |
+                   static_cast<size_t>(greenFraction >= blueFraction) << 1 |
+                   static_cast<size_t>(redFraction >= blueFraction) << 2;
+
+    const int fraction1 = std::max(redFraction, std::max(greenFraction, blueFraction));
+    const int fraction3 = std::min(redFraction, std::min(greenFraction, blueFraction));
+    const int fraction2 = redFraction + greenFraction + blueFraction - fraction1 - fraction3;
+
+    const Entry* origin = entries_.data() + red.offset + green.offset + blue.offset;
+
+    const Entry& corner0 = origin[0];
+    const Entry& corner1 = origin[tetrahedra_[order].first];
+    const Entry& corner2 = origin[tetrahedra_[order].second];
+    const Entry& corner3 = origin[farCorner_];
+
+    // weights of the corners are (1 - f1), (f1 - f2), (f2 - f3), f3, so the sum is never negative
+    auto interpolate = [&](int value0, int value1, int value2, int value3)
+    {
+        int sum = (value0 << kFractionBits) + fraction1 * (value1 - value0) +
+                  fraction2 * (value2 - value1) + fraction3 * (value3 - value2);
+
+        const int shift = static_cast<int>(kFractionBits) + 8;
+        return static_cast<uint8_t>((sum + (1 << (shift - 1))) >> shift);
+    };
+
+    // fields are set one by one, the constructor of Color is not inline
+    Color result = color;
+    result.r = interpolate(corner0.r, corner1.r, corner2.r, corner3.r);
+    result.g = interpolate(corner0.g, corner1.g, corner2.g, corner3.g);
+    result.b = interpolate(corner0.b, corner1.b, corner2.b, corner3.b);
+
+    return result;
+}
+
+std::shared_ptr<const ColorLut3D> loadCubeLut(const std::string& filename)
+{
+    std::ifstream file(filename);
+    if (!file)
+        return nullptr;
+
+    size_t size = 0;
+    size_t count = 0;
+
+    std::array<float, 3> domainMin = {0.f, 0.f, 0.f};
+    std::array<float, 3> domainMax = {1.f, 1.f, 1.f};
+
+    std::vector<std::array<float, 3>> values;
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        const char* text = skipSpaces(line.c_str());
+
+        // title is quoted and may contain anything
+        if (*text == '\0' || *text == '#' || isKeyword(text, "TITLE"))
+            continue;
+
+        size_t comment = line.find('#');
+        if (comment != std::string::npos)
+            line.resize(comment);
+
+        text = skipSpaces(line.c_str());
+
+        if (isDataLine(text))
+        {
+            std::array<float, 3> value = {};
+
+            if (size == 0 || values.size() == count || !parseFloats(text, value.data(), 3))
+                return nullptr;
+
+            values.push_back(value);
+        }
+        else if (isKeyword(text, "LUT_3D_SIZE"))
+        {
+            char* end = nullptr;
+            long parsedSize = std::strtol(text + std::strlen("LUT_3D_SIZE"), &end, 10);
+
+            if (size != 0 || *skipSpaces(end) != '\0' ||
+                parsedSize < static_cast<long>(ColorLut3D::kMinSize) ||
+                parsedSize > static_cast<long>(ColorLut3D::kMaxSize))
+                return nullptr;
+
+            size  = static_cast<size_t>(parsedSize);
+            count = size * size * size;
+            values.reserve(count);
+        }
+        else if (isKeyword(text, "DOMAIN_MIN"))
+        {
+            if (!parseFloats(text + std::strlen("DOMAIN_MIN"), domainMin.data(), 3))
+                return nullptr;
+        }
+        else if (isKeyword(text, "DOMAIN_MAX"))
+        {
+            if (!parseFloats(text + std::strlen("DOMAIN_MAX"), domainMax.data(), 3))
+                return nullptr;
+        }
+        else if (isKeyword(text, "LUT_3D_INPUT_RANGE"))
+        {
+            float range[2] = {};
+            if (!parseFloats(text + std::strlen("LUT_3D_INPUT_RANGE"), range, 2))
+                return nullptr;
+
+            domainMin = {range[0], range[0], range[0]};
+            domainMax = {range[1], range[1], range[1]};
+        }
+        else if (isKeyword(text, "LUT_1D_SIZE"))
+        {
+            return nullptr;
+        }
+        // other keywords don't change a 3D table
+    }
+
+    if (size == 0 || values.size() != count)
+        return nullptr;
+
+    for (size_t channel = 0; channel < 3; ++channel)
+    {
+        if (domainMax[channel] <= domainMin[channel])
+            return nullptr;
+    }
+
+    return std::make_shared<const ColorLut3D>(size, values, domainMin, domainMax);
+}
+
+Pixels2D applyColorLut(const Pixels2D& pixels, const ColorLut3D& lut, float strength)
+{
+    Pixels2D result = pixels;
+
+    const int weight = static_cast<int>(std::lround(std::clamp(strength, 0.f, 1.f) * kStrengthOne));
+    if (weight == 0)
+        return result;
+
+    parallelForRows(pixels.size(), [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+        {
+            const std::vector<Color>& source = pixels[y];
+            std::vector<Color>& row = result[y];
+
+            Color previous = {};
+            Color previousResult = {};
+            bool hasPrevious = false;
+
+            for (size_t x = 0; x < source.size(); ++x)
+            {
+                Color color = source[x];
+
+                // flat areas repeat the colors, they are looked up once
+                if (hasPrevious && color.r == previous.r && color.g == previous.g && color.b == previous.b)
+                {
+                    row[x]   = previousResult;
+                    row[x].a = color.a;
+                    continue;
+                }
+
+                Color graded = lut.apply(color);
+
+                if (weight != kStrengthOne)
+                {
+                    auto mix = [weight](uint8_t original, uint8_t value)
+                    {
+                        return static_cast<uint8_t>((value * weight + original * (kStrengthOne - weight) +
+                                                     kStrengthOne / 2) / kStrengthOne);
+                    };
+
+                    graded.r = mix(color.r, graded.r);
+                    graded.g = mix(color.g, graded.g);
+                    graded.b = mix(color.b, graded.b);
+                }
+
+                row[x] = graded;
+
+                previous       = color;
+                previousResult = graded;
+                hasPrevious    = true;
+            }
+        }
+    });
+
+    return result;
+}
+
+std::shared_ptr<const ColorLut3D> ColorLutCache::get(const std::string& filename)
+{
+    struct stat fileStat = {};
+    bool exists = stat(filename.c_str(), &fileStat) == 0;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (!exists)
+    {
+        luts_.erase(filename);
+        return nullptr;
+    }
+
+    auto found = luts_.find(filename);
+    if (found != luts_.end() && found->second.modificationTime == fileStat.st_mtime)
+        return found->second.lut;
+
+    CachedLut& cached = luts_[filename];
+    cached.modificationTime = fileStat.st_mtime;
+    cached.lut = loadCubeLut(filename);
+
+    return cached.lut;
+}
+
+void ColorLutCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    luts_.clear();
+}
+
+} // namespace ps
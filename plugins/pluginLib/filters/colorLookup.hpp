@@ -0,0 +1,93 @@
+#ifndef PLUGINS_PLUGIN_LIB_FILTERS_COLOR_LOOKUP_HPP
+#define PLUGINS_PLUGIN_LIB_FILTERS_COLOR_LOOKUP_HPP
+
+#include "pluginLib/filters/filterGraph.hpp"
+
+#include <array>
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ps
+{
+
+// 3D color lookup table. Lattice points are kept in the order of .cube files, red index changes fastest,
+// as 16-bit fixed-point colors padded to 8 bytes: a 33^3 table takes 280 KB and stays in L2 cache.
+class ColorLut3D
+{
+public:
+    static constexpr size_t kMinSize = 2;
+    static constexpr size_t kMaxSize = 256;
+
+    // values of a lattice point, 255 * 256 is 1.0
+    struct Entry
+    {
+        uint16_t r;
+        uint16_t g;
+        uint16_t b;
+        uint16_t padding;
+    };
+
+    // from the input channel value to the lattice, offset is multiplied by the axis stride
+    struct AxisPoint
+    {
+        uint32_t offset;
+        uint32_t fraction; // 12 bits
+    };
+
+    // values - size^3 lattice points with the red index changing fastest, they are clamped to [0, 1]
+    ColorLut3D(size_t size, const std::vector<std::array<float, 3>>& values,
+               const std::array<float, 3>& domainMin, const std::array<float, 3>& domainMax);
+
+    size_t getSize() const { return size_; }
+
+    Color apply(Color color) const;
+
+private:
+    size_t size_;
+
+    std::vector<Entry> entries_;
+    std::array<std::array<AxisPoint, 256>, 3> axes_;
+
+    // offsets of the second and the third corners of the tetrahedra by the order of fractions
+    std::array<std::pair<size_t, size_t>, 8> tetrahedra_;
+    size_t farCorner_;
+};
+
+// Streaming parser of Adobe/Resolve .cube 3D tables of 2..256 points per axis: the file is read line by line,
+// so only the table itself is kept in memory. DOMAIN_MIN/DOMAIN_MAX and LUT_3D_INPUT_RANGE are supported.
+// Returns nullptr if the file can't be read or isn't a valid 3D table.
+std::shared_ptr<const ColorLut3D> loadCubeLut(const std::string& filename);
+
+// Tetrahedral interpolation in fixed point, rows in parallel. strength in [0, 1] mixes the result
+// with the original colors, alpha is kept.
+Pixels2D applyColorLut(const Pixels2D& pixels, const ColorLut3D& lut, float strength = 1.f);
+
+// Tables loaded by file name. A file is parsed again only when its modification time changes,
+// files that failed to load are remembered too. Safe to call from the filter threads.
+class ColorLutCache
+{
+public:
+    std::shared_ptr<const ColorLut3D> get(const std::string& filename);
+
+    void clear();
+
+private:
+    struct CachedLut
+    {
+        time_t modificationTime = 0;
+        std::shared_ptr<const ColorLut3D> lut;
+    };
+
+    std::mutex mutex_;
+    std::map<std::string, CachedLut> luts_;
+};
+
+} // namespace ps
+
+#endif // PLUGINS_PLUGIN_LIB_FILTERS_COLOR_LOOKUP_HPP
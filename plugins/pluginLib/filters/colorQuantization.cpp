@@ -0,0 +1,462 @@
+#include "colorQuantization.hpp"
+
+#include "pluginLib/filters/filterExecutor.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace ps
+{
+
+namespace
+{
+
+const unsigned kHistogramBits = 5;
+const unsigned kHistogramShift = 8 - kHistogramBits;
+const size_t kHistogramSide = 1 << kHistogramBits;
+
+// columns of a block of the Floyd-Steinberg wavefront
+const size_t kWavefrontBlock = 8;
+
+const int kBayerMatrix[8][8] = {
+    { 0, 32,  8, 40,  2, 34, 10, 42},
+    {48, 16, 56, 24, 50, 18, 58, 26},
+    {12, 44,  4, 36, 14, 46,  6, 38},
+    {60, 28, 52, 20, 62, 30, 54, 22},
+    { 3, 35, 11, 43,  1, 33,  9, 41},
+    {51, 19, 59, 27, 49, 17, 57, 25},
+    {15, 47,  7, 39, 13, 45,  5, 37},
+    {63, 31, 55, 23, 61, 29, 53, 21},
+};
+
+struct HistogramBin
+{
+    uint64_t count = 0;
+    std::array<uint64_t, 3> sums = {};
+};
+
+// range [begin, end) of the non-empty bins, bounds are in bin coordinates
+struct ColorBox
+{
+    size_t begin;
+    size_t end;
+
+    uint64_t count;
+    std::array<unsigned, 3> min;
+    std::array<unsigned, 3> max;
+
+    size_t getLongestAxis() const
+    {
+        size_t axis = 0;
+
+        for (size_t i = 1; i < 3; ++i)
+        {
+            if (max[i] - min[i] > max[axis] - min[axis])
+                axis = i;
+        }
+
+        return axis;
+    }
+
+    uint64_t getScore() const
+    {
+        size_t axis = getLongestAxis();
+        return count * (max[axis] - min[axis] + 1);
+    }
+};
+
+unsigned getBinCoord(size_t bin, size_t axis)
+{
+    return static_cast<unsigned>((bin >> (kHistogramBits * (2 - axis))) & (kHistogramSide - 1));
+}
+
+size_t getBin(Color color)
+{
+    return (static_cast<size_t>(color.r >> kHistogramShift) << (2 * kHistogramBits)) |
+           (static_cast<size_t>(color.g >> kHistogramShift) << kHistogramBits) |
+            static_cast<size_t>(color.b >> kHistogramShift);
+}
+
+ColorBox makeBox(const std::vector<uint32_t>& bins, const std::vector<HistogramBin>& histogram,
+                 size_t begin, size_t end)
+{
+    ColorBox box{begin, end, 0, {UINT32_MAX, UINT32_MAX, UINT32_MAX}, {0, 0, 0}};
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        box.count += histogram[bins[i]].count;
+
+        for (size_t axis = 0; axis < 3; ++axis)
+        {
+            unsigned coord = getBinCoord(bins[i], axis);
+
+            box.min[axis] = std::min(box.min[axis], coord);
+            box.max[axis] = std::max(box.max[axis], coord);
+        }
+    }
+
+    return box;
+}
+
+uint8_t clampChannel(int value)
+{
+    return static_cast<uint8_t>(std::clamp(value, 0, 255));
+}
+
+Color getQuantizedColor(const Palette& palette, const PaletteTree& tree, int r, int g, int b, uint8_t alpha)
+{
+    Color color = palette[tree.findNearest(r, g, b)];
+    color.a = alpha;
+
+    return color;
+}
+
+Pixels2D quantizeOrdered(const Pixels2D& pixels, const Palette& palette, const PaletteTree& tree, bool dither)
+{
+    // threshold spread is about the distance between the neighbor palette colors
+    float spread = dither ? 256.f / std::cbrt(static_cast<float>(palette.size())) : 0.f;
+
+    int offsets[8][8];
+    for (size_t y = 0; y < 8; ++y)
+    {
+        for (size_t x = 0; x < 8; ++x)
+            offsets[y][x] = static_cast<int>(std::lround(((static_cast<float>(kBayerMatrix[y][x]) + 0.5f) / 64.f - 0.5f) * spread));
+    }
+
+    Pixels2D result(pixels.size());
+
+    parallelForRows(pixels.size(), [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+        {
+            result[y].resize(pixels[y].size());
+
+            for (size_t x = 0; x < pixels[y].size(); ++x)
+            {
+                Color color  = pixels[y][x];
+                int offset = offsets[y % 8][x % 8];
+
+                result[y][x] = getQuantizedColor(palette, tree, color.r + offset, color.g + offset, color.b + offset,
+                                                 color.a);
+            }
+        }
+    });
+
+    return result;
+}
+
+// Block (y, c) needs its left neighbor (y, c - 1) and (y - 1, c + 1), whose last pixel diffuses into it.
+// Both are in the wave before c + 2 * y, blocks of one wave write disjoint pixels.
+Pixels2D quantizeFloydSteinberg(const Pixels2D& pixels, const Palette& palette, const PaletteTree& tree)
+{
+    const size_t height = pixels.size();
+    const size_t width  = pixels[0].size();
+    const size_t blocks = (width + kWavefrontBlock - 1) / kWavefrontBlock;
+
+    // colors with the diffused errors
+    std::vector<std::array<int16_t, 3>> work(width * height);
+
+    parallelForRows(height, [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+        {
+            for (size_t x = 0; x < width; ++x)
+            {
+                Color color = pixels[y][x];
+                work[y * width + x] = {color.r, color.g, color.b};
+            }
+        }
+    });
+
+    Pixels2D result(height, std::vector<Color>(width));
+
+    auto diffuse = [&](size_t x, size_t y, const std::array<int, 3>& error, int weight)
+    {
+        std::array<int16_t, 3>& target = work[y * width + x];
+
+        for (size_t i = 0; i < 3; ++i)
+            target[i] = static_cast<int16_t>(target[i] + error[i] * weight / 16);
+    };
+
+    auto processBlock = [&](size_t y, size_t block)
+    {
+        size_t begin = block * kWavefrontBlock;
+        size_t end   = std::min(begin + kWavefrontBlock, width);
+
+        for (size_t x = begin; x < end; ++x)
+        {
+            const std::array<int16_t, 3>& value = work[y * width + x];
+
+            std::array<int, 3> clamped = {std::clamp<int>(value[0], 0, 255), std::clamp<int>(value[1], 0, 255),
+                                          std::clamp<int>(value[2], 0, 255)};
+
+            Color color = getQuantizedColor(palette, tree, clamped[0], clamped[1], clamped[2], pixels[y][x].a);
+            result[y][x] = color;
+
+            std::array<int, 3> error = {clamped[0] - color.r, clamped[1] - color.g, clamped[2] - color.b};
+
+            if (x + 1 < width)
+                diffuse(x + 1, y, error, 7);
+
+            if (y + 1 == height)
+                continue;
+
+            if (x > 0)
+                diffuse(x - 1, y + 1, error, 3);
+
+            diffuse(x, y + 1, error, 5);
+
+            if (x + 1 < width)
+                diffuse(x + 1, y + 1, error, 1);
+        }
+    };
+
+    size_t waves = blocks + 2 * (height - 1);
+
+    for (size_t wave = 0; wave < waves; ++wave)
+    {
+        // rows with block wave - 2 * y inside of the row
+        size_t firstRow = wave + 1 > blocks ? (wave + 1 - blocks + 1) / 2 : 0;
+        size_t lastRow  = std::min(wave / 2, height - 1);
+
+        if (firstRow > lastRow)
+            continue;
+
+        bool finished = parallelForRows(lastRow - firstRow + 1, [&](size_t rowBegin, size_t rowEnd)
+        {
+            for (size_t i = rowBegin; i < rowEnd; ++i)
+            {
+                size_t y = firstRow + i;
+                processBlock(y, wave - 2 * y);
+            }
+        });
+
+        if (!finished)
+            break;
+    }
+
+    return result;
+}
+
+} // namespace anonymous
+
+Palette buildMedianCutPalette(const Pixels2D& pixels, size_t colorsCount)
+{
+    assert(colorsCount > 0);
+
+    std::vector<HistogramBin> histogram(kHistogramSide * kHistogramSide * kHistogramSide);
+
+    for (const std::vector<Color>& row : pixels)
+    {
+        for (Color color : row)
+        {
+            if (color.a == 0)
+                continue;
+
+            HistogramBin& bin = histogram[getBin(color)];
+
+            ++bin.count;
+            bin.sums[0] += color.r;
+            bin.sums[1] += color.g;
+            bin.sums[2] += color.b;
+        }
+    }
+
+    std::vector<uint32_t> bins;
+    for (size_t i = 0; i < histogram.size(); ++i)
+    {
+        if (histogram[i].count > 0)
+            bins.push_back(static_cast<uint32_t>(i));
+    }
+
+    if (bins.empty())
+        return Palette{Color{0, 0, 0, 255}};
+
+    std::vector<ColorBox> boxes = {makeBox(bins, histogram, 0, bins.size())};
+
+    while (boxes.size() < colorsCount)
+    {
+        auto isSplittable = [](const ColorBox& box) { return box.end - box.begin > 1; };
+
+        auto selected = boxes.end();
+        for (auto box = boxes.begin(); box != boxes.end(); ++box)
+        {
+            if (isSplittable(*box) && (selected == boxes.end() || box->getScore() > selected->getScore()))
+                selected = box;
+        }
+
+        if (selected == boxes.end())
+            break;
+
+        ColorBox box = *selected;
+        size_t axis = box.getLongestAxis();
+
+        std::sort(bins.begin() + static_cast<long>(box.begin), bins.begin() + static_cast<long>(box.end),
+                  [axis](uint32_t lhs, uint32_t rhs) { return getBinCoord(lhs, axis) < getBinCoord(rhs, axis); });
+
+        // both halves get at least one bin
+        size_t middle = box.begin + 1;
+        uint64_t below = histogram[bins[box.begin]].count;
+
+        while (middle + 1 < box.end && 2 * below < box.count)
+            below += histogram[bins[middle++]].count;
+
+        *selected = makeBox(bins, histogram, box.begin, middle);
+        boxes.push_back(makeBox(bins, histogram, middle, box.end));
+    }
+
+    Palette palette;
+    palette.reserve(boxes.size());
+
+    for (const ColorBox& box : boxes)
+    {
+        std::array<uint64_t, 3> sums = {};
+
+        for (size_t i = box.begin; i < box.end; ++i)
+        {
+            for (size_t channel = 0; channel < 3; ++channel)
+                sums[channel] += histogram[bins[i]].sums[channel];
+        }
+
+        auto mean = [&box](uint64_t sum) { return static_cast<uint8_t>((sum + box.count / 2) / box.count); };
+
+        palette.push_back(Color{mean(sums[0]), mean(sums[1]), mean(sums[2]), 255});
+    }
+
+    return palette;
+}
+
+// Palette tree implementation
+
+PaletteTree::PaletteTree(const Palette& palette)
+{
+    assert(!palette.empty());
+
+    nodes_.reserve(palette.size());
+
+    for (size_t i = 0; i < palette.size(); ++i)
+        nodes_.push_back(Node{{palette[i].r, palette[i].g, palette[i].b}, i, 0});
+
+    build(0, nodes_.size());
+}
+
+void PaletteTree::build(size_t begin, size_t end)
+{
+    if (end - begin <= 1)
+        return;
+
+    // axis with the largest spread
+    size_t axis = 0;
+    int bestSpread = -1;
+
+    for (size_t i = 0; i < 3; ++i)
+    {
+        auto [minNode, maxNode] = std::minmax_element(nodes_.begin() + static_cast<long>(begin),
+                                                      nodes_.begin() + static_cast<long>(end),
+                                                      [i](const Node& lhs, const Node& rhs)
+                                                      {
+                                                          return lhs.color[i] < rhs.color[i];
+                                                      });
+
+        if (maxNode->color[i] - minNode->color[i] > bestSpread)
+        {
+            bestSpread = maxNode->color[i] - minNode->color[i];
+            axis = i;
+        }
+    }
+
+    size_t middle = begin + (end - begin) / 2;
+
+    std::nth_element(nodes_.begin() + static_cast<long>(begin), nodes_.begin() + static_cast<long>(middle),
+                     nodes_.begin() + static_cast<long>(end),
+                     [axis](const Node& lhs, const Node& rhs) { return lhs.color[axis] < rhs.color[axis]; });
+
+    nodes_[middle].axis = axis;
+
+    build(begin, middle);
+    build(middle + 1, end);
+}
+
+size_t PaletteTree::findNearest(int r, int g, int b) const
+{
+    const int target[3] = {r, g, b};
+
+    size_t best = 0;
+    int bestDistance = std::numeric_limits<int>::max();
+
+    search(0, nodes_.size(), target, best, bestDistance);
+
+    return nodes_[best].paletteIndex;
+}
+
+void PaletteTree::search(size_t begin, size_t end, const int target[3], size_t& best, int& bestDistance) const
+{
+    if (begin >= end)
+        return;
+
+    size_t middle = begin + (end - begin) / 2;
+    const Node& node = nodes_[middle];
+
+    int distance = 0;
+    for (size_t i = 0; i < 3; ++i)
+        distance += (target[i] - node.color[i]) * (target[i] - node.color[i]);
+
+    if (distance < bestDistance)
+    {
+        bestDistance = distance;
+        best = middle;
+    }
+
+    if (end - begin == 1)
+        return;
+
+    int difference = target[node.axis] - node.color[node.axis];
+
+    // side of the target first, the other one only if the splitting plane is closer than the best color
+    if (difference < 0)
+    {
+        search(begin, middle, target, best, bestDistance);
+
+        if (difference * difference < bestDistance)
+            search(middle + 1, end, target, best, bestDistance);
+    }
+    else
+    {
+        search(middle + 1, end, target, best, bestDistance);
+
+        if (difference * difference < bestDistance)
+            search(begin, middle, target, best, bestDistance);
+    }
+}
+
+Pixels2D quantizeColors(const Pixels2D& pixels, const Palette& palette, DitherMethod dither)
+{
+    if (pixels.empty() || pixels[0].empty())
+        return pixels;
+
+    PaletteTree tree(palette);
+
+    switch (dither)
+    {
+        case DitherMethod::None:           return quantizeOrdered(pixels, palette, tree, false);
+        case DitherMethod::Ordered:        return quantizeOrdered(pixels, palette, tree, true);
+        case DitherMethod::FloydSteinberg: return quantizeFloydSteinberg(pixels, palette, tree);
+
+        default:
+            assert(false);
+            return pixels;
+    }
+}
+
+Pixels2D getQuantized(const Pixels2D& pixels, size_t colorsCount, DitherMethod dither)
+{
+    if (pixels.empty() || pixels[0].empty())
+        return pixels;
+
+    return quantizeColors(pixels, buildMedianCutPalette(pixels, colorsCount), dither);
+}
+
+} // namespace ps
@@ -0,0 +1,62 @@
+#ifndef PLUGINS_PLUGIN_LIB_FILTERS_COLOR_QUANTIZATION_HPP
+#define PLUGINS_PLUGIN_LIB_FILTERS_COLOR_QUANTIZATION_HPP
+
+#include "pluginLib/filters/filterGraph.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ps
+{
+
+using Palette = std::vector<Color>;
+
+// Median cut over the histogram of colors with 5 bits per channel: the box with the largest
+// population times side is split at the median of its longest side until there are colorsCount boxes.
+// Colors are the means of the boxes, alpha is ignored and fully transparent pixels aren't counted.
+Palette buildMedianCutPalette(const Pixels2D& pixels, size_t colorsCount);
+
+// k-d tree over the palette colors for the nearest color queries
+class PaletteTree
+{
+public:
+    explicit PaletteTree(const Palette& palette);
+
+    // index of the palette color nearest to (r, g, b) in RGB, channels may be out of [0, 255]
+    size_t findNearest(int r, int g, int b) const;
+
+private:
+    struct Node
+    {
+        int color[3];
+        size_t paletteIndex;
+        size_t axis;
+    };
+
+    // nodes_[begin, end) is a subtree, its root is in the middle
+    void build(size_t begin, size_t end);
+    void search(size_t begin, size_t end, const int target[3], size_t& best, int& bestDistance) const;
+
+private:
+    std::vector<Node> nodes_;
+};
+
+enum class DitherMethod
+{
+    None,
+    FloydSteinberg,
+    Ordered,        // 8x8 Bayer matrix
+};
+
+// Every pixel is replaced by a palette color, alpha is kept. Floyd-Steinberg runs as a wavefront:
+// blocks of a row go after the block above and to the right of them is done, so many rows are
+// diffused at once.
+Pixels2D quantizeColors(const Pixels2D& pixels, const Palette& palette, DitherMethod dither);
+
+// palette of the pixels themselves
+Pixels2D getQuantized(const Pixels2D& pixels, size_t colorsCount, DitherMethod dither);
+
+} // namespace ps
+
+#endif // PLUGINS_PLUGIN_LIB_FILTERS_COLOR_QUANTIZATION_HPP
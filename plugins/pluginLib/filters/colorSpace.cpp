@@ -0,0 +1,324 @@
+#include "colorSpace.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+namespace ps
+{
+
+namespace
+{
+
+const size_t kTransferLutSize = 4096;
+
+// cube root of the Lab transfer is interpolated, its slope is steep near zero
+const size_t kLabLutSize = 4096;
+
+// smaller differences of max and min channels are gray
+const float kChromaEpsilon = 1e-6f;
+
+// Lab constants, delta = 6 / 29
+const float kLabDelta       = 6.f / 29.f;
+const float kLabDeltaCube   = kLabDelta * kLabDelta * kLabDelta;
+const float kLabLinearSlope = 1.f / (3.f * kLabDelta * kLabDelta);
+const float kLabLinearBias  = 4.f / 29.f;
+
+const float kWhiteX = 0.95047f;
+const float kWhiteY = 1.f;
+const float kWhiteZ = 1.08883f;
+
+// heap tables, they are too big for static arrays
+using TransferLut = std::vector<float>;
+
+// Helpers below are kept free of library calls and branches, so the loops that use them are vectorized
+
+float clampRange(float value, float min, float max)
+{
+    return std::min(std::max(value, min), max);
+}
+
+// x >= 0, result is in [0, period)
+float wrap(float x, float period)
+{
+    return x - static_cast<float>(static_cast<int>(x / period)) * period;
+}
+
+uint8_t toChannel(float value)
+{
+    return static_cast<uint8_t>(clampRange(value, 0.f, 1.f) * 255.f + 0.5f);
+}
+
+float srgbToLinear(float value)
+{
+    return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+float linearToSrgb(float value)
+{
+    return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.f / 2.4f) - 0.055f;
+}
+
+float labTransferExact(float t)
+{
+    return t > kLabDeltaCube ? std::cbrt(t) : t * kLabLinearSlope + kLabLinearBias;
+}
+
+// size entries over [0, 1]
+template <typename Transfer>
+TransferLut makeTransferLut(Transfer transfer, size_t size)
+{
+    TransferLut lut(size);
+
+    for (size_t i = 0; i < size; ++i)
+        lut[i] = transfer(static_cast<float>(i) / static_cast<float>(size - 1));
+
+    return lut;
+}
+
+const TransferLut& getToLinearLut()
+{
+    static const TransferLut lut = makeTransferLut(srgbToLinear, kTransferLutSize);
+    return lut;
+}
+
+const TransferLut& getToSrgbLut()
+{
+    static const TransferLut lut = makeTransferLut(linearToSrgb, kTransferLutSize);
+    return lut;
+}
+
+// one more entry, so t = 1 is interpolated without a check
+TransferLut makeLabLut()
+{
+    TransferLut lut = makeTransferLut(labTransferExact, kLabLutSize);
+    lut.push_back(lut.back());
+
+    return lut;
+}
+
+const TransferLut& getLabLut()
+{
+    static const TransferLut lut = makeLabLut();
+    return lut;
+}
+
+void applyTransferLut(std::array<float, ColorBlock::kCapacity>& channel, size_t size, const TransferLut& lut)
+{
+    const float scale = static_cast<float>(kTransferLutSize - 1);
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        float index = clampRange(channel[i], 0.f, 1.f) * scale + 0.5f;
+        channel[i] = lut[static_cast<size_t>(index)];
+    }
+}
+
+// hue in [0, 1) from the channel that is maximal, zero for grays
+float getHue(float r, float g, float b, float max, float chroma)
+{
+    float safeChroma = std::max(chroma, kChromaEpsilon);
+
+    float hueR = wrap((g - b) / safeChroma + 6.f, 6.f);
+    float hueG = (b - r) / safeChroma + 2.f;
+    float hueB = (r - g) / safeChroma + 4.f;
+
+    float hue = max <= r ? hueR : (max <= g ? hueG : hueB);
+
+    return chroma < kChromaEpsilon ? 0.f : hue / 6.f;
+}
+
+// XYZ relative to the white are in [0, 1]
+float labTransfer(float t, const TransferLut& lut)
+{
+    float position = clampRange(t, 0.f, 1.f) * static_cast<float>(kLabLutSize - 1);
+    size_t index = static_cast<size_t>(position);
+    float fraction = position - static_cast<float>(index);
+
+    return lut[index] + (lut[index + 1] - lut[index]) * fraction;
+}
+
+float labInverseTransfer(float t)
+{
+    return t > kLabDelta ? t * t * t : (t - kLabLinearBias) / kLabLinearSlope;
+}
+
+} // namespace anonymous
+
+void loadColorBlock(const Color* colors, size_t count, ColorBlock& block)
+{
+    assert(colors);
+    assert(count <= ColorBlock::kCapacity);
+
+    const float scale = 1.f / 255.f;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        block.c0[i] = static_cast<float>(colors[i].r) * scale;
+        block.c1[i] = static_cast<float>(colors[i].g) * scale;
+        block.c2[i] = static_cast<float>(colors[i].b) * scale;
+    }
+
+    block.size = count;
+}
+
+void storeColorBlock(const ColorBlock& block, Color* colors)
+{
+    assert(colors);
+
+    for (size_t i = 0; i < block.size; ++i)
+    {
+        colors[i].r = toChannel(block.c0[i]);
+        colors[i].g = toChannel(block.c1[i]);
+        colors[i].b = toChannel(block.c2[i]);
+    }
+}
+
+void convertRgbToHsv(ColorBlock& block)
+{
+    for (size_t i = 0; i < block.size; ++i)
+    {
+        float r = block.c0[i];
+        float g = block.c1[i];
+        float b = block.c2[i];
+
+        float max = std::max(r, std::max(g, b));
+        float min = std::min(r, std::min(g, b));
+        float chroma = max - min;
+
+        block.c0[i] = getHue(r, g, b, max, chroma);
+        block.c1[i] = max > kChromaEpsilon ? chroma / std::max(max, kChromaEpsilon) : 0.f;
+        block.c2[i] = max;
+    }
+}
+
+// channel(n) = v - v * s * clamp(min(k, 4 - k), 0, 1), k = (n + 6h) mod 6; r, g, b are n = 5, 3, 1
+void convertHsvToRgb(ColorBlock& block)
+{
+    for (size_t i = 0; i < block.size; ++i)
+    {
+        float h = block.c0[i] * 6.f;
+        float s = block.c1[i];
+        float v = block.c2[i];
+
+        auto channel = [h, s, v](float n)
+        {
+            float k = wrap(n + h, 6.f);
+            return v - v * s * clampRange(std::min(k, 4.f - k), 0.f, 1.f);
+        };
+
+        block.c0[i] = channel(5.f);
+        block.c1[i] = channel(3.f);
+        block.c2[i] = channel(1.f);
+    }
+}
+
+void convertRgbToHsl(ColorBlock& block)
+{
+    for (size_t i = 0; i < block.size; ++i)
+    {
+        float r = block.c0[i];
+        float g = block.c1[i];
+        float b = block.c2[i];
+
+        float max = std::max(r, std::max(g, b));
+        float min = std::min(r, std::min(g, b));
+        float chroma = max - min;
+        float lightness = (max + min) * 0.5f;
+
+        float denominator = 1.f - std::abs(2.f * lightness - 1.f);
+
+        block.c0[i] = getHue(r, g, b, max, chroma);
+        block.c1[i] = denominator > kChromaEpsilon ? chroma / std::max(denominator, kChromaEpsilon) : 0.f;
+        block.c2[i] = lightness;
+    }
+}
+
+// channel(n) = l - a * clamp(min(k - 3, 9 - k), -1, 1), k = (n + 12h) mod 12, a = s * min(l, 1 - l);
+// r, g, b are n = 0, 8, 4
+void convertHslToRgb(ColorBlock& block)
+{
+    for (size_t i = 0; i < block.size; ++i)
+    {
+        float h = block.c0[i] * 12.f;
+        float l = block.c2[i];
+        float a = block.c1[i] * std::min(l, 1.f - l);
+
+        auto channel = [h, l, a](float n)
+        {
+            float k = wrap(n + h, 12.f);
+            return l - a * clampRange(std::min(k - 3.f, 9.f - k), -1.f, 1.f);
+        };
+
+        block.c0[i] = channel(0.f);
+        block.c1[i] = channel(8.f);
+        block.c2[i] = channel(4.f);
+    }
+}
+
+void convertRgbToLinear(ColorBlock& block)
+{
+    const TransferLut& lut = getToLinearLut();
+
+    applyTransferLut(block.c0, block.size, lut);
+    applyTransferLut(block.c1, block.size, lut);
+    applyTransferLut(block.c2, block.size, lut);
+}
+
+void convertLinearToRgb(ColorBlock& block)
+{
+    const TransferLut& lut = getToSrgbLut();
+
+    applyTransferLut(block.c0, block.size, lut);
+    applyTransferLut(block.c1, block.size, lut);
+    applyTransferLut(block.c2, block.size, lut);
+}
+
+void convertRgbToLab(ColorBlock& block)
+{
+    convertRgbToLinear(block);
+
+    const TransferLut& lut = getLabLut();
+
+    for (size_t i = 0; i < block.size; ++i)
+    {
+        float r = block.c0[i];
+        float g = block.c1[i];
+        float b = block.c2[i];
+
+        float x = (0.4124564f * r + 0.3575761f * g + 0.1804375f * b) / kWhiteX;
+        float y = (0.2126729f * r + 0.7151522f * g + 0.0721750f * b) / kWhiteY;
+        float z = (0.0193339f * r + 0.1191920f * g + 0.9503041f * b) / kWhiteZ;
+
+        float fx = labTransfer(x, lut);
+        float fy = labTransfer(y, lut);
+        float fz = labTransfer(z, lut);
+
+        block.c0[i] = 116.f * fy - 16.f;
+        block.c1[i] = 500.f * (fx - fy);
+        block.c2[i] = 200.f * (fy - fz);
+    }
+}
+
+void convertLabToRgb(ColorBlock& block)
+{
+    for (size_t i = 0; i < block.size; ++i)
+    {
+        float fy = (block.c0[i] + 16.f) / 116.f;
+        float fx = fy + block.c1[i] / 500.f;
+        float fz = fy - block.c2[i] / 200.f;
+
+        float x = labInverseTransfer(fx) * kWhiteX;
+        float y = labInverseTransfer(fy) * kWhiteY;
+        float z = labInverseTransfer(fz) * kWhiteZ;
+
+        block.c0[i] =  3.2404542f * x - 1.5371385f * y - 0.4985314f * z;
+        block.c1[i] = -0.9692660f * x + 1.8760108f * y + 0.0415560f * z;
+        block.c2[i] =  0.0556434f * x - 0.2040259f * y + 1.0572252f * z;
+    }
+
+    convertLinearToRgb(block);
+}
+
+} // namespace ps
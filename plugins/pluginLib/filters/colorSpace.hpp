@@ -0,0 +1,53 @@
+#ifndef PLUGINS_PLUGIN_LIB_FILTERS_COLOR_SPACE_HPP
+#define PLUGINS_PLUGIN_LIB_FILTERS_COLOR_SPACE_HPP
+
+#include "api/api_sfm.hpp"
+
+#include <array>
+#include <cstddef>
+
+namespace ps
+{
+
+using namespace psapi::sfm;
+
+// Colors are converted in blocks stored as structure of arrays: every conversion is a branchless loop
+// over separate channel arrays, which the compiler vectorizes without gathers or shuffles.
+//
+// Channel meaning depends on the space, all of them except Lab are in [0, 1]:
+// RGB and linear RGB - r, g, b; HSV - h, s, v; HSL - h, s, l (hue 1 is 360 degrees);
+// Lab - L in [0, 100], a and b about [-128, 127].
+struct ColorBlock
+{
+    static constexpr size_t kCapacity = 64;
+
+    alignas(32) std::array<float, kCapacity> c0;
+    alignas(32) std::array<float, kCapacity> c1;
+    alignas(32) std::array<float, kCapacity> c2;
+
+    size_t size = 0;
+};
+
+// count <= kCapacity, alpha is not converted
+void loadColorBlock(const Color* colors, size_t count, ColorBlock& block);
+
+// rounds and clamps RGB, alpha of colors is left as it is
+void storeColorBlock(const ColorBlock& block, Color* colors);
+
+void convertRgbToHsv(ColorBlock& block);
+void convertHsvToRgb(ColorBlock& block);
+
+void convertRgbToHsl(ColorBlock& block);
+void convertHslToRgb(ColorBlock& block);
+
+// sRGB transfer curve through 4096-entry tables
+void convertRgbToLinear(ColorBlock& block);
+void convertLinearToRgb(ColorBlock& block);
+
+// D65 white point
+void convertRgbToLab(ColorBlock& block);
+void convertLabToRgb(ColorBlock& block);
+
+} // namespace ps
+
+#endif // PLUGINS_PLUGIN_LIB_FILTERS_COLOR_SPACE_HPP
@@ -0,0 +1,115 @@
+#include "convolution.hpp"
+
+#include "pluginLib/filters/fftConvolution.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace ps
+{
+
+namespace
+{
+
+template <size_t N>
+Kernel<N> toFixedKernel(const RuntimeKernel& kernel)
+{
+    Kernel<N> fixed;
+
+    std::copy(kernel.weights.begin(), kernel.weights.end(), fixed.weights.begin());
+    fixed.divisor = kernel.divisor;
+    fixed.bias    = kernel.bias;
+
+    return fixed;
+}
+
+template <size_t N>
+SeparableKernel<N> toFixedKernel(const RuntimeSeparableKernel& kernel)
+{
+    SeparableKernel<N> fixed;
+
+    std::copy(kernel.horizontal.begin(), kernel.horizontal.end(), fixed.horizontal.begin());
+    std::copy(kernel.vertical  .begin(), kernel.vertical  .end(), fixed.vertical  .begin());
+    fixed.divisor = kernel.divisor;
+    fixed.bias    = kernel.bias;
+
+    return fixed;
+}
+
+} // namespace anonymous
+
+namespace detail
+{
+
+Pixels2D padRows(const Pixels2D& pixels, size_t horizontalRadius)
+{
+    Pixels2D padded(pixels.size());
+
+    parallelForRows(pixels.size(), [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+        {
+            const std::vector<Color>& row = pixels[y];
+            assert(!row.empty());
+
+            std::vector<Color>& paddedRow = padded[y];
+            paddedRow.reserve(row.size() + 2 * horizontalRadius);
+
+            paddedRow.insert(paddedRow.end(), horizontalRadius, row.front());
+            paddedRow.insert(paddedRow.end(), row.begin(), row.end());
+            paddedRow.insert(paddedRow.end(), horizontalRadius, row.back());
+        }
+    });
+
+    return padded;
+}
+
+} // namespace detail
+
+Pixels2D convolve(const Pixels2D& pixels, const RuntimeKernel& kernel, AlphaMode alphaMode)
+{
+    assert(kernel.size % 2 == 1);
+    assert(kernel.weights.size() == kernel.size * kernel.size);
+
+    switch (kernel.size)
+    {
+        case 3: return convolve(pixels, toFixedKernel<3>(kernel), alphaMode);
+        case 5: return convolve(pixels, toFixedKernel<5>(kernel), alphaMode);
+        case 7: return convolve(pixels, toFixedKernel<7>(kernel), alphaMode);
+
+        default:
+            if (kernel.size >= getFftKernelThreshold())
+                return convolveFft(pixels, kernel, alphaMode);
+
+            return detail::convolve2D(pixels, kernel.weights.data(), detail::RuntimeKernelSize{kernel.size},
+                                      kernel.divisor, kernel.bias, alphaMode);
+    }
+}
+
+Pixels2D convolve(const Pixels2D& pixels, const RuntimeSeparableKernel& kernel, AlphaMode alphaMode)
+{
+    size_t horizontalSize = kernel.horizontal.size();
+    size_t verticalSize   = kernel.vertical.size();
+
+    assert(horizontalSize % 2 == 1);
+    assert(verticalSize   % 2 == 1);
+
+    if (horizontalSize == verticalSize)
+    {
+        switch (horizontalSize)
+        {
+            case 3: return convolve(pixels, toFixedKernel<3>(kernel), alphaMode);
+            case 5: return convolve(pixels, toFixedKernel<5>(kernel), alphaMode);
+            case 7: return convolve(pixels, toFixedKernel<7>(kernel), alphaMode);
+
+            default:
+                break;
+        }
+    }
+
+    return detail::convolveSeparable(pixels, kernel.horizontal.data(), detail::RuntimeKernelSize{horizontalSize},
+                                     kernel.vertical.data(), detail::RuntimeKernelSize{verticalSize},
+                                     kernel.divisor, kernel.bias, alphaMode);
+}
+
+} // namespace ps
@@ -0,0 +1,290 @@
+#ifndef PLUGINS_PLUGIN_LIB_FILTERS_CONVOLUTION_HPP
+#define PLUGINS_PLUGIN_LIB_FILTERS_CONVOLUTION_HPP
+
+#include "pluginLib/filters/filterExecutor.hpp"
+#include "pluginLib/filters/filterGraph.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace ps
+{
+
+// result = clamp((sum(weight * pixel) + bias) / divisor)
+template <size_t N>
+struct Kernel
+{
+    static_assert(N % 2 == 1, "KERNEL SIZE HAS TO BE ODD");
+
+    std::array<int, N * N> weights;
+    int divisor = 1;
+    int bias    = 0;
+};
+
+// Horizontal pass, then vertical one, divisor and bias are applied once after both
+template <size_t N>
+struct SeparableKernel
+{
+    static_assert(N % 2 == 1, "KERNEL SIZE HAS TO BE ODD");
+
+    std::array<int, N> horizontal;
+    std::array<int, N> vertical;
+    int divisor = 1;
+    int bias    = 0;
+};
+
+struct RuntimeKernel
+{
+    size_t size = 1;
+    std::vector<int> weights; // size * size, row by row
+    int divisor = 1;
+    int bias    = 0;
+};
+
+struct RuntimeSeparableKernel
+{
+    std::vector<int> horizontal;
+    std::vector<int> vertical;
+    int divisor = 1;
+    int bias    = 0;
+};
+
+enum class AlphaMode
+{
+    Keep,     // alpha of the source pixel
+    Convolve, // alpha goes through the kernel like color channels
+};
+
+constexpr Kernel<3> kSharpenKernel    = {{ 0, -1,  0,
+                                          -1,  5, -1,
+                                           0, -1,  0}, 1, 0};
+
+constexpr Kernel<3> kEmbossKernel     = {{-2, -1,  0,
+                                          -1,  1,  1,
+                                           0,  1,  2}, 1, 0};
+
+constexpr Kernel<3> kEdgeDetectKernel = {{-1, -1, -1,
+                                          -1,  8, -1,
+                                          -1, -1, -1}, 1, 0};
+
+// (negative of the pixel + its bottom right neighbor) / 2
+constexpr Kernel<3> kBasReliefKernel  = {{ 0,  0,  0,
+                                           0, -1,  0,
+                                           0,  0,  1}, 2, 255};
+
+// 3 * pixel - 2 * (3x3 box blur)
+constexpr Kernel<3> kUnsharpKernel    = {{-2, -2, -2,
+                                          -2, 25, -2,
+                                          -2, -2, -2}, 9, 0};
+
+namespace detail
+{
+
+template <size_t N>
+struct FixedKernelSize
+{
+    constexpr size_t get() const { return N; }
+};
+
+struct RuntimeKernelSize
+{
+    size_t value;
+
+    size_t get() const { return value; }
+};
+
+struct ColorSum
+{
+    int r = 0;
+    int g = 0;
+    int b = 0;
+    int a = 0;
+};
+
+// every row gets horizontalRadius copies of its edge pixels on both sides,
+// so the hot loops never check horizontal boundaries
+Pixels2D padRows(const Pixels2D& pixels, size_t horizontalRadius);
+
+// indices of the source rows for output row y, clamped to the image
+inline void getClampedRows(std::vector<size_t>& rows, size_t y, size_t radius, size_t height)
+{
+    for (size_t i = 0; i < rows.size(); ++i)
+    {
+        long long row = static_cast<long long>(y + i) - static_cast<long long>(radius);
+        rows[i] = static_cast<size_t>(std::clamp(row, 0ll, static_cast<long long>(height) - 1));
+    }
+}
+
+inline uint8_t normalizeChannel(int sum, int bias, int divisor)
+{
+    return static_cast<uint8_t>(std::clamp((sum + bias) / divisor, 0, 255));
+}
+
+inline Color normalizeColor(const ColorSum& sum, Color source, int bias, int divisor, AlphaMode alphaMode)
+{
+    Color result = source;
+
+    result.r = normalizeChannel(sum.r, bias, divisor);
+    result.g = normalizeChannel(sum.g, bias, divisor);
+    result.b = normalizeChannel(sum.b, bias, divisor);
+
+    if (alphaMode == AlphaMode::Convolve)
+        result.a = normalizeChannel(sum.a, 0, divisor);
+
+    return result;
+}
+
+template <typename Size>
+Pixels2D convolve2D(const Pixels2D& pixels, const int* weights, Size size,
+                    int divisor, int bias, AlphaMode alphaMode)
+{
+    assert(divisor != 0);
+
+    size_t height = pixels.size();
+    size_t width  = height > 0 ? pixels[0].size() : 0;
+
+    if (width == 0)
+        return pixels;
+
+    const size_t radius = size.get() / 2;
+
+    Pixels2D padded = padRows(pixels, radius);
+    Pixels2D result(height, std::vector<Color>(width));
+
+    parallelForRows(height, [&](size_t rowBegin, size_t rowEnd)
+    {
+        std::vector<size_t> rows(size.get());
+
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+        {
+            getClampedRows(rows, y, radius, height);
+
+            for (size_t x = 0; x < width; ++x)
+            {
+                ColorSum sum;
+
+                for (size_t ky = 0; ky < size.get(); ++ky)
+                {
+                    const Color* source = padded[rows[ky]].data() + x;
+                    const int* kernelRow = weights + ky * size.get();
+
+                    for (size_t kx = 0; kx < size.get(); ++kx)
+                    {
+                        sum.r += kernelRow[kx] * source[kx].r;
+                        sum.g += kernelRow[kx] * source[kx].g;
+                        sum.b += kernelRow[kx] * source[kx].b;
+                        sum.a += kernelRow[kx] * source[kx].a;
+                    }
+                }
+
+                result[y][x] = normalizeColor(sum, pixels[y][x], bias, divisor, alphaMode);
+            }
+        }
+    });
+
+    return result;
+}
+
+template <typename HorizontalSize, typename VerticalSize>
+Pixels2D convolveSeparable(const Pixels2D& pixels, const int* horizontal, HorizontalSize horizontalSize,
+                           const int* vertical, VerticalSize verticalSize,
+                           int divisor, int bias, AlphaMode alphaMode)
+{
+    assert(divisor != 0);
+
+    size_t height = pixels.size();
+    size_t width  = height > 0 ? pixels[0].size() : 0;
+
+    if (width == 0)
+        return pixels;
+
+    const size_t horizontalRadius = horizontalSize.get() / 2;
+    const size_t verticalRadius   = verticalSize.get() / 2;
+
+    Pixels2D padded = padRows(pixels, horizontalRadius);
+    std::vector<std::vector<ColorSum>> rowSums(height, std::vector<ColorSum>(width));
+
+    parallelForRows(height, [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+        {
+            for (size_t x = 0; x < width; ++x)
+            {
+                const Color* source = padded[y].data() + x;
+                ColorSum sum;
+
+                for (size_t kx = 0; kx < horizontalSize.get(); ++kx)
+                {
+                    sum.r += horizontal[kx] * source[kx].r;
+                    sum.g += horizontal[kx] * source[kx].g;
+                    sum.b += horizontal[kx] * source[kx].b;
+                    sum.a += horizontal[kx] * source[kx].a;
+                }
+
+                rowSums[y][x] = sum;
+            }
+        }
+    });
+
+    Pixels2D result(height, std::vector<Color>(width));
+
+    parallelForRows(height, [&](size_t rowBegin, size_t rowEnd)
+    {
+        std::vector<size_t> rows(verticalSize.get());
+
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+        {
+            getClampedRows(rows, y, verticalRadius, height);
+
+            for (size_t x = 0; x < width; ++x)
+            {
+                ColorSum sum;
+
+                for (size_t ky = 0; ky < verticalSize.get(); ++ky)
+                {
+                    const ColorSum& source = rowSums[rows[ky]][x];
+
+                    sum.r += vertical[ky] * source.r;
+                    sum.g += vertical[ky] * source.g;
+                    sum.b += vertical[ky] * source.b;
+                    sum.a += vertical[ky] * source.a;
+                }
+
+                result[y][x] = normalizeColor(sum, pixels[y][x], bias, divisor, alphaMode);
+            }
+        }
+    });
+
+    return result;
+}
+
+} // namespace detail
+
+// Sizes known at compile time get fully unrolled inner loops
+template <size_t N>
+Pixels2D convolve(const Pixels2D& pixels, const Kernel<N>& kernel, AlphaMode alphaMode = AlphaMode::Keep)
+{
+    return detail::convolve2D(pixels, kernel.weights.data(), detail::FixedKernelSize<N>{},
+                              kernel.divisor, kernel.bias, alphaMode);
+}
+
+template <size_t N>
+Pixels2D convolve(const Pixels2D& pixels, const SeparableKernel<N>& kernel, AlphaMode alphaMode = AlphaMode::Keep)
+{
+    return detail::convolveSeparable(pixels, kernel.horizontal.data(), detail::FixedKernelSize<N>{},
+                                     kernel.vertical.data(), detail::FixedKernelSize<N>{},
+                                     kernel.divisor, kernel.bias, alphaMode);
+}
+
+// 3x3, 5x5 and 7x7 are dispatched to the compile time versions, kernels from getFftKernelThreshold() up
+// go through FFT (fftConvolution.hpp)
+Pixels2D convolve(const Pixels2D& pixels, const RuntimeKernel& kernel, AlphaMode alphaMode = AlphaMode::Keep);
+Pixels2D convolve(const Pixels2D& pixels, const RuntimeSeparableKernel& kernel,
+                  AlphaMode alphaMode = AlphaMode::Keep);
+
+} // namespace ps
+
+#endif // PLUGINS_PLUGIN_LIB_FILTERS_CONVOLUTION_HPP
@@ -0,0 +1,321 @@
+#include "directionalBlur.hpp"
+
+#include "pluginLib/filters/filterExecutor.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+
+namespace ps
+{
+
+namespace
+{
+
+const float kPi = 3.14159265f;
+
+// fixed point of the line slopes
+const long kSlopeOne = 4096;
+
+const size_t kRadialTaps      = 8;
+const size_t kMaxRadialPasses = 4;
+
+// bilinear weights are 8 bits per axis
+const int kSampleFractionBits = 8;
+const int kSampleOne          = 1 << kSampleFractionBits;
+
+// of the tap positions walked along the rows
+const int kPositionFractionBits = 20;
+
+Pixels2D transpose(const Pixels2D& pixels)
+{
+    size_t height = pixels.size();
+    size_t width  = height > 0 ? pixels[0].size() : 0;
+
+    Pixels2D result(width, std::vector<Color>(height));
+
+    parallelForRows(width, [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t y = 0; y < height; ++y)
+        {
+            for (size_t x = rowBegin; x < rowEnd; ++x)
+                result[x][y] = pixels[y][x];
+        }
+    });
+
+    return result;
+}
+
+// Lines go one pixel right per step and slope pixels down (sign > 0) or up (sign < 0), slope <= 1.
+// Line i passes through the pixels with y = i - maxOffset + offsets[x] or y = i - offsets[x],
+// so every pixel is on exactly one line and the lines are independent.
+Pixels2D blurAlongLines(const Pixels2D& pixels, long slope, int sign, long radius)
+{
+    const size_t height = pixels.size();
+    const size_t width  = pixels[0].size();
+
+    // Bresenham offsets of the minor axis, the same for all the lines
+    std::vector<long> offsets(width);
+    for (size_t x = 0; x < width; ++x)
+        offsets[x] = (static_cast<long>(x) * slope + kSlopeOne / 2) / kSlopeOne;
+
+    const long maxOffset = offsets.back();
+    const long lastRow   = static_cast<long>(height) - 1;
+
+    Pixels2D result(height, std::vector<Color>(width));
+
+    parallelForRows(height + static_cast<size_t>(maxOffset), [&](size_t lineBegin, size_t lineEnd)
+    {
+        for (size_t line = lineBegin; line < lineEnd; ++line)
+        {
+            const long index = static_cast<long>(line);
+
+            long start = sign > 0 ? index - maxOffset : index;
+            auto getRow = [&](long x) { return static_cast<size_t>(start + sign * offsets[static_cast<size_t>(x)]); };
+
+            // the line is inside of the image where the offset keeps y in [0, lastRow]
+            long lowOffset  = sign > 0 ? -start : start - lastRow;
+            long highOffset = sign > 0 ? lastRow - start : start;
+
+            long first = std::lower_bound(offsets.begin(), offsets.end(), lowOffset)  - offsets.begin();
+            long last  = std::upper_bound(offsets.begin(), offsets.end(), highOffset) - offsets.begin();
+
+            if (first >= last)
+                continue;
+
+            std::array<int, 4> sums = {};
+            int count = 0;
+
+            auto add = [&](long x, int direction)
+            {
+                const Color& color = pixels[getRow(x)][static_cast<size_t>(x)];
+
+                sums[0] += direction * color.r;
+                sums[1] += direction * color.g;
+                sums[2] += direction * color.b;
+                sums[3] += direction * color.a;
+                count   += direction;
+            };
+
+            for (long x = first; x < std::min(first + radius, last); ++x)
+                add(x, 1);
+
+            for (long x = first; x < last; ++x)
+            {
+                if (x + radius < last)
+                    add(x + radius, 1);
+                if (x - radius - 1 >= first)
+                    add(x - radius - 1, -1);
+
+                Color& target = result[getRow(x)][static_cast<size_t>(x)];
+
+                target.r = static_cast<uint8_t>((sums[0] + count / 2) / count);
+                target.g = static_cast<uint8_t>((sums[1] + count / 2) / count);
+                target.b = static_cast<uint8_t>((sums[2] + count / 2) / count);
+                target.a = static_cast<uint8_t>((sums[3] + count / 2) / count);
+            }
+        }
+    });
+
+    return result;
+}
+
+// tap of a pass: the sample is center + matrix * (pixel - center)
+struct RadialTap
+{
+    float xx, xy;
+    float yx, yy;
+};
+
+// spread - angle in radians or part of the distance to the center
+std::array<RadialTap, kRadialTaps> makeRadialTaps(RadialBlurMode mode, float spread)
+{
+    std::array<RadialTap, kRadialTaps> taps = {};
+
+    for (size_t i = 0; i < kRadialTaps; ++i)
+    {
+        float position = static_cast<float>(i) / static_cast<float>(kRadialTaps);
+
+        if (mode == RadialBlurMode::Spin)
+        {
+            // both directions around the pixel
+            float angle = spread * (position - 0.5f * static_cast<float>(kRadialTaps - 1) / kRadialTaps);
+            float cos   = std::cos(angle);
+            float sin   = std::sin(angle);
+
+            taps[i] = RadialTap{cos, -sin, sin, cos};
+        }
+        else
+        {
+            // towards the center only
+            float scale = 1.f - spread * position;
+
+            taps[i] = RadialTap{scale, 0.f, 0.f, scale};
+        }
+    }
+
+    return taps;
+}
+
+// Bilinear sample at x, y in fixed point with kSampleFractionBits, added to the sums with weight
+// kSampleOne^2. Coordinates are clamped, so the edges are repeated.
+void addSample(const Pixels2D& pixels, long x, long y, std::array<int, 4>& sums)
+{
+    const long width  = static_cast<long>(pixels[0].size());
+    const long height = static_cast<long>(pixels.size());
+
+    x = std::clamp(x, 0l, (width  - 1) << kSampleFractionBits);
+    y = std::clamp(y, 0l, (height - 1) << kSampleFractionBits);
+
+    long left = x >> kSampleFractionBits;
+    long top  = y >> kSampleFractionBits;
+
+    int fractionX = static_cast<int>(x & (kSampleOne - 1));
+    int fractionY = static_cast<int>(y & (kSampleOne - 1));
+
+    const std::vector<Color>& upper = pixels[static_cast<size_t>(top)];
+    const std::vector<Color>& lower = pixels[static_cast<size_t>(std::min(top + 1, height - 1))];
+
+    size_t x0 = static_cast<size_t>(left);
+    size_t x1 = static_cast<size_t>(std::min(left + 1, width - 1));
+
+    const int weights[4] = {(kSampleOne - fractionX) * (kSampleOne - fractionY),
+                            fractionX * (kSampleOne - fractionY),
+                            (kSampleOne - fractionX) * fractionY,
+                            fractionX * fractionY};
+
+    const Color* corners[4] = {&upper[x0], &upper[x1], &lower[x0], &lower[x1]};
+
+    for (size_t corner = 0; corner < 4; ++corner)
+    {
+        sums[0] += weights[corner] * corners[corner]->r;
+        sums[1] += weights[corner] * corners[corner]->g;
+        sums[2] += weights[corner] * corners[corner]->b;
+        sums[3] += weights[corner] * corners[corner]->a;
+    }
+}
+
+// Samples of a tap move along a row by a constant step, so they are walked incrementally
+// in fixed point with kPositionFractionBits, precise enough for the widest rows.
+void blurRadialPass(const Pixels2D& source, Pixels2D& target, const vec2f& center,
+                    const std::array<RadialTap, kRadialTaps>& taps)
+{
+    const size_t width = source[0].size();
+    const int divisor  = static_cast<int>(kRadialTaps) * kSampleOne * kSampleOne;
+
+    const float positionOne = static_cast<float>(1l << kPositionFractionBits);
+    const int positionShift = kPositionFractionBits - kSampleFractionBits;
+
+    parallelForRows(source.size(), [&](size_t rowBegin, size_t rowEnd)
+    {
+        std::array<long, kRadialTaps> positionsX = {};
+        std::array<long, kRadialTaps> positionsY = {};
+        std::array<long, kRadialTaps> stepsX     = {};
+        std::array<long, kRadialTaps> stepsY     = {};
+
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+        {
+            float dy = static_cast<float>(y) - center.y;
+
+            for (size_t i = 0; i < kRadialTaps; ++i)
+            {
+                const RadialTap& tap = taps[i];
+
+                positionsX[i] = std::lround((center.x - tap.xx * center.x + tap.xy * dy) * positionOne);
+                positionsY[i] = std::lround((center.y - tap.yx * center.x + tap.yy * dy) * positionOne);
+                stepsX[i]     = std::lround(tap.xx * positionOne);
+                stepsY[i]     = std::lround(tap.yx * positionOne);
+            }
+
+            for (size_t x = 0; x < width; ++x)
+            {
+                std::array<int, 4> sums = {};
+
+                for (size_t i = 0; i < kRadialTaps; ++i)
+                {
+                    addSample(source, positionsX[i] >> positionShift, positionsY[i] >> positionShift, sums);
+
+                    positionsX[i] += stepsX[i];
+                    positionsY[i] += stepsY[i];
+                }
+
+                Color& color = target[y][x];
+
+                color.r = static_cast<uint8_t>((sums[0] + divisor / 2) / divisor);
+                color.g = static_cast<uint8_t>((sums[1] + divisor / 2) / divisor);
+                color.b = static_cast<uint8_t>((sums[2] + divisor / 2) / divisor);
+                color.a = static_cast<uint8_t>((sums[3] + divisor / 2) / divisor);
+            }
+        }
+    });
+}
+
+} // namespace anonymous
+
+Pixels2D getMotionBlured(const Pixels2D& pixels, float angle, float length)
+{
+    size_t height = pixels.size();
+    size_t width  = height > 0 ? pixels[0].size() : 0;
+
+    if (width == 0)
+        return pixels;
+
+    float radians = angle * kPi / 180.f;
+
+    // rows go down
+    float directionX = std::cos(radians);
+    float directionY = -std::sin(radians);
+
+    bool isSteep = std::fabs(directionY) > std::fabs(directionX);
+
+    float major = std::fabs(isSteep ? directionY : directionX);
+    float minor = std::fabs(isSteep ? directionX : directionY);
+
+    int sign = directionX * directionY >= 0 ? 1 : -1;
+
+    // a step along the major axis is 1 / major pixels long
+    long radius = std::lround(0.5f * length * major);
+    long slope  = std::lround(minor / major * kSlopeOne);
+
+    if (radius <= 0)
+        return pixels;
+
+    if (!isSteep)
+        return blurAlongLines(pixels, slope, sign, radius);
+
+    return transpose(blurAlongLines(transpose(pixels), slope, sign, radius));
+}
+
+Pixels2D getRadialBlured(const Pixels2D& pixels, RadialBlurMode mode, const vec2f& center, float amount)
+{
+    size_t height = pixels.size();
+    size_t width  = height > 0 ? pixels[0].size() : 0;
+
+    if (width == 0 || amount <= 0.f)
+        return pixels;
+
+    float spread = mode == RadialBlurMode::Spin ? amount * kPi / 180.f : std::min(amount, 1.f);
+
+    // the farthest corner moves the most
+    float farthestX = std::max(std::fabs(center.x), std::fabs(static_cast<float>(width - 1) - center.x));
+    float farthestY = std::max(std::fabs(center.y), std::fabs(static_cast<float>(height - 1) - center.y));
+    float displacement = spread * std::hypot(farthestX, farthestY);
+
+    Pixels2D source = pixels;
+    Pixels2D target = pixels;
+
+    for (size_t pass = 0; pass < kMaxRadialPasses && (pass == 0 || displacement > 1.f); ++pass)
+    {
+        blurRadialPass(source, target, center, makeRadialTaps(mode, spread));
+        std::swap(source, target);
+
+        spread       /= static_cast<float>(kRadialTaps);
+        displacement /= static_cast<float>(kRadialTaps);
+    }
+
+    return source;
+}
+
+} // namespace ps
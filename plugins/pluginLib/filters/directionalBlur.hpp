@@ -0,0 +1,29 @@
+#ifndef PLUGINS_PLUGIN_LIB_FILTERS_DIRECTIONAL_BLUR_HPP
+#define PLUGINS_PLUGIN_LIB_FILTERS_DIRECTIONAL_BLUR_HPP
+
+#include "pluginLib/filters/filterGraph.hpp"
+
+namespace ps
+{
+
+// Box blur along the direction, angle - in degrees counterclockwise from the x axis, length - in pixels.
+// The image is covered by parallel Bresenham lines and every line is blurred by a running sum,
+// so the cost doesn't depend on the length. Lines closer to vertical are blurred in the transposed image.
+// Near the borders only the samples inside of the image are averaged.
+Pixels2D getMotionBlured(const Pixels2D& pixels, float angle, float length);
+
+enum class RadialBlurMode
+{
+    Spin, // along circles around the center
+    Zoom, // along rays from the center
+};
+
+// center - in pixels, amount - angle of the arc in degrees for spin and part of the distance
+// to the center for zoom. Every pass averages a fixed number of bilinear taps, every next pass spreads them
+// over the gap between the taps of the previous one, so there are as many passes as needed to keep
+// the taps at most a pixel apart. Rows are filtered in parallel.
+Pixels2D getRadialBlured(const Pixels2D& pixels, RadialBlurMode mode, const vec2f& center, float amount);
+
+} // namespace ps
+
+#endif // PLUGINS_PLUGIN_LIB_FILTERS_DIRECTIONAL_BLUR_HPP
@@ -0,0 +1,201 @@
+#include "distanceTransform.hpp"
+
+#include "pluginLib/canvas/canvas.hpp"
+#include "pluginLib/canvas/versionedLayer.hpp"
+#include "pluginLib/filters/filterExecutor.hpp"
+
+#include <cmath>
+#include <limits>
+
+namespace ps
+{
+
+namespace
+{
+
+// columns gathered at once by the vertical pass, reads of a row stay in a few cache lines
+const size_t kColumnsBand = 16;
+
+const float kInfinity = std::numeric_limits<float>::infinity();
+
+// Squared distances along a line: result[q] = min over p of (q - p)^2 + values[p].
+// parabolas - vertices of the parabolas of the lower envelope, bounds - where they start to be the lowest.
+class LineTransform
+{
+public:
+    explicit LineTransform(size_t length) : parabolas_(length), bounds_(length + 1) {}
+
+    void apply(const float* values, size_t length, float* result)
+    {
+        size_t count = 0;
+
+        for (size_t q = 0; q < length; ++q)
+        {
+            // infinite parabolas never get to the envelope
+            if (std::isinf(values[q]))
+                continue;
+
+            float bound = -kInfinity;
+
+            while (count > 0)
+            {
+                bound = getIntersection(values, parabolas_[count - 1], q);
+
+                if (bound > bounds_[count - 1])
+                    break;
+
+                --count;
+                bound = -kInfinity;
+            }
+
+            parabolas_[count] = q;
+            bounds_[count]    = bound;
+            ++count;
+        }
+
+        if (count == 0)
+        {
+            std::fill(result, result + length, kInfinity);
+            return;
+        }
+
+        bounds_[count] = kInfinity;
+
+        size_t k = 0;
+
+        for (size_t q = 0; q < length; ++q)
+        {
+            float position = static_cast<float>(q);
+
+            while (bounds_[k + 1] < position)
+                ++k;
+
+            float offset = position - static_cast<float>(parabolas_[k]);
+            result[q] = offset * offset + values[parabolas_[k]];
+        }
+    }
+
+private:
+    // abscissa where parabola with vertex q gets lower than the one with vertex p < q
+    static float getIntersection(const float* values, size_t p, size_t q)
+    {
+        float fp = static_cast<float>(p);
+        float fq = static_cast<float>(q);
+
+        return ((values[q] + fq * fq) - (values[p] + fp * fp)) / (2.f * (fq - fp));
+    }
+
+private:
+    std::vector<size_t> parabolas_;
+    std::vector<float> bounds_;
+};
+
+} // namespace anonymous
+
+DistanceField computeDistanceField(const Pixels2D& pixels, uint8_t alphaThreshold)
+{
+    DistanceField field;
+
+    field.height = pixels.size();
+    field.width  = field.height > 0 ? pixels[0].size() : 0;
+
+    if (field.width == 0)
+        return field;
+
+    const size_t width  = field.width;
+    const size_t height = field.height;
+
+    field.distances.resize(width * height);
+
+    // squared distances to the nearest opaque pixel of the column
+    size_t bands = (width + kColumnsBand - 1) / kColumnsBand;
+
+    parallelForRows(bands, [&](size_t bandBegin, size_t bandEnd)
+    {
+        LineTransform transform(height);
+
+        std::vector<float> columns(kColumnsBand * height);
+        std::vector<float> results(kColumnsBand * height);
+
+        for (size_t band = bandBegin; band < bandEnd; ++band)
+        {
+            size_t left  = band * kColumnsBand;
+            size_t right = std::min(left + kColumnsBand, width);
+
+            for (size_t y = 0; y < height; ++y)
+                for (size_t x = left; x < right; ++x)
+                    columns[(x - left) * height + y] = pixels[y][x].a >= alphaThreshold ? 0.f : kInfinity;
+
+            for (size_t x = left; x < right; ++x)
+                transform.apply(&columns[(x - left) * height], height, &results[(x - left) * height]);
+
+            for (size_t y = 0; y < height; ++y)
+                for (size_t x = left; x < right; ++x)
+                    field.distances[y * width + x] = results[(x - left) * height + y];
+        }
+    });
+
+    parallelForRows(height, [&](size_t rowBegin, size_t rowEnd)
+    {
+        LineTransform transform(width);
+        std::vector<float> row(width);
+
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+        {
+            float* distances = field.distances.data() + y * width;
+
+            std::copy(distances, distances + width, row.begin());
+            transform.apply(row.data(), width, distances);
+
+            for (size_t x = 0; x < width; ++x)
+                distances[x] = std::sqrt(distances[x]);
+        }
+    });
+
+    return field;
+}
+
+// Layer distance field implementation
+
+std::shared_ptr<const DistanceField> LayerDistanceField::update(const ILayer* layer, const vec2u& screenSize)
+{
+    assert(layer);
+
+    vec2u fullSize = getLayerFullSize(layer, screenSize);
+    IntRect rect{vec2i{0, 0}, fullSize};
+
+    auto versionedLayer = dynamic_cast<const IVersionedLayer*>(layer);
+    if (!versionedLayer)
+    {
+        clear();
+
+        return std::make_shared<const DistanceField>(computeDistanceField(getLayerRegion(layer, rect)));
+    }
+
+    bool isValid = field_ &&
+                   layerId_      == versionedLayer->getLayerId() &&
+                   layerVersion_ == versionedLayer->getVersion() &&
+                   fullSize_.x == fullSize.x && fullSize_.y == fullSize.y;
+
+    if (isValid)
+        return field_;
+
+    layerId_      = versionedLayer->getLayerId();
+    layerVersion_ = versionedLayer->getVersion();
+    fullSize_     = fullSize;
+
+    field_ = std::make_shared<const DistanceField>(computeDistanceField(getLayerRegion(layer, rect)));
+
+    return field_;
+}
+
+void LayerDistanceField::clear()
+{
+    layerId_      = 0;
+    layerVersion_ = 0;
+    fullSize_     = vec2u{};
+
+    field_.reset();
+}
+
+} // namespace ps
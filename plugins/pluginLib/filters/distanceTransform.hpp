@@ -0,0 +1,61 @@
+#ifndef PLUGINS_PLUGIN_LIB_FILTERS_DISTANCE_TRANSFORM_HPP
+#define PLUGINS_PLUGIN_LIB_FILTERS_DISTANCE_TRANSFORM_HPP
+
+#include "api/api_canvas.hpp"
+
+#include "pluginLib/filters/filterGraph.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ps
+{
+
+using namespace psapi;
+using namespace psapi::sfm;
+
+// Euclidean distance of every pixel to the nearest opaque one, 0 for opaque pixels
+struct DistanceField
+{
+    size_t width  = 0;
+    size_t height = 0;
+
+    std::vector<float> distances; // row by row
+
+    float at(size_t x, size_t y) const
+    {
+        assert(x < width && y < height);
+        return distances[y * width + x];
+    }
+};
+
+// Pixels with alpha >= alphaThreshold are opaque. Exact transform of Felzenszwalb and Huttenlocher:
+// squared distances along the columns, then the lower envelope of parabolas along the rows, both passes
+// are linear. Bands of columns and then bands of rows are processed in parallel.
+// Without opaque pixels all the distances are infinite.
+DistanceField computeDistanceField(const Pixels2D& pixels, uint8_t alphaThreshold = 128);
+
+// Distance field of the alpha of the whole layer. It is computed again only when the layer changes,
+// so effects built on it can change their colors and sizes for free.
+// Layers without versions are computed from scratch every time.
+class LayerDistanceField
+{
+public:
+    // field stays valid after the next updates
+    std::shared_ptr<const DistanceField> update(const ILayer* layer, const vec2u& screenSize);
+
+    void clear();
+
+private:
+    uint64_t layerId_      = 0;
+    uint64_t layerVersion_ = 0;
+    vec2u fullSize_;
+
+    std::shared_ptr<const DistanceField> field_;
+};
+
+} // namespace ps
+
+#endif // PLUGINS_PLUGIN_LIB_FILTERS_DISTANCE_TRANSFORM_HPP
@@ -0,0 +1,363 @@
+#include "edgeDetection.hpp"
+
+#include "pluginLib/filters/filterExecutor.hpp"
+#include "pluginLib/filters/gaussianBlur.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+
+namespace ps
+{
+
+namespace
+{
+
+const size_t kBandRows = 64;
+
+// below it the gaussian is narrower than a pixel
+const float kMinSigma = 0.5f;
+
+enum EdgeClass : uint8_t
+{
+    kNotEdge,
+    kWeakEdge,
+    kStrongEdge,
+};
+
+// of the gradient, edge goes across it
+enum class GradientDirection : uint8_t
+{
+    Horizontal,
+    Vertical,
+    Diagonal,     // (1, 1)
+    Antidiagonal, // (1, -1)
+};
+
+struct SobelGradient
+{
+    int x;
+    int y;
+};
+
+// luminance of rows [first, last) padded by one column on both sides,
+// rows and columns outside of the image repeat the edge ones
+void loadLuminance(const Pixels2D& pixels, long first, long last, std::vector<int>& band)
+{
+    const size_t width  = pixels[0].size();
+    const size_t stride = width + 2;
+    const long height   = static_cast<long>(pixels.size());
+
+    band.resize(static_cast<size_t>(last - first) * stride);
+
+    for (long y = first; y < last; ++y)
+    {
+        const std::vector<Color>& source = pixels[static_cast<size_t>(std::clamp(y, 0l, height - 1))];
+        int* row = band.data() + static_cast<size_t>(y - first) * stride;
+
+        for (size_t x = 0; x < width; ++x)
+            row[x + 1] = getLuminance(source[x]);
+
+        row[0]         = row[1];
+        row[width + 1] = row[width];
+    }
+}
+
+// x - column of the pixel in the image, rows are padded
+SobelGradient getSobel(const int* above, const int* row, const int* below, size_t x)
+{
+    int gradientX = (above[x + 2] + 2 * row[x + 2] + below[x + 2]) - (above[x] + 2 * row[x] + below[x]);
+    int gradientY = (below[x] + 2 * below[x + 1] + below[x + 2]) - (above[x] + 2 * above[x + 1] + above[x + 2]);
+
+    return SobelGradient{gradientX, gradientY};
+}
+
+// sectors of 45 degrees around the axes and the diagonals, tan(22.5) ~ 0.4142
+GradientDirection getDirection(SobelGradient gradient)
+{
+    int absX = std::abs(gradient.x);
+    int absY = std::abs(gradient.y);
+
+    if (absY * 10000 <= absX * 4142)
+        return GradientDirection::Horizontal;
+
+    if (absX * 10000 <= absY * 4142)
+        return GradientDirection::Vertical;
+
+    return (gradient.x > 0) == (gradient.y > 0) ? GradientDirection::Diagonal : GradientDirection::Antidiagonal;
+}
+
+// Gradient of rows [top - 1, bottom + 1), thinned and classified rows [top, bottom) of classes.
+// Squared magnitudes are compared with squared thresholds, so there are no roots.
+void classifyBand(const Pixels2D& pixels, size_t top, size_t bottom, int lowThreshold, int highThreshold,
+                  std::vector<uint8_t>& classes)
+{
+    const size_t width  = pixels[0].size();
+    const size_t height = pixels.size();
+    const size_t stride = width + 2;
+    const size_t rows   = bottom - top + 2;
+
+    std::vector<int> luminance;
+    loadLuminance(pixels, static_cast<long>(top) - 2, static_cast<long>(bottom) + 2, luminance);
+
+    // gradient rows are padded by one zero column on both sides, rows outside of the image are zero
+    std::vector<int> magnitudes(rows * stride, 0);
+    std::vector<GradientDirection> directions(rows * width);
+
+    for (size_t r = 0; r < rows; ++r)
+    {
+        long y = static_cast<long>(top + r) - 1;
+        if (y < 0 || y >= static_cast<long>(height))
+            continue;
+
+        const int* above = luminance.data() + r * stride;
+
+        for (size_t x = 0; x < width; ++x)
+        {
+            SobelGradient gradient = getSobel(above, above + stride, above + 2 * stride, x);
+
+            magnitudes[r * stride + x + 1] = gradient.x * gradient.x + gradient.y * gradient.y;
+            directions[r * width + x]      = getDirection(gradient);
+        }
+    }
+
+    const int lowSquared  = lowThreshold  * lowThreshold;
+    const int highSquared = highThreshold * highThreshold;
+
+    for (size_t y = top; y < bottom; ++y)
+    {
+        size_t r = y - top + 1;
+
+        const int* above = magnitudes.data() + (r - 1) * stride + 1;
+        const int* row   = magnitudes.data() + r * stride + 1;
+        const int* below = magnitudes.data() + (r + 1) * stride + 1;
+
+        uint8_t* classesRow = classes.data() + y * width;
+
+        for (size_t x = 0; x < width; ++x)
+        {
+            int magnitude = row[x];
+
+            if (magnitude < lowSquared || magnitude == 0)
+            {
+                classesRow[x] = kNotEdge;
+                continue;
+            }
+
+            // ties are kept on one side only, so the edge stays one pixel wide
+            int before = 0;
+            int after  = 0;
+
+            switch (directions[r * width + x])
+            {
+                case GradientDirection::Horizontal:   before = row[x - 1];   after = row[x + 1];   break;
+                case GradientDirection::Vertical:     before = above[x];     after = below[x];     break;
+                case GradientDirection::Diagonal:     before = above[x - 1]; after = below[x + 1]; break;
+                case GradientDirection::Antidiagonal: before = below[x - 1]; after = above[x + 1]; break;
+
+                default:
+                    assert(false);
+            }
+
+            if (magnitude < before || magnitude <= after)
+                classesRow[x] = kNotEdge;
+            else
+                classesRow[x] = magnitude >= highSquared ? kStrongEdge : kWeakEdge;
+        }
+    }
+}
+
+// Links always go to the smaller index, so the root is the first pixel of the component
+// and the links can be flattened in one pass in the index order
+class EdgeComponents
+{
+public:
+    explicit EdgeComponents(size_t count) : parents_(count)
+    {
+        for (size_t i = 0; i < count; ++i)
+            parents_[i] = static_cast<uint32_t>(i);
+    }
+
+    uint32_t find(uint32_t index)
+    {
+        while (parents_[index] != index)
+        {
+            parents_[index] = parents_[parents_[index]];
+            index = parents_[index];
+        }
+
+        return index;
+    }
+
+    void unite(uint32_t lhs, uint32_t rhs)
+    {
+        lhs = find(lhs);
+        rhs = find(rhs);
+
+        if (lhs < rhs)
+            parents_[rhs] = lhs;
+        else if (rhs < lhs)
+            parents_[lhs] = rhs;
+    }
+
+    void flatten()
+    {
+        for (size_t i = 0; i < parents_.size(); ++i)
+            parents_[i] = parents_[parents_[i]];
+    }
+
+    // after flatten
+    uint32_t getRoot(size_t index) const { return parents_[index]; }
+
+private:
+    std::vector<uint32_t> parents_;
+};
+
+// candidate at (x, y) joins the candidates among its upper 8-neighbors
+void uniteWithAbove(EdgeComponents& components, const std::vector<uint8_t>& classes, size_t width,
+                    size_t x, size_t y)
+{
+    size_t index = y * width + x;
+    size_t first = x > 0 ? x - 1 : 0;
+    size_t last  = std::min(x + 1, width - 1);
+
+    for (size_t neighbor = first; neighbor <= last; ++neighbor)
+    {
+        size_t neighborIndex = (y - 1) * width + neighbor;
+
+        if (classes[neighborIndex] != kNotEdge)
+            components.unite(static_cast<uint32_t>(index), static_cast<uint32_t>(neighborIndex));
+    }
+}
+
+} // namespace anonymous
+
+Pixels2D getSobelMagnitude(const Pixels2D& pixels)
+{
+    size_t height = pixels.size();
+    size_t width  = height > 0 ? pixels[0].size() : 0;
+
+    if (width == 0)
+        return pixels;
+
+    Pixels2D result = pixels;
+
+    parallelForRows(height, [&](size_t rowBegin, size_t rowEnd)
+    {
+        const size_t stride = width + 2;
+
+        std::vector<int> luminance;
+        loadLuminance(pixels, static_cast<long>(rowBegin) - 1, static_cast<long>(rowEnd) + 1, luminance);
+
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+        {
+            const int* above = luminance.data() + (y - rowBegin) * stride;
+
+            for (size_t x = 0; x < width; ++x)
+            {
+                SobelGradient gradient = getSobel(above, above + stride, above + 2 * stride, x);
+
+                double magnitude = std::sqrt(static_cast<double>(gradient.x * gradient.x + gradient.y * gradient.y));
+                uint8_t value = static_cast<uint8_t>(std::min(std::lround(magnitude), 255l));
+
+                result[y][x] = Color{value, value, value, pixels[y][x].a};
+            }
+        }
+    });
+
+    return result;
+}
+
+Pixels2D getCannyEdges(const Pixels2D& pixels, float sigma, int lowThreshold, int highThreshold)
+{
+    size_t height = pixels.size();
+    size_t width  = height > 0 ? pixels[0].size() : 0;
+
+    if (width == 0)
+        return pixels;
+
+    assert(width * height <= UINT32_MAX);
+
+    highThreshold = std::max(highThreshold, lowThreshold);
+
+    Pixels2D smoothed;
+    if (sigma >= kMinSigma)
+        smoothed = getGaussianBlured(pixels, sigma);
+
+    const Pixels2D& source = sigma >= kMinSigma ? smoothed : pixels;
+
+    std::vector<uint8_t> classes(width * height);
+    EdgeComponents components(width * height);
+
+    size_t bands = (height + kBandRows - 1) / kBandRows;
+
+    // unions inside of a band touch only its own pixels
+    parallelForRows(bands, [&](size_t bandBegin, size_t bandEnd)
+    {
+        for (size_t band = bandBegin; band < bandEnd; ++band)
+        {
+            size_t top    = band * kBandRows;
+            size_t bottom = std::min(top + kBandRows, height);
+
+            classifyBand(source, top, bottom, lowThreshold, highThreshold, classes);
+
+            for (size_t y = top; y < bottom; ++y)
+            {
+                for (size_t x = 0; x < width; ++x)
+                {
+                    if (classes[y * width + x] == kNotEdge)
+                        continue;
+
+                    if (x > 0 && classes[y * width + x - 1] != kNotEdge)
+                        components.unite(static_cast<uint32_t>(y * width + x), static_cast<uint32_t>(y * width + x - 1));
+
+                    if (y > top)
+                        uniteWithAbove(components, classes, width, x, y);
+                }
+            }
+        }
+    });
+
+    for (size_t band = 1; band < bands; ++band)
+    {
+        size_t y = band * kBandRows;
+
+        for (size_t x = 0; x < width; ++x)
+        {
+            if (classes[y * width + x] != kNotEdge)
+                uniteWithAbove(components, classes, width, x, y);
+        }
+    }
+
+    components.flatten();
+
+    std::vector<uint8_t> hasStrong(width * height, 0);
+
+    for (size_t i = 0; i < classes.size(); ++i)
+    {
+        if (classes[i] == kStrongEdge)
+            hasStrong[components.getRoot(i)] = 1;
+    }
+
+    Pixels2D result(height, std::vector<Color>(width));
+
+    parallelForRows(height, [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+        {
+            for (size_t x = 0; x < width; ++x)
+            {
+                size_t index = y * width + x;
+                bool isEdge = classes[index] != kNotEdge && hasStrong[components.getRoot(index)];
+
+                uint8_t value = isEdge ? 255 : 0;
+                result[y][x] = Color{value, value, value, pixels[y][x].a};
+            }
+        }
+    });
+
+    return result;
+}
+
+} // namespace ps
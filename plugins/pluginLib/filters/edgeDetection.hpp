@@ -0,0 +1,22 @@
+#ifndef PLUGINS_PLUGIN_LIB_FILTERS_EDGE_DETECTION_HPP
+#define PLUGINS_PLUGIN_LIB_FILTERS_EDGE_DETECTION_HPP
+
+#include "pluginLib/filters/filterGraph.hpp"
+
+namespace ps
+{
+
+// gray Sobel gradient magnitude of the luminance, saturated at 255, alpha is kept
+Pixels2D getSobelMagnitude(const Pixels2D& pixels);
+
+// White one pixel wide edges on black, alpha is kept. sigma - gaussian smoothing before the gradient,
+// below 0.5 there is none. Pixels with gradient magnitude above highThreshold are edges, the ones
+// above lowThreshold are edges only if they are connected to the former.
+// Gradient, non-maximum suppression and thresholding are fused in one pass over bands of rows,
+// only the hysteresis is global: connected components are found by union-find, bands in parallel
+// and then merged along the band borders.
+Pixels2D getCannyEdges(const Pixels2D& pixels, float sigma, int lowThreshold, int highThreshold);
+
+} // namespace ps
+
+#endif // PLUGINS_PLUGIN_LIB_FILTERS_EDGE_DETECTION_HPP
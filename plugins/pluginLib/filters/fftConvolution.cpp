@@ -0,0 +1,374 @@
+#include "fftConvolution.hpp"
+
+#include "pluginLib/filters/filterExecutor.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <functional>
+
+namespace ps
+{
+
+namespace
+{
+
+using Complex = std::complex<float>;
+
+const double kPi = 3.14159265358979323846;
+
+const size_t kMinFftSize = 64;
+
+// micro-benchmark: image side and the kernel sizes tried, bigger kernels than the last one always go to FFT
+const size_t kBenchmarkSide = 128;
+const size_t kBenchmarkSizes[] = {7, 11, 15, 21, 27, 35, 45};
+
+size_t getNextPowerOfTwo(size_t value)
+{
+    size_t power = 1;
+
+    while (power < value)
+        power *= 2;
+
+    return power;
+}
+
+// N x N complex values, row by row
+class Spectrum2D
+{
+public:
+    explicit Spectrum2D(size_t size) : size_(size), values_(size * size) {}
+
+    Complex* getRow(size_t y) { return values_.data() + y * size_; }
+    const Complex* getRow(size_t y) const { return values_.data() + y * size_; }
+
+    Complex& at(size_t x, size_t y) { return values_[y * size_ + x]; }
+
+    void clear() { std::fill(values_.begin(), values_.end(), Complex{}); }
+
+    // rows [0, filledRows) may be non zero, the others are skipped by the row pass
+    void forward(const Fft& fft, size_t filledRows, std::vector<Complex>& column)
+    {
+        for (size_t y = 0; y < filledRows; ++y)
+            fft.forward(getRow(y));
+
+        transformColumns(fft, column, false);
+    }
+
+    // only rows [rowBegin, rowEnd) are completed by the row pass
+    void inverse(const Fft& fft, size_t rowBegin, size_t rowEnd, std::vector<Complex>& column)
+    {
+        transformColumns(fft, column, true);
+
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+            fft.inverse(getRow(y));
+    }
+
+    void multiply(const Spectrum2D& other)
+    {
+        assert(other.size_ == size_);
+
+        for (size_t i = 0; i < values_.size(); ++i)
+            values_[i] *= other.values_[i];
+    }
+
+    void scale(float factor)
+    {
+        for (Complex& value : values_)
+            value *= factor;
+    }
+
+private:
+    void transformColumns(const Fft& fft, std::vector<Complex>& column, bool isInverse)
+    {
+        column.resize(size_);
+
+        for (size_t x = 0; x < size_; ++x)
+        {
+            for (size_t y = 0; y < size_; ++y)
+                column[y] = values_[y * size_ + x];
+
+            if (isInverse)
+                fft.inverse(column.data());
+            else
+                fft.forward(column.data());
+
+            for (size_t y = 0; y < size_; ++y)
+                values_[y * size_ + x] = column[y];
+        }
+    }
+
+private:
+    size_t size_;
+    std::vector<Complex> values_;
+};
+
+// Weights and pixels are integers, so the exact sum is the nearest integer while the FFT error stays
+// below one half. Then it is truncated by the integer division as the direct path does.
+uint8_t toChannel(float value, int bias, int divisor)
+{
+    return detail::normalizeChannel(static_cast<int>(std::lround(value)), bias, divisor);
+}
+
+// direct convolution computes correlation, so the kernel is flipped: weight (kx, ky) goes to (r - kx, r - ky)
+Spectrum2D createKernelSpectrum(const RuntimeKernel& kernel, const Fft& fft)
+{
+    size_t size   = fft.getSize();
+    size_t radius = kernel.size / 2;
+
+    Spectrum2D spectrum(size);
+
+    for (size_t ky = 0; ky < kernel.size; ++ky)
+    {
+        for (size_t kx = 0; kx < kernel.size; ++kx)
+        {
+            size_t x = (radius + size - kx) % size;
+            size_t y = (radius + size - ky) % size;
+
+            spectrum.at(x, y) = Complex{static_cast<float>(kernel.weights[ky * kernel.size + kx]), 0.f};
+        }
+    }
+
+    std::vector<Complex> column;
+    spectrum.forward(fft, size, column);
+
+    // normalization of the inverse transform is folded into the kernel
+    spectrum.scale(1.f / static_cast<float>(size * size));
+
+    return spectrum;
+}
+
+long long measureInUs(const std::function<void()>& func)
+{
+    auto start = std::chrono::steady_clock::now();
+    func();
+    auto finish = std::chrono::steady_clock::now();
+
+    return std::chrono::duration_cast<std::chrono::microseconds>(finish - start).count();
+}
+
+size_t measureFftKernelThreshold()
+{
+    Pixels2D pixels(kBenchmarkSide, std::vector<Color>(kBenchmarkSide));
+
+    for (size_t y = 0; y < kBenchmarkSide; ++y)
+    {
+        for (size_t x = 0; x < kBenchmarkSide; ++x)
+        {
+            auto value = static_cast<uint8_t>((x * 7 + y * 13) % 256);
+            pixels[y][x] = Color{value, value, value, 255};
+        }
+    }
+
+    for (size_t size : kBenchmarkSizes)
+    {
+        RuntimeKernel kernel;
+        kernel.size = size;
+        kernel.weights.assign(size * size, 1);
+        kernel.divisor = static_cast<int>(size * size);
+
+        long long direct = measureInUs([&]()
+        {
+            detail::convolve2D(pixels, kernel.weights.data(), detail::RuntimeKernelSize{size},
+                               kernel.divisor, kernel.bias, AlphaMode::Keep);
+        });
+
+        long long fft = measureInUs([&]() { convolveFft(pixels, kernel); });
+
+        if (fft < direct)
+            return size;
+    }
+
+    return std::end(kBenchmarkSizes)[-1] + 2;
+}
+
+} // namespace anonymous
+
+// Fft implementation
+
+Fft::Fft(size_t size) : size_(size)
+{
+    assert(size > 0 && (size & (size - 1)) == 0);
+
+    twiddles_.resize(size / 2);
+    for (size_t k = 0; k < size / 2; ++k)
+    {
+        double angle = -2.0 * kPi * static_cast<double>(k) / static_cast<double>(size);
+        twiddles_[k] = Complex{static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle))};
+    }
+
+    size_t bits = 0;
+    while ((size_t{1} << bits) < size)
+        ++bits;
+
+    bitReversed_.resize(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+        size_t reversed = 0;
+
+        for (size_t bit = 0; bit < bits; ++bit)
+            reversed |= ((i >> bit) & 1) << (bits - 1 - bit);
+
+        bitReversed_[i] = reversed;
+    }
+}
+
+void Fft::forward(Complex* values) const
+{
+    transform(values, false);
+}
+
+void Fft::inverse(Complex* values) const
+{
+    transform(values, true);
+}
+
+void Fft::transform(Complex* values, bool isInverse) const
+{
+    for (size_t i = 0; i < size_; ++i)
+    {
+        if (i < bitReversed_[i])
+            std::swap(values[i], values[bitReversed_[i]]);
+    }
+
+    for (size_t length = 2; length <= size_; length *= 2)
+    {
+        size_t half = length / 2;
+        size_t twiddleStep = size_ / length;
+
+        for (size_t begin = 0; begin < size_; begin += length)
+        {
+            for (size_t k = 0; k < half; ++k)
+            {
+                Complex twiddle = twiddles_[k * twiddleStep];
+                if (isInverse)
+                    twiddle = std::conj(twiddle);
+
+                Complex even = values[begin + k];
+                Complex odd  = values[begin + k + half] * twiddle;
+
+                values[begin + k]        = even + odd;
+                values[begin + k + half] = even - odd;
+            }
+        }
+    }
+}
+
+// Convolution
+
+Pixels2D convolveFft(const Pixels2D& pixels, const RuntimeKernel& kernel, AlphaMode alphaMode)
+{
+    assert(kernel.size % 2 == 1);
+    assert(kernel.weights.size() == kernel.size * kernel.size);
+    assert(kernel.divisor != 0);
+
+    size_t height = pixels.size();
+    size_t width  = height > 0 ? pixels[0].size() : 0;
+
+    if (width == 0)
+        return pixels;
+
+    const size_t radius   = kernel.size / 2;
+    const size_t fftSize  = std::max(kMinFftSize, getNextPowerOfTwo(4 * radius));
+    const size_t tileSize = fftSize - 2 * radius; // output pixels of a tile along each side
+
+    Fft fft(fftSize);
+    const Spectrum2D kernelSpectrum = createKernelSpectrum(kernel, fft);
+
+    const size_t tileRows    = (height + tileSize - 1) / tileSize;
+    const size_t tileColumns = (width  + tileSize - 1) / tileSize;
+
+    Pixels2D result(height, std::vector<Color>(width));
+
+    // index of the source pixel offset pixels after the start of the tile read region
+    auto clampIndex = [radius](size_t begin, size_t offset, size_t size)
+    {
+        long long index = static_cast<long long>(begin + offset) - static_cast<long long>(radius);
+        return static_cast<size_t>(std::clamp(index, 0ll, static_cast<long long>(size) - 1));
+    };
+
+    parallelForRows(tileRows, [&](size_t tileRowBegin, size_t tileRowEnd)
+    {
+        // red and green in one signal, blue and alpha in another
+        Spectrum2D redGreen(fftSize);
+        Spectrum2D blueAlpha(fftSize);
+        std::vector<Complex> column;
+
+        const size_t readSize = tileSize + 2 * radius;
+
+        for (size_t tileRow = tileRowBegin; tileRow < tileRowEnd; ++tileRow)
+        {
+            size_t top = tileRow * tileSize;
+
+            for (size_t tileColumn = 0; tileColumn < tileColumns; ++tileColumn)
+            {
+                size_t left = tileColumn * tileSize;
+
+                redGreen.clear();
+                blueAlpha.clear();
+
+                for (size_t y = 0; y < readSize; ++y)
+                {
+                    const std::vector<Color>& row = pixels[clampIndex(top, y, height)];
+
+                    Complex* redGreenRow  = redGreen .getRow(y);
+                    Complex* blueAlphaRow = blueAlpha.getRow(y);
+
+                    for (size_t x = 0; x < readSize; ++x)
+                    {
+                        const Color& pixel = row[clampIndex(left, x, width)];
+
+                        redGreenRow [x] = Complex{static_cast<float>(pixel.r), static_cast<float>(pixel.g)};
+                        blueAlphaRow[x] = Complex{static_cast<float>(pixel.b), static_cast<float>(pixel.a)};
+                    }
+                }
+
+                redGreen .forward(fft, readSize, column);
+                blueAlpha.forward(fft, readSize, column);
+
+                redGreen .multiply(kernelSpectrum);
+                blueAlpha.multiply(kernelSpectrum);
+
+                size_t rowsCount    = std::min(tileSize, height - top);
+                size_t columnsCount = std::min(tileSize, width  - left);
+
+                redGreen .inverse(fft, radius, radius + rowsCount, column);
+                blueAlpha.inverse(fft, radius, radius + rowsCount, column);
+
+                for (size_t y = 0; y < rowsCount; ++y)
+                {
+                    const Complex* redGreenRow  = redGreen .getRow(radius + y) + radius;
+                    const Complex* blueAlphaRow = blueAlpha.getRow(radius + y) + radius;
+
+                    const std::vector<Color>& sourceRow = pixels[top + y];
+                    std::vector<Color>& resultRow = result[top + y];
+
+                    for (size_t x = 0; x < columnsCount; ++x)
+                    {
+                        Color color = sourceRow[left + x];
+
+                        color.r = toChannel(redGreenRow [x].real(), kernel.bias, kernel.divisor);
+                        color.g = toChannel(redGreenRow [x].imag(), kernel.bias, kernel.divisor);
+                        color.b = toChannel(blueAlphaRow[x].real(), kernel.bias, kernel.divisor);
+
+                        if (alphaMode == AlphaMode::Convolve)
+                            color.a = toChannel(blueAlphaRow[x].imag(), 0, kernel.divisor);
+
+                        resultRow[left + x] = color;
+                    }
+                }
+            }
+        }
+    });
+
+    return result;
+}
+
+size_t getFftKernelThreshold()
+{
+    static const size_t threshold = measureFftKernelThreshold();
+    return threshold;
+}
+
+} // namespace ps
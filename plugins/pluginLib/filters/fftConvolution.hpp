@@ -0,0 +1,46 @@
+#ifndef PLUGINS_PLUGIN_LIB_FILTERS_FFT_CONVOLUTION_HPP
+#define PLUGINS_PLUGIN_LIB_FILTERS_FFT_CONVOLUTION_HPP
+
+#include "pluginLib/filters/convolution.hpp"
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+namespace ps
+{
+
+// In-place radix-2 complex FFT of size() == 2^k values, inverse one is not normalized
+class Fft
+{
+public:
+    explicit Fft(size_t size);
+
+    size_t getSize() const { return size_; }
+
+    void forward(std::complex<float>* values) const;
+    void inverse(std::complex<float>* values) const;
+
+private:
+    void transform(std::complex<float>* values, bool isInverse) const;
+
+private:
+    size_t size_;
+    std::vector<std::complex<float>> twiddles_; // exp(-2 pi i k / size), k < size / 2
+    std::vector<size_t> bitReversed_;
+};
+
+// Same result as the direct convolve: sums are rounded to the exact integers before the integer division.
+// Edges are clamped. Cost per pixel grows with the log of the kernel size, not with its area.
+//
+// Image is cut into independent tiles, each is read with the kernel radius around it and transformed
+// with a power of two FFT (overlap-save), so memory is bounded by the tile, tiles run in parallel.
+// Two channels are packed into one complex signal, real kernel keeps them apart.
+Pixels2D convolveFft(const Pixels2D& pixels, const RuntimeKernel& kernel, AlphaMode alphaMode = AlphaMode::Keep);
+
+// Smallest kernel size the FFT path beats the direct one with on this machine. Measured once, on the first call.
+size_t getFftKernelThreshold();
+
+} // namespace ps
+
+#endif // PLUGINS_PLUGIN_LIB_FILTERS_FFT_CONVOLUTION_HPP
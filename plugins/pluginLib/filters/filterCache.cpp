@@ -0,0 +1,184 @@
+#include "filterCache.hpp"
+
+#include "pluginLib/canvas/versionedLayer.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <functional>
+
+namespace ps
+{
+
+namespace
+{
+
+const size_t kDefaultCacheCapacity = 256 * 1024 * 1024;
+
+void hashCombine(size_t& seed, size_t value)
+{
+    seed ^= value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+}
+
+size_t getPixelsBytes(const Pixels2D& pixels)
+{
+    size_t bytes = sizeof(Pixels2D);
+
+    for (const auto& row : pixels)
+        bytes += sizeof(row) + row.size() * sizeof(Color);
+
+    return bytes;
+}
+
+} // namespace anonymous
+
+// Filter cache key implementation
+
+bool FilterCacheKey::operator==(const FilterCacheKey& other) const
+{
+    return layerId        == other.layerId        &&
+           layerVersion   == other.layerVersion   &&
+           roiPos.x       == other.roiPos.x       && roiPos.y  == other.roiPos.y  &&
+           roiSize.x      == other.roiSize.x      && roiSize.y == other.roiSize.y &&
+           downscale      == other.downscale      &&
+           parametersHash == other.parametersHash &&
+           filterId       == other.filterId       &&
+           parameters     == other.parameters;
+}
+
+size_t FilterCacheKeyHash::operator()(const FilterCacheKey& key) const
+{
+    size_t seed = std::hash<uint64_t>{}(key.layerId);
+
+    hashCombine(seed, std::hash<uint64_t>{}(key.layerVersion));
+    hashCombine(seed, std::hash<int>{}(key.roiPos.x));
+    hashCombine(seed, std::hash<int>{}(key.roiPos.y));
+    hashCombine(seed, std::hash<unsigned>{}(key.roiSize.x));
+    hashCombine(seed, std::hash<unsigned>{}(key.roiSize.y));
+    hashCombine(seed, std::hash<unsigned>{}(key.downscale));
+    hashCombine(seed, std::hash<std::string>{}(key.filterId));
+    hashCombine(seed, key.parametersHash);
+
+    return seed;
+}
+
+bool makeFilterCacheKey(FilterCacheKey& key, const ILayer* layer, const vec2u& roiSize)
+{
+    auto versionedLayer = dynamic_cast<const IVersionedLayer*>(layer);
+    if (!versionedLayer)
+        return false;
+
+    key.layerId      = versionedLayer->getLayerId();
+    key.layerVersion = versionedLayer->getVersion();
+    key.roiPos       = versionedLayer->getVisiblePos();
+    key.roiSize      = roiSize;
+
+    return true;
+}
+
+size_t hashParameters(const std::vector<float>& parameters)
+{
+    size_t seed = parameters.size();
+
+    for (float parameter : parameters)
+    {
+        uint32_t bits = 0;
+        std::memcpy(&bits, &parameter, sizeof(bits));
+
+        hashCombine(seed, std::hash<uint32_t>{}(bits));
+    }
+
+    return seed;
+}
+
+// Filter cache implementation
+
+FilterCache::FilterCache(size_t capacityInBytes) : capacityInBytes_(capacityInBytes)
+{
+}
+
+std::shared_ptr<const Pixels2D> FilterCache::find(const FilterCacheKey& key)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto found = index_.find(key);
+    if (found == index_.end())
+    {
+        ++stats_.misses;
+        return nullptr;
+    }
+
+    ++stats_.hits;
+    entries_.splice(entries_.begin(), entries_, found->second);
+
+    return found->second->pixels;
+}
+
+void FilterCache::insert(const FilterCacheKey& key, std::shared_ptr<const Pixels2D> pixels)
+{
+    assert(pixels);
+
+    size_t bytes = getPixelsBytes(*pixels);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (bytes > capacityInBytes_)
+        return;
+
+    auto found = index_.find(key);
+    if (found != index_.end())
+    {
+        stats_.bytes -= found->second->bytes;
+        entries_.erase(found->second);
+        index_.erase(found);
+    }
+
+    evict(bytes);
+
+    entries_.push_front(Entry{key, std::move(pixels), bytes});
+    index_[key] = entries_.begin();
+
+    stats_.bytes += bytes;
+    stats_.entries = entries_.size();
+}
+
+void FilterCache::evict(size_t neededBytes)
+{
+    while (!entries_.empty() && stats_.bytes + neededBytes > capacityInBytes_)
+    {
+        Entry& last = entries_.back();
+
+        stats_.bytes -= last.bytes;
+        ++stats_.evictions;
+
+        index_.erase(last.key);
+        entries_.pop_back();
+    }
+
+    stats_.entries = entries_.size();
+}
+
+void FilterCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    entries_.clear();
+    index_.clear();
+
+    stats_.bytes   = 0;
+    stats_.entries = 0;
+}
+
+FilterCache::Stats FilterCache::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    return stats_;
+}
+
+FilterCache& getFilterCache()
+{
+    static FilterCache cache(kDefaultCacheCapacity);
+    return cache;
+}
+
+} // namespace ps
@@ -0,0 +1,98 @@
+#ifndef PLUGINS_PLUGIN_LIB_FILTERS_FILTER_CACHE_HPP
+#define PLUGINS_PLUGIN_LIB_FILTERS_FILTER_CACHE_HPP
+
+#include "api/api_canvas.hpp"
+
+#include "pluginLib/filters/filterGraph.hpp"
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ps
+{
+
+using namespace psapi;
+using namespace psapi::sfm;
+
+struct FilterCacheKey
+{
+    uint64_t layerId      = 0;
+    uint64_t layerVersion = 0;
+
+    // region of the full layer that was filtered, downscale - proxy factor of the result
+    vec2i roiPos;
+    vec2u roiSize;
+    unsigned downscale = 1;
+
+    std::string filterId;
+    std::vector<float> parameters;
+    size_t parametersHash = 0;
+
+    bool operator==(const FilterCacheKey& other) const;
+};
+
+struct FilterCacheKeyHash
+{
+    size_t operator()(const FilterCacheKey& key) const;
+};
+
+// false if layer doesn't support versions, its results can't be cached
+bool makeFilterCacheKey(FilterCacheKey& key, const ILayer* layer, const vec2u& roiSize);
+
+size_t hashParameters(const std::vector<float>& parameters);
+
+// LRU cache of filter results bounded by the total size of the stored pixels
+class FilterCache
+{
+public:
+    struct Stats
+    {
+        size_t hits      = 0;
+        size_t misses    = 0;
+        size_t evictions = 0;
+
+        size_t entries = 0;
+        size_t bytes   = 0;
+    };
+
+    explicit FilterCache(size_t capacityInBytes);
+
+    std::shared_ptr<const Pixels2D> find(const FilterCacheKey& key);
+    void insert(const FilterCacheKey& key, std::shared_ptr<const Pixels2D> pixels);
+
+    void clear();
+
+    Stats getStats() const;
+
+private:
+    struct Entry
+    {
+        FilterCacheKey key;
+        std::shared_ptr<const Pixels2D> pixels;
+        size_t bytes;
+    };
+
+    using EntriesList = std::list<Entry>;
+
+    void evict(size_t neededBytes);
+
+private:
+    size_t capacityInBytes_;
+
+    EntriesList entries_; // most recently used first
+    std::unordered_map<FilterCacheKey, EntriesList::iterator, FilterCacheKeyHash> index_;
+
+    Stats stats_;
+    mutable std::mutex mutex_;
+};
+
+FilterCache& getFilterCache();
+
+} // namespace ps
+
+#endif // PLUGINS_PLUGIN_LIB_FILTERS_FILTER_CACHE_HPP
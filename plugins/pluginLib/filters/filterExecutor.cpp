@@ -0,0 +1,198 @@
+#include "filterExecutor.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <memory>
+
+namespace ps
+{
+
+namespace
+{
+
+thread_local JobToken* currentJobToken = nullptr;
+
+struct ParallelForState
+{
+    const FilterExecutor::RowsFunc* func = nullptr;
+    JobToken* token = nullptr;
+
+    size_t rowsCount  = 0;
+    size_t bandHeight = 0;
+    size_t bandsCount = 0;
+
+    std::atomic<size_t> nextBand{0};
+    std::atomic<size_t> finishedBands{0};
+
+    std::mutex mutex;
+    std::condition_variable allFinished;
+};
+
+// every claimed band is counted as finished, even if it is skipped because of cancellation
+void runBands(ParallelForState& state)
+{
+    while (true)
+    {
+        size_t band = state.nextBand.fetch_add(1);
+        if (band >= state.bandsCount)
+            return;
+
+        if (!state.token || !state.token->isCancelled())
+        {
+            size_t rowBegin = band * state.bandHeight;
+            size_t rowEnd   = std::min(rowBegin + state.bandHeight, state.rowsCount);
+
+            (*state.func)(rowBegin, rowEnd);
+        }
+
+        size_t finished = state.finishedBands.fetch_add(1) + 1;
+
+        if (state.token)
+            state.token->setProgress(static_cast<float>(finished) / static_cast<float>(state.bandsCount));
+
+        if (finished == state.bandsCount)
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.allFinished.notify_all();
+        }
+    }
+}
+
+} // namespace anonymous
+
+// Job token implementation
+
+void JobToken::cancel()
+{
+    cancelled_.store(true);
+}
+
+bool JobToken::isCancelled() const
+{
+    return cancelled_.load();
+}
+
+void JobToken::setProgress(float progress)
+{
+    progress_.store(progress);
+}
+
+float JobToken::getProgress() const
+{
+    return progress_.load();
+}
+
+JobToken* getCurrentJobToken()
+{
+    return currentJobToken;
+}
+
+void setCurrentJobToken(JobToken* token)
+{
+    currentJobToken = token;
+}
+
+// Filter executor implementation
+
+FilterExecutor& FilterExecutor::getInstance()
+{
+    static FilterExecutor executor;
+    return executor;
+}
+
+FilterExecutor::FilterExecutor()
+{
+    size_t hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    // calling thread works too
+    for (size_t i = 1; i < hardwareThreads; ++i)
+        workers_.emplace_back(&FilterExecutor::workerLoop, this);
+}
+
+FilterExecutor::~FilterExecutor()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+
+    hasTasks_.notify_all();
+
+    for (auto& worker : workers_)
+        worker.join();
+}
+
+size_t FilterExecutor::getThreadsCount() const
+{
+    return workers_.size() + 1;
+}
+
+void FilterExecutor::workerLoop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            hasTasks_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+
+            if (stopping_ && tasks_.empty())
+                return;
+
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+
+        task();
+    }
+}
+
+bool FilterExecutor::parallelForRows(size_t rowsCount, const RowsFunc& func, size_t bandHeight)
+{
+    assert(bandHeight > 0);
+
+    JobToken* token = getCurrentJobToken();
+
+    if (token && token->isCancelled())
+        return false;
+
+    if (rowsCount == 0)
+        return true;
+
+    auto state = std::make_shared<ParallelForState>();
+    state->func       = &func;
+    state->token      = token;
+    state->rowsCount  = rowsCount;
+    state->bandHeight = bandHeight;
+    state->bandsCount = (rowsCount + bandHeight - 1) / bandHeight;
+
+    size_t helpersCount = std::min(workers_.size(), state->bandsCount - 1);
+
+    if (helpersCount > 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            // helpers that start late find no bands left and only hold the state alive
+            for (size_t i = 0; i < helpersCount; ++i)
+                tasks_.push_back([state]() { runBands(*state); });
+        }
+
+        hasTasks_.notify_all();
+    }
+
+    runBands(*state);
+
+    {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->allFinished.wait(lock, [&state]()
+        {
+            return state->finishedBands.load() == state->bandsCount;
+        });
+    }
+
+    return !token || !token->isCancelled();
+}
+
+} // namespace ps
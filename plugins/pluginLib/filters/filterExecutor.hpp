@@ -0,0 +1,79 @@
+#ifndef PLUGINS_PLUGIN_LIB_FILTERS_FILTER_EXECUTOR_HPP
+#define PLUGINS_PLUGIN_LIB_FILTERS_FILTER_EXECUTOR_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ps
+{
+
+// Shared between the job thread and the UI thread. Filters never touch it directly,
+// parallelForRows checks it between bands and reports progress to it.
+class JobToken
+{
+public:
+    void cancel();
+    bool isCancelled() const;
+
+    void  setProgress(float progress);
+    float getProgress() const;
+
+private:
+    std::atomic<bool> cancelled_{false};
+    std::atomic<float> progress_{0.f};
+};
+
+// token of the job running on this thread, nullptr outside of jobs
+JobToken* getCurrentJobToken();
+void setCurrentJobToken(JobToken* token);
+
+class FilterExecutor
+{
+public:
+    using RowsFunc = std::function<void(size_t rowBegin, size_t rowEnd)>;
+
+    // small bands - cancellation is noticed fast and load is balanced between workers
+    static constexpr size_t kBandHeight = 16;
+
+    static FilterExecutor& getInstance();
+
+    ~FilterExecutor();
+
+    FilterExecutor(const FilterExecutor&) = delete;
+    FilterExecutor& operator=(const FilterExecutor&) = delete;
+
+    // Splits [0, rowsCount) into bands and runs them on workers and on the calling thread.
+    // Returns false if current job was cancelled, some bands are skipped in this case.
+    // Filters with a setup per band that grows with their size may ask for taller bands.
+    bool parallelForRows(size_t rowsCount, const RowsFunc& func, size_t bandHeight = kBandHeight);
+
+    size_t getThreadsCount() const;
+
+private:
+    FilterExecutor();
+
+    void workerLoop();
+
+private:
+    std::vector<std::thread> workers_;
+
+    std::mutex mutex_;
+    std::condition_variable hasTasks_;
+    std::deque<std::function<void()>> tasks_;
+    bool stopping_ = false;
+};
+
+inline bool parallelForRows(size_t rowsCount, const FilterExecutor::RowsFunc& func,
+                            size_t bandHeight = FilterExecutor::kBandHeight)
+{
+    return FilterExecutor::getInstance().parallelForRows(rowsCount, func, bandHeight);
+}
+
+} // namespace ps
+
+#endif // PLUGINS_PLUGIN_LIB_FILTERS_FILTER_EXECUTOR_HPP
@@ -0,0 +1,259 @@
+#include "filterGraph.hpp"
+
+#include "pluginLib/canvas/canvas.hpp"
+#include "pluginLib/filters/filterExecutor.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace ps
+{
+
+// Channels lut implementation
+
+ChannelsLut ChannelsLut::identity()
+{
+    ChannelsLut lut;
+
+    for (size_t i = 0; i < 256; ++i)
+    {
+        uint8_t value = static_cast<uint8_t>(i);
+        lut.r[i] = lut.g[i] = lut.b[i] = lut.a[i] = value;
+    }
+
+    return lut;
+}
+
+ChannelsLut ChannelsLut::then(const ChannelsLut& next) const
+{
+    ChannelsLut result;
+
+    for (size_t i = 0; i < 256; ++i)
+    {
+        result.r[i] = next.r[r[i]];
+        result.g[i] = next.g[g[i]];
+        result.b[i] = next.b[b[i]];
+        result.a[i] = next.a[a[i]];
+    }
+
+    return result;
+}
+
+ChannelsLut makeNegativeLut()
+{
+    ChannelsLut lut = ChannelsLut::identity();
+
+    for (size_t i = 0; i < 256; ++i)
+        lut.r[i] = lut.g[i] = lut.b[i] = static_cast<uint8_t>(255 - i);
+
+    return lut;
+}
+
+ChannelsLut makeGainLut(float gain)
+{
+    ChannelsLut lut = ChannelsLut::identity();
+
+    for (size_t i = 0; i < 256; ++i)
+    {
+        int value = std::clamp(static_cast<int>(static_cast<float>(i) * gain), 0, 255);
+        lut.r[i] = lut.g[i] = lut.b[i] = static_cast<uint8_t>(value);
+    }
+
+    return lut;
+}
+
+ChannelsLut makeLevelsLut(uint8_t black, uint8_t white, float gamma)
+{
+    assert(black < white);
+    assert(gamma > 0);
+
+    ChannelsLut lut = ChannelsLut::identity();
+
+    float range = static_cast<float>(white - black);
+
+    for (size_t i = 0; i < 256; ++i)
+    {
+        float normalized = std::clamp((static_cast<float>(i) - black) / range, 0.f, 1.f);
+        long value = std::lround(255.f * std::pow(normalized, 1.f / gamma));
+
+        lut.r[i] = lut.g[i] = lut.b[i] = static_cast<uint8_t>(std::clamp(value, 0l, 255l));
+    }
+
+    return lut;
+}
+
+// Scalar lookups, four pixels per iteration: independent loads overlap and there is no
+// dependency on SIMD gather or byte shuffle support of the target.
+void applyLut(Pixels2D& pixels, const ChannelsLut& lut)
+{
+    parallelForRows(pixels.size(), [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+        {
+            Color* row = pixels[y].data();
+            size_t rowSize = pixels[y].size();
+
+            size_t x = 0;
+            for (; x + 4 <= rowSize; x += 4)
+            {
+                row[x + 0] = lut.apply(row[x + 0]);
+                row[x + 1] = lut.apply(row[x + 1]);
+                row[x + 2] = lut.apply(row[x + 2]);
+                row[x + 3] = lut.apply(row[x + 3]);
+            }
+
+            for (; x < rowSize; ++x)
+                row[x] = lut.apply(row[x]);
+        }
+    });
+}
+
+void applyColumnLuts(Pixels2D& pixels, const std::vector<ChannelsLut>& bank,
+                     const std::vector<uint8_t>& columnIndex)
+{
+    parallelForRows(pixels.size(), [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+        {
+            Color* row = pixels[y].data();
+            size_t rowSize = pixels[y].size();
+
+            assert(rowSize <= columnIndex.size());
+
+            size_t x = 0;
+            for (; x + 4 <= rowSize; x += 4)
+            {
+                row[x + 0] = bank[columnIndex[x + 0]].apply(row[x + 0]);
+                row[x + 1] = bank[columnIndex[x + 1]].apply(row[x + 1]);
+                row[x + 2] = bank[columnIndex[x + 2]].apply(row[x + 2]);
+                row[x + 3] = bank[columnIndex[x + 3]].apply(row[x + 3]);
+            }
+
+            for (; x < rowSize; ++x)
+                row[x] = bank[columnIndex[x]].apply(row[x]);
+        }
+    });
+}
+
+// Filter graph implementation
+
+FilterGraph& FilterGraph::addLut(const ChannelsLut& lut)
+{
+    Stage stage{StageType::Lut, lut, nullptr, nullptr};
+    stages_.push_back(std::move(stage));
+
+    return *this;
+}
+
+FilterGraph& FilterGraph::addPointOp(PointFunc func)
+{
+    Stage stage{StageType::Point, ChannelsLut{}, std::move(func), nullptr};
+    stages_.push_back(std::move(stage));
+
+    return *this;
+}
+
+FilterGraph& FilterGraph::addNeighborhoodOp(NeighborhoodFunc func)
+{
+    Stage stage{StageType::Neighborhood, ChannelsLut{}, nullptr, std::move(func)};
+    stages_.push_back(std::move(stage));
+
+    return *this;
+}
+
+size_t FilterGraph::getStagesCount() const
+{
+    return stages_.size();
+}
+
+void FilterGraph::applyFused(Pixels2D& pixels, const std::vector<FusedSegment>& segments)
+{
+    if (segments.empty())
+        return;
+
+    // common case - only luts, everything is already folded into one table
+    if (segments.size() == 1 && segments[0].points.empty())
+    {
+        applyLut(pixels, segments[0].lut);
+        return;
+    }
+
+    // point functions are called from several threads, they must not have mutable state
+    parallelForRows(pixels.size(), [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+        {
+            std::vector<Color>& row = pixels[y];
+
+            for (size_t x = 0; x < row.size(); ++x)
+            {
+                Color color = row[x];
+                vec2u pos = {static_cast<unsigned>(x), static_cast<unsigned>(y)};
+
+                for (const FusedSegment& segment : segments)
+                {
+                    if (segment.hasLut)
+                        color = segment.lut.apply(color);
+
+                    for (const PointFunc* point : segment.points)
+                        color = (*point)(color, pos);
+                }
+
+                row[x] = color;
+            }
+        }
+    });
+}
+
+Pixels2D FilterGraph::apply(Pixels2D pixels) const
+{
+    std::vector<FusedSegment> segments;
+
+    for (const Stage& stage : stages_)
+    {
+        switch (stage.type)
+        {
+            case StageType::Lut:
+                if (!segments.empty() && segments.back().hasLut && segments.back().points.empty())
+                {
+                    segments.back().lut = segments.back().lut.then(stage.lut);
+                    break;
+                }
+
+                segments.push_back(FusedSegment{true, stage.lut, {}});
+                break;
+
+            case StageType::Point:
+                if (segments.empty())
+                    segments.push_back(FusedSegment{false, ChannelsLut{}, {}});
+
+                segments.back().points.push_back(&stage.point);
+                break;
+
+            case StageType::Neighborhood:
+                applyFused(pixels, segments);
+                segments.clear();
+
+                pixels = stage.neighborhood(pixels);
+                break;
+
+            default:
+                assert(0 && "UNKNOWN STAGE TYPE");
+                break;
+        }
+    }
+
+    applyFused(pixels, segments);
+
+    return pixels;
+}
+
+void FilterGraph::apply(ILayer* layer, const vec2u& size) const
+{
+    assert(layer);
+
+    copyPixelsToLayer(layer, apply(getLayerScreenIn2D(layer, size)));
+}
+
+} // namespace ps
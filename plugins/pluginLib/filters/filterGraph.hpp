@@ -0,0 +1,113 @@
+#ifndef PLUGINS_PLUGIN_LIB_FILTERS_FILTER_GRAPH_HPP
+#define PLUGINS_PLUGIN_LIB_FILTERS_FILTER_GRAPH_HPP
+
+#include "api/api_sfm.hpp"
+#include "api/api_canvas.hpp"
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace ps
+{
+
+using namespace psapi;
+using namespace psapi::sfm;
+
+using Pixels2D = std::vector<std::vector<Color>>;
+
+// Rec. 601 luma in 8 bits by integer weights, alpha is ignored
+inline uint8_t getLuminance(Color color)
+{
+    return static_cast<uint8_t>((77 * color.r + 150 * color.g + 29 * color.b) >> 8);
+}
+
+// Per channel 256-entry table. Two tables compose into one table, so any chain of
+// lut stages costs a single lookup per channel.
+struct ChannelsLut
+{
+    std::array<uint8_t, 256> r;
+    std::array<uint8_t, 256> g;
+    std::array<uint8_t, 256> b;
+    std::array<uint8_t, 256> a;
+
+    static ChannelsLut identity();
+
+    // result(x) = next(this(x))
+    ChannelsLut then(const ChannelsLut& next) const;
+
+    Color apply(Color color) const
+    {
+        color.r = r[color.r];
+        color.g = g[color.g];
+        color.b = b[color.b];
+        color.a = a[color.a];
+
+        return color;
+    }
+};
+
+ChannelsLut makeNegativeLut();
+ChannelsLut makeGainLut(float gain); // alpha is left untouched
+
+// [black, white] is stretched to [0, 255], then midtones are raised by gamma > 1. Alpha is left untouched.
+ChannelsLut makeLevelsLut(uint8_t black, uint8_t white, float gamma);
+
+void applyLut(Pixels2D& pixels, const ChannelsLut& lut);
+
+// column x is mapped by bank[columnIndex[x]], columnIndex has to cover the whole row
+void applyColumnLuts(Pixels2D& pixels, const std::vector<ChannelsLut>& bank,
+                     const std::vector<uint8_t>& columnIndex);
+
+class FilterGraph
+{
+public:
+    using PointFunc        = std::function<Color(Color color, vec2u pos)>;
+    using NeighborhoodFunc = std::function<Pixels2D(const Pixels2D& pixels)>;
+
+    FilterGraph& addLut(const ChannelsLut& lut);
+    FilterGraph& addPointOp(PointFunc func);
+    FilterGraph& addNeighborhoodOp(NeighborhoodFunc func);
+
+    size_t getStagesCount() const;
+
+    // point stages between two neighborhood stages are fused into one pass over the pixels
+    Pixels2D apply(Pixels2D pixels) const;
+
+    // one read and one write of the layer for the whole graph
+    void apply(ILayer* layer, const vec2u& size) const;
+
+private:
+    enum class StageType
+    {
+        Lut,
+        Point,
+        Neighborhood,
+    };
+
+    struct Stage
+    {
+        StageType type;
+
+        ChannelsLut lut;
+        PointFunc point;
+        NeighborhoodFunc neighborhood;
+    };
+
+    struct FusedSegment
+    {
+        bool hasLut = false;
+        ChannelsLut lut;
+        std::vector<const PointFunc*> points;
+    };
+
+    static void applyFused(Pixels2D& pixels, const std::vector<FusedSegment>& segments);
+
+private:
+    std::vector<Stage> stages_;
+};
+
+} // namespace ps
+
+#endif // PLUGINS_PLUGIN_LIB_FILTERS_FILTER_GRAPH_HPP
@@ -0,0 +1,145 @@
+#include "filterJobs.hpp"
+
+#include "pluginLib/actions/actions.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace ps
+{
+
+// Filter job implementation
+
+FilterJob::FilterJob(Task task, FinishCallback onFinish, CancelCallback onCancel) 
+    : onFinish_(std::move(onFinish)), onCancel_(std::move(onCancel))
+{
+    assert(task);
+
+    thread_ = std::thread([this, task = std::move(task)]()
+    {
+        setCurrentJobToken(&token_);
+
+        Pixels2D result = task();
+        if (!token_.isCancelled())
+            result_ = std::move(result);
+
+        setCurrentJobToken(nullptr);
+
+        token_.setProgress(1.f);
+        done_.store(true);
+    });
+}
+
+FilterJob::~FilterJob()
+{
+    cancel();
+
+    if (thread_.joinable())
+        thread_.join();
+}
+
+void FilterJob::cancel()
+{
+    token_.cancel();
+}
+
+bool FilterJob::isCancelled() const
+{
+    return token_.isCancelled();
+}
+
+bool FilterJob::isDone() const
+{
+    return done_.load();
+}
+
+float FilterJob::getProgress() const
+{
+    return token_.getProgress();
+}
+
+void FilterJob::finish()
+{
+    assert(isDone());
+
+    if (thread_.joinable())
+        thread_.join();
+
+    if (!isCancelled() && onFinish_)
+        onFinish_(result_);
+    else if (isCancelled() && onCancel_)
+        onCancel_();
+
+    onFinish_ = nullptr;
+    onCancel_ = nullptr;
+    result_.clear();
+}
+
+// Filter jobs window implementation
+
+std::unique_ptr<IAction> FilterJobsWindow::createAction(const IRenderWindow* renderWindow,
+                                                        const Event& event)
+{
+    return std::make_unique<UpdateCallbackAction<FilterJobsWindow>>(*this, renderWindow, event);
+}
+
+bool FilterJobsWindow::update(const IRenderWindow* /* renderWindow */, const Event& event)
+{
+    if (event.type == Event::KeyPressed && event.key.code == Keyboard::Key::Escape)
+        cancelAll();
+
+    // finished job callbacks may submit new jobs
+    std::vector<std::shared_ptr<FilterJob>> finished;
+
+    auto running = std::stable_partition(jobs_.begin(), jobs_.end(), [](const std::shared_ptr<FilterJob>& job)
+    {
+        return !job->isDone();
+    });
+
+    finished.assign(std::make_move_iterator(running), std::make_move_iterator(jobs_.end()));
+    jobs_.erase(running, jobs_.end());
+
+    for (auto& job : finished)
+        job->finish();
+
+    return !finished.empty();
+}
+
+void FilterJobsWindow::draw(IRenderWindow* /* renderWindow */)
+{
+    return;
+}
+
+std::shared_ptr<FilterJob> FilterJobsWindow::submit(FilterJob::Task task, FilterJob::FinishCallback onFinish,
+                                                    FilterJob::CancelCallback onCancel)
+{
+    auto job = std::make_shared<FilterJob>(std::move(task), std::move(onFinish), std::move(onCancel));
+    jobs_.push_back(job);
+
+    return job;
+}
+
+void FilterJobsWindow::cancelAll()
+{
+    for (auto& job : jobs_)
+        job->cancel();
+}
+
+FilterJobsWindow* getFilterJobsWindow()
+{
+    static FilterJobsWindow* jobsWindow = nullptr;
+
+    if (!jobsWindow)
+    {
+        auto window = std::make_unique<FilterJobsWindow>();
+        jobsWindow = window.get();
+
+        IRootWindow* rootWindow = getRootWindow();
+        assert(rootWindow);
+        rootWindow->addWindow(std::move(window));
+    }
+
+    return jobsWindow;
+}
+
+} // namespace ps
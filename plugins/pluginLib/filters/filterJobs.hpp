@@ -0,0 +1,83 @@
+#ifndef PLUGINS_PLUGIN_LIB_FILTERS_FILTER_JOBS_HPP
+#define PLUGINS_PLUGIN_LIB_FILTERS_FILTER_JOBS_HPP
+
+#include "api/api_photoshop.hpp"
+
+#include "pluginLib/filters/filterExecutor.hpp"
+#include "pluginLib/filters/filterGraph.hpp"
+#include "pluginLib/windows/windows.hpp"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace ps
+{
+
+using namespace psapi;
+using namespace psapi::sfm;
+
+// Runs filter on its own thread, task must not touch windows or layers.
+// Result is handed to the callback on the UI thread by FilterJobsWindow.
+class FilterJob
+{
+public:
+    using Task           = std::function<Pixels2D()>;
+    using FinishCallback = std::function<void(const Pixels2D& result)>;
+    using CancelCallback = std::function<void()>;
+
+    FilterJob(Task task, FinishCallback onFinish, CancelCallback onCancel = nullptr);
+    ~FilterJob();
+
+    FilterJob(const FilterJob&) = delete;
+    FilterJob& operator=(const FilterJob&) = delete;
+
+    void cancel();
+    bool isCancelled() const;
+
+    bool isDone() const;
+    float getProgress() const;
+
+    // UI thread only, cancelled jobs get onCancel instead of onFinish
+    void finish();
+
+private:
+    JobToken token_;
+    FinishCallback onFinish_;
+    CancelCallback onCancel_;
+
+    Pixels2D result_;
+    std::atomic<bool> done_{false};
+
+    std::thread thread_;
+};
+
+// Invisible window that polls running jobs every update, so results are applied even when
+// the filter menu is closed. Escape cancels all the jobs.
+class FilterJobsWindow : public AWindow
+{
+public:
+    FilterJobsWindow() = default;
+
+    std::unique_ptr<IAction> createAction(const IRenderWindow* renderWindow,
+                                          const Event& event) override;
+    bool update(const IRenderWindow* renderWindow, const Event& event);
+
+    void draw(IRenderWindow* renderWindow) override;
+
+    std::shared_ptr<FilterJob> submit(FilterJob::Task task, FilterJob::FinishCallback onFinish,
+                                      FilterJob::CancelCallback onCancel = nullptr);
+    void cancelAll();
+
+private:
+    std::vector<std::shared_ptr<FilterJob>> jobs_;
+};
+
+// created and added to the root window on first call
+FilterJobsWindow* getFilterJobsWindow();
+
+} // namespace ps
+
+#endif // PLUGINS_PLUGIN_LIB_FILTERS_FILTER_JOBS_HPP
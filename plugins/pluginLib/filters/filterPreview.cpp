@@ -0,0 +1,278 @@
+#include "filterPreview.hpp"
+
+#include "pluginLib/canvas/canvas.hpp"
+#include "pluginLib/filters/filters.hpp"
+
+#include <cassert>
+
+namespace ps
+{
+
+namespace
+{
+
+const unsigned kProxyFactors[] = {4, 2, 1};
+const size_t kLevelsCount = sizeof(kProxyFactors) / sizeof(kProxyFactors[0]);
+
+// full resolution is rendered only when slider stays still for this time
+const long long kRefineDelayMs = 150;
+
+} // namespace anonymous
+
+LayerTiling FilterPreview::getWholeLayerTiling(const std::vector<float>& /* parameters */)
+{
+    return LayerTiling::wholeRegion();
+}
+
+void FilterPreview::begin(ICanvas* canvas, const std::string& filterId, Filter filter, Halo halo,
+                          Tiling tiling)
+{
+    assert(filter);
+
+    auto placedFilter = [filter = std::move(filter)](const Pixels2D& pixels, const std::vector<float>& parameters,
+                                                     float scale, const LayerPlacement&)
+    {
+        return filter(pixels, parameters, scale);
+    };
+
+    begin(canvas, filterId, PlacedFilter{std::move(placedFilter)}, std::move(halo), std::move(tiling));
+}
+
+void FilterPreview::begin(ICanvas* canvas, const std::string& filterId, PlacedFilter filter, Halo halo,
+                          Tiling tiling)
+{
+    assert(canvas);
+    assert(halo);
+
+    reset();
+
+    filter_ = std::move(filter);
+    halo_   = std::move(halo);
+    tiling_ = std::move(tiling);
+    parameters_.clear();
+
+    layerIndex_ = canvas->getActiveLayerIndex();
+    ILayer* activeLayer = canvas->getLayer(layerIndex_);
+    source_ = std::make_shared<const Pixels2D>(getLayerScreenIn2D(activeLayer, canvas->getSize()));
+    sourcePlacement_ = LayerPlacement{getLayerVisiblePos(activeLayer), getLayerFullSize(activeLayer, canvas->getSize())};
+
+    cacheKey_ = FilterCacheKey{};
+    cacheKey_.filterId = filterId;
+    isCacheable_ = makeFilterCacheKey(cacheKey_, activeLayer, canvas->getSize());
+
+    for (unsigned factor : kProxyFactors)
+    {
+        if (factor != 1)
+            proxies_.push_back(getDownscaled(*source_, factor));
+    }
+
+    nextLevel_ = 0;
+    idleTimer_.start();
+}
+
+void FilterPreview::setParameters(const std::vector<float>& parameters)
+{
+    if (parameters == parameters_ && !parameters_.empty())
+        return;
+
+    cancelRefining();
+
+    parameters_ = parameters;
+    refined_.clear();
+
+    nextLevel_ = 0;
+    idleTimer_.start();
+}
+
+void FilterPreview::update(ICanvas* canvas)
+{
+    if (!filter_ || isRefined())
+        return;
+
+    if (refineJob_)
+    {
+        // cancelled by user, coarse preview is kept until parameters change
+        if (refineJob_->isCancelled())
+        {
+            refineJob_.reset();
+            nextLevel_ = kLevelsCount;
+        }
+
+        return;
+    }
+
+    // parameters were seen before - no need in coarse levels
+    if (nextLevel_ == 0 && drawCachedRefined(canvas))
+        return;
+
+    if (nextLevel_ == kLevelsCount - 1)
+    {
+        if (idleTimer_.deltaInMs() >= kRefineDelayMs)
+            startRefining(canvas);
+
+        return;
+    }
+
+    drawLevel(canvas, nextLevel_);
+    ++nextLevel_;
+}
+
+bool FilterPreview::isRefined() const
+{
+    return nextLevel_ >= kLevelsCount;
+}
+
+void FilterPreview::drawLevel(ICanvas* canvas, size_t level)
+{
+    assert(canvas);
+    assert(level < kLevelsCount);
+
+    unsigned factor = kProxyFactors[level];
+    assert(factor != 1);
+
+    ILayer* tempLayer = canvas->getTempLayer();
+    const Pixels2D& source = *source_;
+
+    FilterCacheKey key = createCacheKey(factor);
+    std::shared_ptr<const Pixels2D> filtered = isCacheable_ ? getFilterCache().find(key) : nullptr;
+
+    if (!filtered)
+    {
+        filtered = std::make_shared<const Pixels2D>(
+            filter_(proxies_[level], parameters_, 1.f / static_cast<float>(factor), sourcePlacement_));
+
+        if (isCacheable_)
+            getFilterCache().insert(key, filtered);
+    }
+
+    for (size_t y = 0; y < source.size(); ++y)
+    {
+        const std::vector<Color>& filteredRow = (*filtered)[y / factor];
+
+        for (size_t x = 0; x < source[y].size(); ++x)
+            tempLayer->setPixel(vec2i{static_cast<int>(x), static_cast<int>(y)}, filteredRow[x / factor]);
+    }
+}
+
+bool FilterPreview::drawCachedRefined(ICanvas* canvas)
+{
+    assert(canvas);
+
+    if (!isCacheable_)
+        return false;
+
+    std::shared_ptr<const Pixels2D> cached = getFilterCache().find(createCacheKey(1));
+    if (!cached)
+        return false;
+
+    refined_ = *cached;
+    copyPixelsToLayer(canvas->getTempLayer(), refined_);
+
+    nextLevel_ = kLevelsCount;
+
+    return true;
+}
+
+void FilterPreview::startRefining(ICanvas* canvas)
+{
+    assert(canvas);
+    assert(!refineJob_);
+
+    FilterCacheKey key = createCacheKey(1);
+
+    refineJob_ = getFilterJobsWindow()->submit(createFullResolutionTask(), 
+                                               [this, canvas, key](const Pixels2D& result)
+    {
+        if (isCacheable_)
+            getFilterCache().insert(key, std::make_shared<const Pixels2D>(result));
+
+        refined_ = result;
+        copyPixelsToLayer(canvas->getTempLayer(), refined_);
+
+        refineJob_.reset();
+        nextLevel_ = kLevelsCount;
+    });
+}
+
+void FilterPreview::cancelRefining()
+{
+    if (!refineJob_)
+        return;
+
+    refineJob_->cancel();
+    refineJob_.reset();
+}
+
+FilterJob::Task FilterPreview::createFullResolutionTask() const
+{
+    return [filter = filter_, parameters = parameters_, source = source_, placement = sourcePlacement_]()
+    {
+        return filter(*source, parameters, 1.f, placement);
+    };
+}
+
+FilterCacheKey FilterPreview::createCacheKey(unsigned downscale) const
+{
+    FilterCacheKey key = cacheKey_;
+
+    key.downscale      = downscale;
+    key.parameters     = parameters_;
+    key.parametersHash = hashParameters(parameters_);
+
+    return key;
+}
+
+std::shared_ptr<TiledLayerFilter> FilterPreview::commit(ICanvas* canvas)
+{
+    assert(canvas);
+
+    if (!filter_)
+        return nullptr;
+
+    cancelRefining();
+    canvas->cleanTempLayer();
+
+    // layer may be removed while preview was shown
+    if (layerIndex_ >= canvas->getNumLayers())
+    {
+        reset();
+        return nullptr;
+    }
+
+    auto tileFilter = [filter = filter_, parameters = parameters_](const Pixels2D& pixels,
+                                                                   const LayerPlacement& placement)
+    {
+        return filter(pixels, parameters, 1.f, placement);
+    };
+
+    LayerTiling tiling = tiling_ ? tiling_(parameters_) : LayerTiling{};
+
+    auto run = TiledLayerFilter::start(canvas, layerIndex_, std::move(tileFilter), halo_(parameters_), tiling);
+
+    reset();
+
+    return run;
+}
+
+void FilterPreview::cancel(ICanvas* canvas)
+{
+    assert(canvas);
+
+    canvas->cleanTempLayer();
+    reset();
+}
+
+void FilterPreview::reset()
+{
+    cancelRefining();
+
+    filter_ = nullptr;
+    halo_   = nullptr;
+    tiling_ = nullptr;
+    isCacheable_ = false;
+    source_.reset();
+    proxies_.clear();
+    refined_.clear();
+}
+
+} // namespace ps
@@ -0,0 +1,94 @@
+#ifndef PLUGINS_PLUGIN_LIB_FILTERS_FILTER_PREVIEW_HPP
+#define PLUGINS_PLUGIN_LIB_FILTERS_FILTER_PREVIEW_HPP
+
+#include "api/api_canvas.hpp"
+
+#include "pluginLib/filters/filterCache.hpp"
+#include "pluginLib/filters/filterGraph.hpp"
+#include "pluginLib/filters/filterJobs.hpp"
+#include "pluginLib/filters/tiledLayerFilter.hpp"
+#include "pluginLib/timer/timer.hpp"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ps
+{
+
+// Live preview of a parameterized filter. Preview is rendered into the temp layer: first on 1/4 and 1/2
+// downscaled proxies of the visible region, full resolution in a background job only after parameters
+// stop changing. Real layer is touched only on commit, which filters the whole layer.
+class FilterPreview
+{
+public:
+    // scale - proxy scale, filters have to scale their spatial parameters with it.
+    // Full resolution is filtered on job thread, so filter must not touch windows.
+    using Filter = std::function<Pixels2D(const Pixels2D& pixels, const std::vector<float>& parameters,
+                                          float scale)>;
+
+    // for filters depending on where the pixels are in the layer, placement is in full resolution
+    using PlacedFilter = std::function<Pixels2D(const Pixels2D& pixels, const std::vector<float>& parameters,
+                                                float scale, const LayerPlacement& placement)>;
+
+    // how many pixels around a pixel the filter reads with given parameters in full resolution
+    using Halo = std::function<size_t(const std::vector<float>& parameters)>;
+
+    // tiles committed filter gets with given parameters, see LayerTiling
+    using Tiling = std::function<LayerTiling(const std::vector<float>& parameters)>;
+
+    // tiling of filters that need the whole layer at once
+    static LayerTiling getWholeLayerTiling(const std::vector<float>& parameters);
+
+    // filterId - name of the filter in the results cache
+    void begin(ICanvas* canvas, const std::string& filterId, Filter filter, Halo halo,
+               Tiling tiling = nullptr);
+    void begin(ICanvas* canvas, const std::string& filterId, PlacedFilter filter, Halo halo,
+               Tiling tiling = nullptr);
+
+    // restarts preview from the coarsest level if parameters differ from the previous ones
+    void setParameters(const std::vector<float>& parameters);
+
+    void update(ICanvas* canvas);
+    bool isRefined() const;
+
+    // starts filtering of the whole active layer in full resolution, run records undoable action
+    std::shared_ptr<TiledLayerFilter> commit(ICanvas* canvas);
+    void cancel(ICanvas* canvas);
+
+private:
+    void drawLevel(ICanvas* canvas, size_t level);
+    bool drawCachedRefined(ICanvas* canvas);
+    void startRefining(ICanvas* canvas);
+    void cancelRefining();
+    void reset();
+
+    FilterJob::Task createFullResolutionTask() const;
+    FilterCacheKey createCacheKey(unsigned downscale) const;
+
+private:
+    PlacedFilter filter_;
+    Halo halo_;
+    Tiling tiling_;
+    std::vector<float> parameters_;
+
+    std::shared_ptr<const Pixels2D> source_;
+    LayerPlacement sourcePlacement_ = {{0, 0}, {0, 0}};
+    std::vector<Pixels2D> proxies_;
+    Pixels2D refined_;
+
+    size_t layerIndex_ = 0;
+
+    bool isCacheable_ = false;
+    FilterCacheKey cacheKey_;
+
+    std::shared_ptr<FilterJob> refineJob_;
+
+    size_t nextLevel_ = 0;
+    Timer idleTimer_;
+};
+
+} // namespace ps
+
+#endif // PLUGINS_PLUGIN_LIB_FILTERS_FILTER_PREVIEW_HPP
@@ -8,6 +8,7 @@
 
 #include <string>
 #include <cassert>
+#include <cmath>
 
 namespace ps
 {
@@ -189,6 +190,16 @@ void FilterWindow::close()
     renderWindow_->close();
 }
 
+void FilterWindow::confirm()
+{
+    isConfirmed_ = true;
+}
+
+bool FilterWindow::isConfirmed() const
+{
+    return isConfirmed_;
+}
+
 vec2u FilterWindow::getRenderWindowSize() const
 {
     return renderWindow_->getSize();
@@ -211,9 +222,9 @@ private:
 
 std::string SliderTitleAction::getSliderTitle() const
 {
-    float thickness = slider_->getCurrentValue();
+    float value = slider_->getCurrentValue();
 
-    return std::to_string(static_cast<int>(thickness));
+    return std::to_string(std::lround(value));
 }
 
 // Cancel button
@@ -249,6 +260,7 @@ public:
 
     bool execute(const Key& /* key */) override
     { 
+        filterWindow_->confirm();
         filterWindow_->close();
         return true; 
     }
@@ -319,43 +331,79 @@ void addApplyButtons(FilterWindow* filterWindow)
     filterWindow->addWindow(std::move(okButton));
 }
 
-std::unique_ptr<FilterWindow> createSimpleFilterWindow(const char* name)
+std::unique_ptr<FilterWindow> createSlidersFilterWindow(const char* name, 
+                                                       const std::vector<SliderParameters>& sliders)
 {
     auto filterWindow = std::make_unique<FilterWindow>(kInvalidWindowId, name);
 
-    SpriteInfo slideNormal = createSprite("assets/textures/longSliderNormal.png");
-    SpriteInfo slidePress  = createSprite("assets/textures/longSliderPress.png");
+    auto emptyWindow = std::make_unique<EmptyWindow>(createSprite("assets/textures/renderWindowColor.png"));
+    emptyWindow->setSize(RenderWindowSize);
+
+    filterWindow->addWindow(std::move(emptyWindow)); // order is important
 
-    assert(slideNormal.sprite->getSize().x == slidePress.sprite->getSize().x);
-    assert(slideNormal.sprite->getSize().y == slidePress.sprite->getSize().y);
+    const vec2i firstSliderPos = {100, 60};
+    const int slidersStep = 45;
 
-    Color blueSliderColor = Color{74, 115, 145, 255};
-    vec2u spritesOutlineWidth = {3, 2};
-    vec2u maxFillColorSize = slideNormal.sprite->getSize() - 2 * spritesOutlineWidth;
-    maxFillColorSize.x = 432;
+    for (size_t i = 0; i < sliders.size(); ++i)
+    {
+        const SliderParameters& parameters = sliders[i];
 
-    const float maxRadius = 10;
-    auto namedSlider = std::make_unique<NamedSlider>("Radius: ", maxRadius);
+        SpriteInfo slideNormal = createSprite("assets/textures/longSliderNormal.png");
+        SpriteInfo slidePress  = createSprite("assets/textures/longSliderPress.png");
 
-    auto slider = std::make_unique<SliderX>(
-                    vec2i{0, 0}, slideNormal.sprite->getSize(), kInvalidWindowId, 
-                    createShape(blueSliderColor, {1, 1}), 
-                    std::move(slideNormal), std::move(slidePress),
-                    maxFillColorSize, spritesOutlineWidth,
-                    std::make_unique<SliderTitleAction>(namedSlider.get()));
+        assert(slideNormal.sprite->getSize().x == slidePress.sprite->getSize().x);
+        assert(slideNormal.sprite->getSize().y == slidePress.sprite->getSize().y);
 
-    namedSlider->setSlider(std::move(slider));
-    namedSlider->setPos({100, 100});
+        Color blueSliderColor = Color{74, 115, 145, 255};
+        vec2u spritesOutlineWidth = {3, 2};
+        vec2u maxFillColorSize = slideNormal.sprite->getSize() - 2 * spritesOutlineWidth;
+        maxFillColorSize.x = 432;
 
-    auto emptyWindow = std::make_unique<EmptyWindow>(createSprite("assets/textures/renderWindowColor.png"));
-    emptyWindow->setSize(RenderWindowSize);
+        auto namedSlider = std::make_unique<NamedSlider>(kFirstParameterSliderId + static_cast<wid_t>(i), 
+                                                         parameters.caption.c_str(),
+                                                         parameters.minValue, parameters.maxValue);
 
-    filterWindow->addWindow(std::move(emptyWindow)); // order is important
-    filterWindow->addWindow(std::move(namedSlider));
+        auto slider = std::make_unique<SliderX>(
+                        vec2i{0, 0}, slideNormal.sprite->getSize(), kInvalidWindowId, 
+                        createShape(blueSliderColor, {1, 1}), 
+                        std::move(slideNormal), std::move(slidePress),
+                        maxFillColorSize, spritesOutlineWidth,
+                        std::make_unique<SliderTitleAction>(namedSlider.get()));
+
+        namedSlider->setSlider(std::move(slider));
+        namedSlider->setCurrentValue(parameters.defaultValue);
+        namedSlider->setPos({firstSliderPos.x, firstSliderPos.y + slidersStep * static_cast<int>(i)});
+
+        filterWindow->addWindow(std::move(namedSlider));
+    }
 
     addApplyButtons(filterWindow.get());
 
     return filterWindow;
 }
 
+std::vector<float> getSlidersValues(FilterWindow* filterWindow, const std::vector<SliderParameters>& sliders)
+{
+    assert(filterWindow);
+
+    std::vector<float> values;
+
+    for (size_t i = 0; i < sliders.size(); ++i)
+    {
+        auto slider = dynamic_cast<NamedSlider*>(
+            filterWindow->getWindowById(kFirstParameterSliderId + static_cast<wid_t>(i)));
+        assert(slider);
+
+        float value = slider->getCurrentValue();
+        float step  = sliders[i].step;
+
+        if (step > 0.f)
+            value = std::round(value / step) * step;
+
+        values.push_back(value);
+    }
+
+    return values;
+}
+
 } // namespace ps
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include "pluginLib/windows/windows.hpp"
 #include "pluginLib/bars/ps_bar.hpp"
 
+#include <string>
 #include <vector>
 
 namespace ps
@@ -47,11 +48,16 @@ public:
     bool closed() const;
     void close();
 
+    // window was closed with "Ok"
+    void confirm();
+    bool isConfirmed() const;
+
     vec2u getRenderWindowSize() const;
 
 private:
     wid_t id_;
     bool isActive_ = true;
+    bool isConfirmed_ = false;
 
     std::unique_ptr<IRenderWindow> renderWindow_;
     std::vector<std::unique_ptr<IWindow>> windows_;
@@ -66,7 +72,22 @@ public:
 private:
 };
 
-std::unique_ptr<FilterWindow> createSimpleFilterWindow(const char* name);
+struct SliderParameters
+{
+    std::string caption;
+
+    float minValue;
+    float maxValue;
+    float defaultValue;
+
+    float step = 1.f; // values are rounded to it, 0 - continuous
+};
+
+// slider i gets id kFirstParameterSliderId + i
+std::unique_ptr<FilterWindow> createSlidersFilterWindow(const char* name, 
+                                                       const std::vector<SliderParameters>& sliders);
+
+std::vector<float> getSlidersValues(FilterWindow* filterWindow, const std::vector<SliderParameters>& sliders);
 
 }
 
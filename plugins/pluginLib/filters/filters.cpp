@@ -4,19 +4,38 @@
 
 #include "pluginLib/actions/actions.hpp"
 #include "pluginLib/canvas/canvas.hpp"
+#include "pluginLib/filters/convolution.hpp"
+#include "pluginLib/filters/filterExecutor.hpp"
+#include "pluginLib/filters/gaussianBlur.hpp"
+#include "pluginLib/filters/summedAreaTable.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 
 namespace ps
 {
 
 // Filter button implementation
 
-// krita, фильтр яркости со сплайном 
-// baseline шрифта 
-// фильтры настройки
+FilterButton::FilterButton(std::unique_ptr<IText> name, std::unique_ptr<IFont> font, const std::string& title,
+                           size_t halo, Filter filter) 
+    : FilterButton(std::move(name), std::move(font), title, halo, 
+                   [filter = std::move(filter)](const ICanvas*, size_t) { return filter; })
+{
+}
 
-#if 0
+FilterButton::FilterButton(std::unique_ptr<IText> name, std::unique_ptr<IFont> font, const std::string& title,
+                           size_t halo, FilterFactory filterFactory) 
+    : title_(title), halo_(halo), filterFactory_(std::move(filterFactory))
+{
+    assert(filterFactory_);
+
+    name_ = std::move(name);
+    font_ = std::move(font);
+
+    name_->setString(title_);
+}
 
 std::unique_ptr<IAction> FilterButton::createAction(const IRenderWindow* renderWindow, 
                                                     const Event& event)
@@ -31,168 +50,280 @@ bool FilterButton::update(const IRenderWindow* renderWindow, const Event& event)
     if (state_ != State::Released)
         return updateStateRes;
 
+    state_ = State::Normal;
+
+    // previous run is not finished yet
+    if (run_ && !run_->isDone())
+        return true;
+
     ICanvas* canvas = static_cast<ICanvas*>(getRootWindow()->getWindowById(kCanvasWindowId));
     assert(canvas);
     
-    size_t activeLayerIndex = canvas->getActiveLayerIndex();
-    ILayer* activeLayer = canvas->getLayer(activeLayerIndex);
+    size_t layerIndex = canvas->getActiveLayerIndex();
 
-    vec2u canvasSize = canvas->getSize();
+    Filter filter = filterFactory_(canvas, layerIndex);
+    assert(filter);
 
-    filterAction_->execute()
-    std::vector<std::vector<Color>> pixels = getLayerScreenIn2D(activeLayer, canvasSize);
-    std::vector<std::vector<Color>> blured = getBoxBlured(pixels);
-    
-    copyPixelsToLayer(activeLayer, blured);
-    
-    state_ = State::Normal;
+    auto tileFilter = [filter = std::move(filter)](const Pixels2D& pixels, const LayerPlacement&)
+    {
+        return filter(pixels);
+    };
+
+    run_ = TiledLayerFilter::start(canvas, layerIndex, std::move(tileFilter), halo_);
 
     return true;
 }
 
-#endif
+void FilterButton::draw(IRenderWindow* renderWindow)
+{
+    name_->setString(getJobTitle(title_, run_.get()));
+
+    ANamedBarButton::draw(renderWindow);
+}
+
+std::string getJobTitle(const std::string& title, const TiledLayerFilter* run)
+{
+    if (!run || run->isDone())
+        return title;
+
+    int percents = static_cast<int>(run->getProgress() * 100.f);
+
+    return title + " " + std::to_string(percents) + "%";
+}
+
+// Filters implementation
+
 
 std::vector<std::vector<Color>> getNegative(const std::vector<std::vector<Color>>& pixels)
 {
     std::vector<std::vector<Color>> negative(pixels.size(), std::vector<Color>(pixels[0].size()));
 
-    for (size_t y = 0; y < pixels.size(); ++y)
+    parallelForRows(pixels.size(), [&](size_t rowBegin, size_t rowEnd)
     {
-        assert(pixels[y].size() == pixels[0].size());
-
-        for (size_t x = 0; x < pixels[0].size(); ++x)
+        for (size_t y = rowBegin; y < rowEnd; ++y)
         {
-            negative[y][x] = {255 - pixels[y][x].r, 
-                              255 - pixels[y][x].g, 
-                              255 - pixels[y][x].b, 
-                                    pixels[y][x].a};
+            assert(pixels[y].size() == pixels[0].size());
+
+            for (size_t x = 0; x < pixels[0].size(); ++x)
+            {
+                negative[y][x] = {255 - pixels[y][x].r, 
+                                  255 - pixels[y][x].g, 
+                                  255 - pixels[y][x].b, 
+                                        pixels[y][x].a};
+            }
         }
-    }
+    });
 
     return negative;
 }
 
-std::vector<std::vector<Color>> getBasRelief(const std::vector<std::vector<Color>>& pixels, 
-                                             const std::vector<std::vector<Color>>& negative)
+std::vector<std::vector<Color>> getBasRelief(const std::vector<std::vector<Color>>& pixels)
 {
-    assert(pixels.size() == negative.size());
+    return convolve(pixels, kBasReliefKernel);
+}
 
-    std::vector<std::vector<Color>> basRelief(pixels.size(), std::vector<Color>(pixels[0].size()));
+namespace
+{
 
-    unsigned ySize = static_cast<unsigned>(pixels.size());
-    unsigned xSize = ySize > 0 ? static_cast<unsigned>(pixels[0].size()) : 0;
+std::vector<std::vector<Color>> getBoxBluredWithTable(const std::vector<std::vector<Color>>& pixels,
+                                                      int horizontalRadius, int verticalRadius)
+{
+    SummedAreaTable table(pixels);
+    std::vector<std::vector<Color>> blured(pixels.size(), std::vector<Color>(table.getWidth()));
 
-    for (unsigned y = 0; y < ySize; ++y)
+    parallelForRows(pixels.size(), [&](size_t rowBegin, size_t rowEnd)
     {
-        for (unsigned x = 0; x < xSize; ++x)
+        for (size_t y = rowBegin; y < rowEnd; ++y)
         {
-            assert(pixels[y].size() == pixels[0].size());
-            assert(pixels[y].size() == negative[y].size());
-
-            Color color = pixels[std::clamp(y + 1, 0u, ySize - 1)]
-                                [std::clamp(x + 1, 0u, xSize - 1)];
-
-            Color negColor = negative[y][x];
-            Color newColor = Color{(negColor.r + color.r) / 2, 
-                                   (negColor.g + color.g) / 2, 
-                                   (negColor.b + color.b) / 2, 
-                                                 color.a};
-            
-            basRelief[y][x] = newColor;
+            int top    = static_cast<int>(y) - verticalRadius;
+            int bottom = static_cast<int>(y) + verticalRadius + 1;
+
+            for (size_t x = 0; x < table.getWidth(); ++x)
+            {
+                int left  = static_cast<int>(x) - horizontalRadius;
+                int right = static_cast<int>(x) + horizontalRadius + 1;
+
+                blured[y][x] = table.rectMean(left, top, right, bottom);
+            }
         }
-    }
+    });
 
-    return basRelief;    
+    return blured;
 }
 
-// excluding boundaries
-static bool valueInBoundaries(int value, int boundaryBottom, int boundaryTop)
+} // namespace anonymous
+
+std::vector<std::vector<Color>> getBoxBlured(const std::vector<std::vector<Color>>& pixels,
+                                             int horizontalRadius, int verticalRadius, BoxBlurMethod method)
 {
-    return boundaryBottom < value && value < boundaryTop;
+    assert(horizontalRadius >= 0);
+    assert(verticalRadius   >= 0);
+
+    if (method == BoxBlurMethod::Auto)
+    {
+        bool isWide = std::max(horizontalRadius, verticalRadius) > kBoxBlurSatRadius;
+        method = isWide ? BoxBlurMethod::SummedAreaTable : BoxBlurMethod::Separable;
+    }
+
+    if (method == BoxBlurMethod::SummedAreaTable)
+        return getBoxBluredWithTable(pixels, horizontalRadius, verticalRadius);
+
+    RuntimeSeparableKernel kernel;
+    kernel.horizontal.assign(2 * static_cast<size_t>(horizontalRadius) + 1, 1);
+    kernel.vertical  .assign(2 * static_cast<size_t>(verticalRadius)   + 1, 1);
+    kernel.divisor = (2 * horizontalRadius + 1) * (2 * verticalRadius + 1);
+
+    return convolve(pixels, kernel, AlphaMode::Convolve);
 }
 
-static Color boxBlurPixel(const std::vector<std::vector<Color>>& pixels, int x0, int y0,
-                          int horizontalRadius, int verticalRadius)
+std::vector<std::vector<Color>> getMosaic(const std::vector<std::vector<Color>>& pixels, size_t cellSize)
 {
-    assert(x0 >= 0);
-    assert(y0 >= 0);
-    assert(y0 < static_cast<int>(pixels.size()));
-    assert(x0 < static_cast<int>(pixels[(size_t)y0].size()));
+    assert(cellSize > 0);
+
+    SummedAreaTable table(pixels);
+    std::vector<std::vector<Color>> mosaic(pixels.size(), std::vector<Color>(table.getWidth()));
 
-    int resultR = 0, resultB = 0, resultG = 0, resultA = 0;
-    int divider = 0;
+    const size_t cellsRows = (pixels.size() + cellSize - 1) / cellSize;
 
-    for (int y = y0 - verticalRadius; y <= y0 + verticalRadius; ++y)
+    parallelForRows(cellsRows, [&](size_t cellRowBegin, size_t cellRowEnd)
     {
-        for (int x = x0 - horizontalRadius; x <= x0 + horizontalRadius; ++x)
+        for (size_t cellRow = cellRowBegin; cellRow < cellRowEnd; ++cellRow)
         {
-            if (!valueInBoundaries(y, -1, static_cast<int>(pixels           .size())) || 
-                !valueInBoundaries(x, -1, static_cast<int>(pixels[(size_t)y].size())))
-                continue;
+            size_t top    = cellRow * cellSize;
+            size_t bottom = std::min(top + cellSize, pixels.size());
 
-            divider++;
+            for (size_t left = 0; left < table.getWidth(); left += cellSize)
+            {
+                size_t right = std::min(left + cellSize, table.getWidth());
 
-            resultR += static_cast<int>(pixels[(size_t)y][(size_t)x].r);
-            resultB += static_cast<int>(pixels[(size_t)y][(size_t)x].b);
-            resultG += static_cast<int>(pixels[(size_t)y][(size_t)x].g);
-            resultA += static_cast<int>(pixels[(size_t)y][(size_t)x].a);
-        }
-    }
+                Color mean = table.rectMean(static_cast<int>(left), static_cast<int>(top),
+                                            static_cast<int>(right), static_cast<int>(bottom));
 
-    assert(divider > 0);
+                for (size_t y = top; y < bottom; ++y)
+                    std::fill(mosaic[y].begin() + static_cast<long>(left),
+                              mosaic[y].begin() + static_cast<long>(right), mean);
+            }
+        }
+    });
 
-    return Color{static_cast<uint8_t>(resultR / divider), 
-                 static_cast<uint8_t>(resultG / divider), 
-                 static_cast<uint8_t>(resultB / divider), 
-                 static_cast<uint8_t>(resultA / divider)};
+    return mosaic;
 }
 
-
-std::vector<std::vector<Color>> getBoxBlured(const std::vector<std::vector<Color>>& pixels,
-                                             int horizontalRadius, int verticalRadius)
+std::vector<std::vector<Color>> getAdaptiveThreshold(const std::vector<std::vector<Color>>& pixels,
+                                                     int radius, int offset)
 {
-    std::vector<std::vector<Color>> result = pixels;
+    assert(radius >= 0);
 
-    for (size_t y = 0; y < pixels.size(); ++y)
+    SummedAreaTable table(pixels);
+    std::vector<std::vector<Color>> thresholded(pixels.size(), std::vector<Color>(table.getWidth()));
+
+    // luminance of the mean is the mean of luminances
+    parallelForRows(pixels.size(), [&](size_t rowBegin, size_t rowEnd)
     {
-        for (size_t x = 0; x < pixels[y].size(); ++x)    
+        for (size_t y = rowBegin; y < rowEnd; ++y)
         {
-            result[y][x] = boxBlurPixel(pixels, static_cast<int>(x), static_cast<int>(y),
-                                        horizontalRadius, verticalRadius);
+            int top    = static_cast<int>(y) - radius;
+            int bottom = static_cast<int>(y) + radius + 1;
+
+            for (size_t x = 0; x < table.getWidth(); ++x)
+            {
+                int left  = static_cast<int>(x) - radius;
+                int right = static_cast<int>(x) + radius + 1;
+
+                int mean = getLuminance(table.rectMean(left, top, right, bottom));
+                uint8_t value = getLuminance(pixels[y][x]) > mean - offset ? 255 : 0;
+
+                thresholded[y][x] = Color{value, value, value, pixels[y][x].a};
+            }
         }
-    }
+    });
 
-    return result;
+    return thresholded;
 }
 
-std::vector<std::vector<Color>> getUnsharpMasked(const std::vector<std::vector<Color>>& pixels)
+std::vector<std::vector<Color>> getUnsharpMasked(const std::vector<std::vector<Color>>& pixels,
+                                                 float amount, float radius, int threshold)
 {
-    std::vector<std::vector<Color>> result = pixels;
-    std::vector<std::vector<Color>> blured = getBoxBlured(pixels, 1, 1);
+    assert(amount >= 0.f);
+    assert(threshold >= 0);
+
+    std::vector<std::vector<Color>> sharpened = pixels;
 
-    for (size_t y = 0; y < pixels.size(); ++y)
+    // amount in 8-bit fixed point
+    const int gain = static_cast<int>(std::lround(amount / 100.f * 256.f));
+
+    auto sharpen = [gain, threshold](uint8_t channel, uint8_t blurred)
     {
-        for (size_t x = 0; x < pixels[y].size(); ++x)
+        int difference = channel - blurred;
+        if (std::abs(difference) < threshold)
+            return channel;
+
+        return static_cast<uint8_t>(std::clamp(channel + difference * gain / 256, 0, 255));
+    };
+
+    blurGaussian(pixels, radius, [&](size_t y, size_t xBegin, const Color* blurred, size_t count)
+    {
+        Color* row = sharpened[y].data() + xBegin;
+
+        for (size_t i = 0; i < count; ++i)
         {
-            int red = 0, green = 0, blue = 0, alpha = 0;
+            row[i].r = sharpen(row[i].r, blurred[i].r);
+            row[i].g = sharpen(row[i].g, blurred[i].g);
+            row[i].b = sharpen(row[i].b, blurred[i].b);
+        }
+    });
 
-            Color bluredColor = blured[y][x];
-            Color sourceColor = pixels[y][x];
-            Color resultColor{};
+    return sharpened;
+}
+
+std::vector<std::vector<Color>> getDownscaled(const std::vector<std::vector<Color>>& pixels, unsigned factor)
+{
+    assert(factor > 0);
+
+    size_t ySize = pixels.size();
+    size_t xSize = ySize > 0 ? pixels[0].size() : 0;
 
-            red   = 3 * (int)sourceColor.r - 2 * (int)bluredColor.r;
-            green = 3 * (int)sourceColor.g - 2 * (int)bluredColor.g;
-            blue  = 3 * (int)sourceColor.b - 2 * (int)bluredColor.b;
-            alpha = 3 * (int)sourceColor.a - 2 * (int)bluredColor.a;
+    if (factor == 1 || xSize == 0)
+        return pixels;
 
-            resultColor.r = (uint8_t)std::clamp(red, 0, 255);
-            resultColor.b = (uint8_t)std::clamp(blue, 0, 255);
-            resultColor.g = (uint8_t)std::clamp(green, 0, 255);
-            resultColor.a = (uint8_t)std::clamp(alpha, 0, 255);
+    size_t yScaledSize = (ySize + factor - 1) / factor;
+    size_t xScaledSize = (xSize + factor - 1) / factor;
 
-            result[y][x] = resultColor;
+    std::vector<std::vector<Color>> result(yScaledSize, std::vector<Color>(xScaledSize));
+
+    parallelForRows(yScaledSize, [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t yScaled = rowBegin; yScaled < rowEnd; ++yScaled)
+        {
+            size_t yEnd = std::min((yScaled + 1) * factor, ySize);
+
+            for (size_t xScaled = 0; xScaled < xScaledSize; ++xScaled)
+            {
+                size_t xEnd = std::min((xScaled + 1) * factor, xSize);
+
+                unsigned red = 0, green = 0, blue = 0, alpha = 0;
+                unsigned divider = 0;
+
+                for (size_t y = yScaled * factor; y < yEnd; ++y)
+                {
+                    for (size_t x = xScaled * factor; x < xEnd; ++x)
+                    {
+                        red   += pixels[y][x].r;
+                        green += pixels[y][x].g;
+                        blue  += pixels[y][x].b;
+                        alpha += pixels[y][x].a;
+
+                        divider++;
+                    }
+                }
+
+                result[yScaled][xScaled] = Color{static_cast<uint8_t>(red   / divider), 
+                                                 static_cast<uint8_t>(green / divider), 
+                                                 static_cast<uint8_t>(blue  / divider), 
+                                                 static_cast<uint8_t>(alpha / divider)};
+            }
         }
-    }
+    });
 
     return result;
 }
@@ -5,7 +5,12 @@
 #include "api/api_system.hpp"
 
 #include "pluginLib/bars/ps_bar.hpp"
+#include "pluginLib/filters/filterJobs.hpp"
+#include "pluginLib/filters/tiledLayerFilter.hpp"
 
+#include <functional>
+#include <memory>
+#include <string>
 #include <vector>
 
 namespace ps
@@ -14,35 +19,70 @@ namespace ps
 using namespace psapi;
 using namespace psapi::sfm;
 
-class FilterAction : public ANamedBarButton
-{
-public:
-    
-};
-
+// Applies filter to the whole active layer in background, shows progress in the name while running.
+// halo - how many pixels around a pixel the filter reads.
 class FilterButton : public ANamedBarButton
 {
 public:
-    FilterButton(std::unique_ptr<IText> name, std::unique_ptr<IFont> font,
-                 std::unique_ptr<IAction> filterAction);
+    using Filter = std::function<std::vector<std::vector<Color>>(const std::vector<std::vector<Color>>& pixels)>;
+
+    // filter is made when the button is pressed, e.g. from statistics of the layer
+    using FilterFactory = std::function<Filter(const ICanvas* canvas, size_t layerIndex)>;
+
+    FilterButton(std::unique_ptr<IText> name, std::unique_ptr<IFont> font, const std::string& title,
+                 size_t halo, Filter filter);
+
+    FilterButton(std::unique_ptr<IText> name, std::unique_ptr<IFont> font, const std::string& title,
+                 size_t halo, FilterFactory filterFactory);
 
     std::unique_ptr<IAction> createAction(const IRenderWindow* renderWindow, 
                                           const Event& event) override;
     
     bool update(const IRenderWindow* renderWindow, const Event& event);
+    void draw(IRenderWindow* renderWindow) override;
 
 private:
-    std::unique_ptr<IAction> filterAction_;
+    std::string title_;
+    size_t halo_;
+    FilterFactory filterFactory_;
+
+    std::shared_ptr<TiledLayerFilter> run_;
 };
 
+// name with percents of the run, plain name if it is not running
+std::string getJobTitle(const std::string& title, const TiledLayerFilter* run);
+
 std::vector<std::vector<Color>> getNegative (const std::vector<std::vector<Color>>& pixels);
-std::vector<std::vector<Color>> getBasRelief(const std::vector<std::vector<Color>>& pixels, 
-                                             const std::vector<std::vector<Color>>& negative);
+std::vector<std::vector<Color>> getBasRelief(const std::vector<std::vector<Color>>& pixels);
+
+enum class BoxBlurMethod
+{
+    Auto,            // summed area table for radii above kBoxBlurSatRadius
+    Separable,       // edges are clamped, cost grows with radius
+    SummedAreaTable, // windows are cut by the edges, constant cost per pixel
+};
+
+const int kBoxBlurSatRadius = 4;
 
 std::vector<std::vector<Color>> getBoxBlured(const std::vector<std::vector<Color>>& pixels,
-                                             int horizontalRadius, int verticalRadius);
+                                             int horizontalRadius, int verticalRadius,
+                                             BoxBlurMethod method = BoxBlurMethod::Auto);
+
+// every cellSize x cellSize cell starting from the top left corner is filled with its average
+std::vector<std::vector<Color>> getMosaic(const std::vector<std::vector<Color>>& pixels, size_t cellSize);
+
+// white where luminance is above the mean luminance of the (2 * radius + 1) window minus offset,
+// black elsewhere, alpha is kept
+std::vector<std::vector<Color>> getAdaptiveThreshold(const std::vector<std::vector<Color>>& pixels,
+                                                     int radius, int offset);
+
+// pixel + amount% * (pixel - gaussian blur with sigma radius), channels that differ from the blur by less
+// than threshold are kept. Sharpening is fused into the last blur pass, alpha is kept.
+std::vector<std::vector<Color>> getUnsharpMasked(const std::vector<std::vector<Color>>& pixels,
+                                                 float amount, float radius, int threshold);
 
-std::vector<std::vector<Color>> getUnsharpMasked(const std::vector<std::vector<Color>>& pixels);
+// box averaged copy, each side is divided by factor (rounding up)
+std::vector<std::vector<Color>> getDownscaled(const std::vector<std::vector<Color>>& pixels, unsigned factor);
 
 } // namespace ps
 
@@ -0,0 +1,284 @@
+#include "gaussianBlur.hpp"
+
+#include "pluginLib/filters/filterExecutor.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+namespace ps
+{
+
+namespace
+{
+
+const size_t kBoxesCount = 3;
+
+// columns blurred together by the vertical passes, their sums stay in cache
+const size_t kColumnsBlock = 64;
+
+// Rows are blurred in bands of at least this many output rows, at least 4 reaches high, so the
+// horizontally blurred rows read around the band add at most half of the band to the work
+const size_t kMinBandRows      = 64;
+const size_t kBandRowsPerReach = 4;
+
+struct ChannelsSum
+{
+    int r = 0;
+    int g = 0;
+    int b = 0;
+    int a = 0;
+
+    void add(Color color)
+    {
+        r += color.r;
+        g += color.g;
+        b += color.b;
+        a += color.a;
+    }
+
+    void subtract(Color color)
+    {
+        r -= color.r;
+        g -= color.g;
+        b -= color.b;
+        a -= color.a;
+    }
+
+    Color getMean(int size) const
+    {
+        int half = size / 2;
+
+        return Color{static_cast<uint8_t>((r + half) / size), static_cast<uint8_t>((g + half) / size),
+                     static_cast<uint8_t>((b + half) / size), static_cast<uint8_t>((a + half) / size)};
+    }
+};
+
+size_t clampIndex(long long index, size_t size)
+{
+    return static_cast<size_t>(std::clamp(index, 0ll, static_cast<long long>(size) - 1));
+}
+
+// line of count pixels, stride apart, window of 2 * radius + 1 slides along it
+void boxBlurLine(const Color* source, Color* destination, size_t count, size_t stride, size_t radius)
+{
+    if (radius == 0)
+    {
+        for (size_t i = 0; i < count; ++i)
+            destination[i * stride] = source[i * stride];
+
+        return;
+    }
+
+    const int size = static_cast<int>(2 * radius + 1);
+    const long long signedRadius = static_cast<long long>(radius);
+
+    ChannelsSum sum;
+    for (long long k = -signedRadius; k <= signedRadius; ++k)
+        sum.add(source[clampIndex(k, count) * stride]);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        destination[i * stride] = sum.getMean(size);
+
+        long long position = static_cast<long long>(i);
+        sum.add     (source[clampIndex(position + signedRadius + 1, count) * stride]);
+        sum.subtract(source[clampIndex(position - signedRadius,     count) * stride]);
+    }
+}
+
+// width columns of the block go down together, sums[x] is the window of column x
+void boxBlurColumns(const Color* source, Color* destination, size_t width, size_t height, size_t radius,
+                    std::vector<ChannelsSum>& sums)
+{
+    if (radius == 0)
+    {
+        std::copy(source, source + width * height, destination);
+        return;
+    }
+
+    const int size = static_cast<int>(2 * radius + 1);
+    const long long signedRadius = static_cast<long long>(radius);
+
+    sums.assign(width, ChannelsSum{});
+
+    for (long long k = -signedRadius; k <= signedRadius; ++k)
+    {
+        const Color* row = source + clampIndex(k, height) * width;
+
+        for (size_t x = 0; x < width; ++x)
+            sums[x].add(row[x]);
+    }
+
+    for (size_t y = 0; y < height; ++y)
+    {
+        long long position = static_cast<long long>(y);
+
+        const Color* entering = source + clampIndex(position + signedRadius + 1, height) * width;
+        const Color* leaving  = source + clampIndex(position - signedRadius,     height) * width;
+        Color* row = destination + y * width;
+
+        for (size_t x = 0; x < width; ++x)
+        {
+            row[x] = sums[x].getMean(size);
+
+            sums[x].add(entering[x]);
+            sums[x].subtract(leaving[x]);
+        }
+    }
+}
+
+} // namespace anonymous
+
+// Box sizes are the ones whose variances add up closest to sigma^2 (W. Jarosz, "Fast Image Convolutions")
+std::array<size_t, 3> getGaussianBoxRadii(float sigma)
+{
+    std::array<size_t, kBoxesCount> radii = {0, 0, 0};
+
+    if (sigma <= 0.f)
+        return radii;
+
+    const float boxesCount = static_cast<float>(kBoxesCount);
+    const float variance12 = 12.f * sigma * sigma;
+
+    int lower = static_cast<int>(std::floor(std::sqrt(variance12 / boxesCount + 1.f)));
+    if (lower % 2 == 0)
+        --lower;
+
+    const float lowerWidth = static_cast<float>(lower);
+    float lowerCount = (variance12 - boxesCount * lowerWidth * lowerWidth - 4.f * boxesCount * lowerWidth -
+                        3.f * boxesCount) / (-4.f * lowerWidth - 4.f);
+
+    long boxesOfLowerWidth = std::clamp(std::lround(lowerCount), 0l, static_cast<long>(kBoxesCount));
+
+    for (size_t i = 0; i < kBoxesCount; ++i)
+    {
+        int width = static_cast<long>(i) < boxesOfLowerWidth ? lower : lower + 2;
+        radii[i] = static_cast<size_t>((width - 1) / 2);
+    }
+
+    return radii;
+}
+
+size_t getGaussianReach(float sigma)
+{
+    std::array<size_t, kBoxesCount> radii = getGaussianBoxRadii(sigma);
+
+    return radii[0] + radii[1] + radii[2];
+}
+
+namespace
+{
+
+// Output rows [top, bottom) of the band, horizontally blurred rows [first, last) around them go to
+// horizontal. Rows of the band are exact: the vertical passes reach at most top - first and last - bottom
+// rows from them, and at the image edges first and last are clamped as the whole image is.
+bool blurBand(const Pixels2D& pixels, const std::array<size_t, kBoxesCount>& radii, size_t first, size_t last,
+              size_t top, size_t bottom, Pixels2D& horizontal, const BlurredSpanConsumer& consumer)
+{
+    const size_t width  = pixels[0].size();
+    const size_t height = last - first;
+
+    horizontal.resize(height);
+
+    bool isFinished = parallelForRows(height, [&](size_t rowBegin, size_t rowEnd)
+    {
+        std::vector<Color> buffer(width);
+
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+        {
+            std::vector<Color>& row = horizontal[y];
+            row = pixels[first + y];
+
+            for (size_t radius : radii)
+            {
+                boxBlurLine(row.data(), buffer.data(), width, 1, radius);
+                row.swap(buffer);
+            }
+        }
+    });
+
+    if (!isFinished)
+        return false;
+
+    const size_t blocksCount = (width + kColumnsBlock - 1) / kColumnsBlock;
+
+    return parallelForRows(blocksCount, [&](size_t blockBegin, size_t blockEnd)
+    {
+        std::vector<Color> block;
+        std::vector<Color> buffer;
+        std::vector<ChannelsSum> sums;
+
+        for (size_t blockIndex = blockBegin; blockIndex < blockEnd; ++blockIndex)
+        {
+            size_t xBegin = blockIndex * kColumnsBlock;
+            size_t blockWidth = std::min(kColumnsBlock, width - xBegin);
+
+            block.resize(blockWidth * height);
+            buffer.resize(blockWidth * height);
+
+            for (size_t y = 0; y < height; ++y)
+            {
+                const Color* row = horizontal[y].data() + xBegin;
+                std::copy(row, row + blockWidth, block.data() + y * blockWidth);
+            }
+
+            for (size_t radius : radii)
+            {
+                boxBlurColumns(block.data(), buffer.data(), blockWidth, height, radius, sums);
+                block.swap(buffer);
+            }
+
+            for (size_t y = top; y < bottom; ++y)
+                consumer(y, xBegin, block.data() + (y - first) * blockWidth, blockWidth);
+        }
+    });
+}
+
+} // namespace anonymous
+
+// Bands go one after another and are split between the threads inside, so only one band of
+// horizontally blurred rows is alive, not a blurred copy of the whole image
+void blurGaussian(const Pixels2D& pixels, float sigma, const BlurredSpanConsumer& consumer)
+{
+    assert(consumer);
+
+    size_t height = pixels.size();
+    size_t width  = height > 0 ? pixels[0].size() : 0;
+
+    if (width == 0)
+        return;
+
+    const std::array<size_t, kBoxesCount> radii = getGaussianBoxRadii(sigma);
+
+    const size_t reach    = radii[0] + radii[1] + radii[2];
+    const size_t bandRows = std::max(kMinBandRows, kBandRowsPerReach * reach);
+
+    Pixels2D horizontal;
+
+    for (size_t top = 0; top < height; top += bandRows)
+    {
+        size_t bottom = std::min(top + bandRows, height);
+
+        size_t first = top > reach ? top - reach : 0;
+        size_t last  = std::min(bottom + reach, height);
+
+        if (!blurBand(pixels, radii, first, last, top, bottom, horizontal, consumer))
+            return;
+    }
+}
+
+Pixels2D getGaussianBlured(const Pixels2D& pixels, float sigma)
+{
+    Pixels2D blured(pixels.size(), std::vector<Color>(pixels.empty() ? 0 : pixels[0].size()));
+
+    blurGaussian(pixels, sigma, [&](size_t y, size_t xBegin, const Color* blurred, size_t count)
+    {
+        std::copy(blurred, blurred + count, blured[y].begin() + static_cast<long>(xBegin));
+    });
+
+    return blured;
+}
+
+} // namespace ps
@@ -0,0 +1,32 @@
+#ifndef PLUGINS_PLUGIN_LIB_FILTERS_GAUSSIAN_BLUR_HPP
+#define PLUGINS_PLUGIN_LIB_FILTERS_GAUSSIAN_BLUR_HPP
+
+#include "pluginLib/filters/filterGraph.hpp"
+
+#include <array>
+#include <cstddef>
+#include <functional>
+
+namespace ps
+{
+
+// Gaussian is approximated by three box blurs in each direction, every box is a running sum,
+// so the cost per pixel doesn't depend on sigma. Edges are clamped, alpha is blurred too.
+std::array<size_t, 3> getGaussianBoxRadii(float sigma);
+
+// how many pixels around a pixel the blur reads
+size_t getGaussianReach(float sigma);
+
+Pixels2D getGaussianBlured(const Pixels2D& pixels, float sigma);
+
+// Called from worker threads with count blurred pixels of row y starting from column xBegin.
+// Every pixel is handed over exactly once.
+using BlurredSpanConsumer = std::function<void(size_t y, size_t xBegin, const Color* blurred, size_t count)>;
+
+// The last pass hands blurred pixels over instead of storing them, so filters built on top of the blur
+// don't keep the blurred copy of the image
+void blurGaussian(const Pixels2D& pixels, float sigma, const BlurredSpanConsumer& consumer);
+
+} // namespace ps
+
+#endif // PLUGINS_PLUGIN_LIB_FILTERS_GAUSSIAN_BLUR_HPP
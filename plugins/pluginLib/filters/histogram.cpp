@@ -0,0 +1,236 @@
+#include "histogram.hpp"
+
+#include "pluginLib/canvas/canvas.hpp"
+#include "pluginLib/canvas/versionedLayer.hpp"
+#include "pluginLib/filters/filterExecutor.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <mutex>
+
+namespace ps
+{
+
+namespace
+{
+
+void addChannel(std::array<uint32_t, 256>& sum, const std::array<uint32_t, 256>& other)
+{
+    for (size_t i = 0; i < sum.size(); ++i)
+        sum[i] += other[i];
+}
+
+// row of pixels that starts at rowX, only [begin, end) of it is counted
+void addRow(Histogram& histogram, const std::vector<Color>& row, int rowX, int begin, int end)
+{
+    begin = std::max(begin, rowX);
+    end   = std::min(end,   rowX + static_cast<int>(row.size()));
+
+    for (int x = begin; x < end; ++x)
+        histogram.add(row[static_cast<size_t>(x - rowX)]);
+}
+
+void addMaskedRow(Histogram& histogram, const std::vector<Color>& row, int rowX, const SelectionSpans& spans)
+{
+    for (const SelectionSpan& span : spans)
+        addRow(histogram, row, rowX, span.begin, span.end);
+}
+
+template <typename CountRow>
+Histogram computeHistogram(size_t rowsCount, CountRow countRow)
+{
+    Histogram total;
+    std::mutex totalMutex;
+
+    parallelForRows(rowsCount, [&](size_t rowBegin, size_t rowEnd)
+    {
+        Histogram partial;
+
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+            countRow(partial, y);
+
+        std::lock_guard<std::mutex> lock(totalMutex);
+        total += partial;
+    });
+
+    return total;
+}
+
+IntRect getTileRect(size_t tileX, size_t tileY, const vec2u& fullSize)
+{
+    unsigned left = static_cast<unsigned>(tileX) * kLayerTileSize;
+    unsigned top  = static_cast<unsigned>(tileY) * kLayerTileSize;
+
+    return IntRect{vec2i{static_cast<int>(left), static_cast<int>(top)},
+                   vec2u{std::min(kLayerTileSize, fullSize.x - left), std::min(kLayerTileSize, fullSize.y - top)}};
+}
+
+} // namespace anonymous
+
+// Histogram implementation
+
+void Histogram::add(Color color)
+{
+    ++r[color.r];
+    ++g[color.g];
+    ++b[color.b];
+    ++luminance[getLuminance(color)];
+
+    ++count;
+}
+
+Histogram& Histogram::operator+=(const Histogram& other)
+{
+    addChannel(r, other.r);
+    addChannel(g, other.g);
+    addChannel(b, other.b);
+    addChannel(luminance, other.luminance);
+
+    count += other.count;
+
+    return *this;
+}
+
+Histogram computeHistogram(const Pixels2D& pixels)
+{
+    return computeHistogram(pixels.size(), [&](Histogram& histogram, size_t y)
+    {
+        for (Color color : pixels[y])
+            histogram.add(color);
+    });
+}
+
+Histogram computeHistogram(const Pixels2D& pixels, const vec2i& pos, const SelectionMask& mask)
+{
+    return computeHistogram(pixels.size(), [&](Histogram& histogram, size_t y)
+    {
+        addMaskedRow(histogram, pixels[y], pos.x, mask.getRow(pos.y + static_cast<int>(y)));
+    });
+}
+
+// Layer histogram implementation
+
+const Histogram& LayerHistogram::update(const ILayer* layer, const vec2u& screenSize, const Selection& selection)
+{
+    assert(layer);
+
+    vec2u fullSize = getLayerFullSize(layer, screenSize);
+
+    auto versionedLayer = dynamic_cast<const IVersionedLayer*>(layer);
+    if (!versionedLayer)
+    {
+        clear();
+
+        IntRect rect{vec2i{0, 0}, fullSize};
+        total_ = selection.isActive() ? computeHistogram(getLayerRegion(layer, rect), rect.pos, selection.getMask())
+                                      : computeHistogram(getLayerRegion(layer, rect));
+
+        return total_;
+    }
+
+    size_t tilesX = (fullSize.x + kLayerTileSize - 1) / kLayerTileSize;
+    size_t tilesY = (fullSize.y + kLayerTileSize - 1) / kLayerTileSize;
+
+    bool sameSelection = isSelectionActive_ == selection.isActive() && 
+                         (!isSelectionActive_ || selectionMask_ == selection.getMask());
+
+    if (layerId_ != versionedLayer->getLayerId() || fullSize_.x != fullSize.x || fullSize_.y != fullSize.y ||
+        !sameSelection)
+    {
+        layerId_  = versionedLayer->getLayerId();
+        fullSize_ = fullSize;
+
+        isSelectionActive_ = selection.isActive();
+        selectionMask_     = selection.getMask();
+
+        tileVersions_.assign(tilesX * tilesY, kNotCounted);
+        tiles_.assign(tilesX * tilesY, Histogram{});
+    }
+
+    std::vector<size_t> dirtyTiles;
+
+    for (size_t i = 0; i < tileVersions_.size(); ++i)
+    {
+        uint64_t version = versionedLayer->getTileVersion(vec2u{static_cast<unsigned>(i % tilesX), 
+                                                                static_cast<unsigned>(i / tilesX)});
+
+        if (tileVersions_[i] != version)
+        {
+            tileVersions_[i] = version;
+            dirtyTiles.push_back(i);
+        }
+    }
+
+    // tiles are independent, every one is counted into its own histogram;
+    // layer is not changed until update returns, so it can be read from the workers
+    parallelForRows(dirtyTiles.size(), [&](size_t tileBegin, size_t tileEnd)
+    {
+        for (size_t i = tileBegin; i < tileEnd; ++i)
+        {
+            size_t tile = dirtyTiles[i];
+            IntRect rect = getTileRect(tile % tilesX, tile / tilesX, fullSize_);
+
+            Histogram& histogram = tiles_[tile];
+            histogram = Histogram{};
+
+            if (isSelectionActive_ && (rect.pos.y >= selectionMask_.getBottom() ||
+                                       rect.pos.y + static_cast<int>(rect.size.y) <= selectionMask_.getTop()))
+                continue;
+
+            Pixels2D pixels = getLayerRegion(layer, rect);
+
+            for (size_t y = 0; y < pixels.size(); ++y)
+            {
+                if (isSelectionActive_)
+                    addMaskedRow(histogram, pixels[y], rect.pos.x, 
+                                 selectionMask_.getRow(rect.pos.y + static_cast<int>(y)));
+                else
+                    addRow(histogram, pixels[y], rect.pos.x, rect.pos.x, rect.pos.x + static_cast<int>(rect.size.x));
+            }
+        }
+    });
+
+    total_ = Histogram{};
+    for (const Histogram& tile : tiles_)
+        total_ += tile;
+
+    return total_;
+}
+
+void LayerHistogram::clear()
+{
+    layerId_ = 0;
+    fullSize_ = vec2u{0, 0};
+
+    isSelectionActive_ = false;
+    selectionMask_ = SelectionMask{};
+
+    tileVersions_.clear();
+    tiles_.clear();
+}
+
+ChannelsLut makeAutoContrastLut(const Histogram& histogram, float clipFraction)
+{
+    assert(clipFraction >= 0 && clipFraction < 0.5f);
+
+    std::array<uint64_t, 256> combined{};
+    for (size_t i = 0; i < combined.size(); ++i)
+        combined[i] = static_cast<uint64_t>(histogram.r[i]) + histogram.g[i] + histogram.b[i];
+
+    uint64_t clipped = static_cast<uint64_t>(clipFraction * 3.f * static_cast<float>(histogram.count));
+
+    size_t black = 0;
+    for (uint64_t sum = 0; black < 255 && (sum += combined[black]) <= clipped; ++black)
+        ;
+
+    size_t white = 255;
+    for (uint64_t sum = 0; white > 0 && (sum += combined[white]) <= clipped; --white)
+        ;
+
+    if (histogram.count == 0 || black >= white)
+        return ChannelsLut::identity();
+
+    return makeLevelsLut(static_cast<uint8_t>(black), static_cast<uint8_t>(white), 1.f);
+}
+
+} // namespace ps
@@ -0,0 +1,70 @@
+#ifndef PLUGINS_PLUGIN_LIB_FILTERS_HISTOGRAM_HPP
+#define PLUGINS_PLUGIN_LIB_FILTERS_HISTOGRAM_HPP
+
+#include "api/api_canvas.hpp"
+
+#include "pluginLib/filters/filterGraph.hpp"
+#include "pluginLib/selection/selection.hpp"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace ps
+{
+
+using namespace psapi;
+using namespace psapi::sfm;
+
+struct Histogram
+{
+    std::array<uint32_t, 256> r{};
+    std::array<uint32_t, 256> g{};
+    std::array<uint32_t, 256> b{};
+    std::array<uint32_t, 256> luminance{};
+
+    uint32_t count = 0;
+
+    void add(Color color);
+
+    Histogram& operator+=(const Histogram& other);
+};
+
+// Every band of rows is counted into its own histogram, they are summed at the end
+Histogram computeHistogram(const Pixels2D& pixels);
+
+// only pixels of the mask, pos - position of pixels in the full layer
+Histogram computeHistogram(const Pixels2D& pixels, const vec2i& pos, const SelectionMask& mask);
+
+// Histogram of the whole layer or of its selected part. Keeps histograms of the layer tiles,
+// so after a change only the tiles changed since the previous update are counted again.
+// Layers without versions are counted from scratch every time.
+class LayerHistogram
+{
+public:
+    // pixels of the feathered edge are counted if they are inside the selection mask
+    const Histogram& update(const ILayer* layer, const vec2u& screenSize, const Selection& selection);
+
+    void clear();
+
+private:
+    static constexpr uint64_t kNotCounted = static_cast<uint64_t>(-1);
+
+    uint64_t layerId_ = 0;
+    vec2u fullSize_;
+    bool isSelectionActive_ = false;
+    SelectionMask selectionMask_;
+
+    std::vector<uint64_t> tileVersions_; // versions the tiles were counted at, row by row
+    std::vector<Histogram> tiles_;
+
+    Histogram total_;
+};
+
+// Levels that stretch the darkest and the brightest values to black and white. Channels are stretched
+// equally, so colors don't shift. clipFraction - part of the darkest and of the brightest values ignored.
+ChannelsLut makeAutoContrastLut(const Histogram& histogram, float clipFraction);
+
+} // namespace ps
+
+#endif // PLUGINS_PLUGIN_LIB_FILTERS_HISTOGRAM_HPP
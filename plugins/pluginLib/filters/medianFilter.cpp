@@ -0,0 +1,274 @@
+#include "medianFilter.hpp"
+
+#include "pluginLib/filters/convolution.hpp"
+#include "pluginLib/filters/filterExecutor.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+
+namespace ps
+{
+
+namespace
+{
+
+// Two level histograms: coarse bin is the high nibble of the value, fine bin is the value itself.
+// Median is searched in the coarse histogram first, so only one fine segment of 16 bins
+// has to be kept up to date in the window histogram.
+const size_t kCoarseBins    = 16;
+const size_t kFineBins      = 256;
+const size_t kFinePerCoarse = kFineBins / kCoarseBins;
+
+const size_t kChannelsCount = 3;
+
+uint8_t getChannel(Color color, size_t channel)
+{
+    switch (channel)
+    {
+        case 0:  return color.r;
+        case 1:  return color.g;
+        default: return color.b;
+    }
+}
+
+void setChannel(Color& color, size_t channel, uint8_t value)
+{
+    switch (channel)
+    {
+        case 0:  color.r = value; break;
+        case 1:  color.g = value; break;
+        default: color.b = value; break;
+    }
+}
+
+// histograms of the (2 * radius + 1) tall column above and below the current row, one per padded column
+struct ColumnHistograms
+{
+    std::vector<uint16_t> coarse; // x * kCoarseBins + bin
+    std::vector<uint16_t> fine;   // x * kFineBins + bin
+
+    explicit ColumnHistograms(size_t width) : coarse(width * kCoarseBins), fine(width * kFineBins) {}
+
+    const uint16_t* getCoarse(size_t x) const { return coarse.data() + x * kCoarseBins; }
+
+    const uint16_t* getFine(size_t x, size_t coarseBin) const
+    {
+        return fine.data() + x * kFineBins + coarseBin * kFinePerCoarse;
+    }
+};
+
+using ChannelsColumns = std::array<ColumnHistograms, kChannelsCount>;
+
+template <bool IsAdding>
+void updateColumns(ChannelsColumns& columns, const std::vector<Color>& row)
+{
+    for (size_t x = 0; x < row.size(); ++x)
+    {
+        for (size_t channel = 0; channel < kChannelsCount; ++channel)
+        {
+            uint8_t value = getChannel(row[x], channel);
+
+            uint16_t& coarse = columns[channel].coarse[x * kCoarseBins + value / kFinePerCoarse];
+            uint16_t& fine   = columns[channel].fine  [x * kFineBins   + value];
+
+            if (IsAdding)
+            {
+                ++coarse;
+                ++fine;
+            }
+            else
+            {
+                --coarse;
+                --fine;
+            }
+        }
+    }
+}
+
+// Window histogram sliding along the row. Fine segments are updated lazily: only when the median
+// falls into them, by the columns that passed since the last update or from scratch if it is cheaper.
+class WindowHistogram
+{
+public:
+    WindowHistogram(const ColumnHistograms& columns, size_t radius)
+        : columns_(columns), diameter_(2 * radius + 1), medianRank_(diameter_ * diameter_ / 2)
+    {
+        coarse_.fill(0);
+        fine_.fill(0);
+        fineUpdatedAt_.fill(kNotUpdated);
+
+        for (size_t x = 0; x < diameter_; ++x)
+        {
+            const uint16_t* column = columns_.getCoarse(x);
+
+            for (size_t bin = 0; bin < kCoarseBins; ++bin)
+                coarse_[bin] = static_cast<uint16_t>(coarse_[bin] + column[bin]);
+        }
+    }
+
+    // window of output x covers padded columns [x, x + diameter)
+    void moveTo(size_t x)
+    {
+        assert(x > 0);
+
+        const uint16_t* added   = columns_.getCoarse(x + diameter_ - 1);
+        const uint16_t* removed = columns_.getCoarse(x - 1);
+
+        for (size_t bin = 0; bin < kCoarseBins; ++bin)
+            coarse_[bin] = static_cast<uint16_t>(coarse_[bin] + added[bin] - removed[bin]);
+
+        x_ = x;
+    }
+
+    uint8_t getMedian()
+    {
+        size_t count = 0;
+        size_t coarseBin = 0;
+
+        while (count + coarse_[coarseBin] <= medianRank_)
+            count += coarse_[coarseBin++];
+
+        assert(coarseBin < kCoarseBins);
+
+        updateFine(coarseBin);
+
+        uint16_t* fine = fine_.data() + coarseBin * kFinePerCoarse;
+        size_t fineBin = 0;
+
+        while (count + fine[fineBin] <= medianRank_)
+            count += fine[fineBin++];
+
+        assert(fineBin < kFinePerCoarse);
+
+        return static_cast<uint8_t>(coarseBin * kFinePerCoarse + fineBin);
+    }
+
+private:
+    void updateFine(size_t coarseBin)
+    {
+        uint16_t* fine = fine_.data() + coarseBin * kFinePerCoarse;
+        size_t updatedAt = fineUpdatedAt_[coarseBin];
+
+        if (updatedAt == kNotUpdated || x_ - updatedAt >= diameter_)
+        {
+            std::fill(fine, fine + kFinePerCoarse, 0);
+
+            for (size_t x = x_; x < x_ + diameter_; ++x)
+                addFine(fine, columns_.getFine(x, coarseBin));
+        }
+        else
+        {
+            for (size_t x = updatedAt + 1; x <= x_; ++x)
+            {
+                addFine     (fine, columns_.getFine(x + diameter_ - 1, coarseBin));
+                subtractFine(fine, columns_.getFine(x - 1,             coarseBin));
+            }
+        }
+
+        fineUpdatedAt_[coarseBin] = x_;
+    }
+
+    static void addFine(uint16_t* fine, const uint16_t* column)
+    {
+        for (size_t bin = 0; bin < kFinePerCoarse; ++bin)
+            fine[bin] = static_cast<uint16_t>(fine[bin] + column[bin]);
+    }
+
+    static void subtractFine(uint16_t* fine, const uint16_t* column)
+    {
+        for (size_t bin = 0; bin < kFinePerCoarse; ++bin)
+            fine[bin] = static_cast<uint16_t>(fine[bin] - column[bin]);
+    }
+
+private:
+    static constexpr size_t kNotUpdated = static_cast<size_t>(-1);
+
+    const ColumnHistograms& columns_;
+
+    size_t diameter_;
+    size_t medianRank_;
+    size_t x_ = 0;
+
+    std::array<uint16_t, kCoarseBins> coarse_;
+    std::array<uint16_t, kFineBins>   fine_;
+    std::array<size_t,   kCoarseBins> fineUpdatedAt_;
+};
+
+size_t getClampedRow(long long row, size_t height)
+{
+    return static_cast<size_t>(std::clamp(row, 0ll, static_cast<long long>(height) - 1));
+}
+
+// Column histograms are built once per band from 2 * radius + 1 rows and then slide down by one row.
+// Every thread gets one band, so the setup is done once per thread and doesn't grow the cost per pixel.
+void filterBand(const Pixels2D& pixels, const Pixels2D& padded, Pixels2D& result, size_t radius,
+                size_t rowBegin, size_t rowEnd)
+{
+    size_t height = pixels.size();
+    size_t width  = pixels[0].size();
+
+    long long signedRadius = static_cast<long long>(radius);
+
+    ChannelsColumns columns = {ColumnHistograms(padded[0].size()), ColumnHistograms(padded[0].size()),
+                               ColumnHistograms(padded[0].size())};
+
+    for (long long dy = -signedRadius; dy <= signedRadius; ++dy)
+        updateColumns<true>(columns, padded[getClampedRow(static_cast<long long>(rowBegin) + dy, height)]);
+
+    for (size_t y = rowBegin; y < rowEnd; ++y)
+    {
+        if (y > rowBegin)
+        {
+            long long row = static_cast<long long>(y);
+
+            updateColumns<false>(columns, padded[getClampedRow(row - signedRadius - 1, height)]);
+            updateColumns<true> (columns, padded[getClampedRow(row + signedRadius,     height)]);
+        }
+
+        std::vector<Color>& resultRow = result[y];
+        resultRow = pixels[y];
+
+        for (size_t channel = 0; channel < kChannelsCount; ++channel)
+        {
+            WindowHistogram window(columns[channel], radius);
+
+            for (size_t x = 0; x < width; ++x)
+            {
+                if (x > 0)
+                    window.moveTo(x);
+
+                setChannel(resultRow[x], channel, window.getMedian());
+            }
+        }
+    }
+}
+
+} // namespace anonymous
+
+Pixels2D getMedianFiltered(const Pixels2D& pixels, size_t radius)
+{
+    assert(radius <= kMaxMedianRadius);
+
+    size_t height = pixels.size();
+    size_t width  = height > 0 ? pixels[0].size() : 0;
+
+    if (width == 0 || radius == 0)
+        return pixels;
+
+    Pixels2D padded = detail::padRows(pixels, radius);
+    Pixels2D result(height);
+
+    size_t threadsCount = FilterExecutor::getInstance().getThreadsCount();
+    size_t bandHeight   = std::max((height + threadsCount - 1) / threadsCount, FilterExecutor::kBandHeight);
+
+    parallelForRows(height, [&](size_t rowBegin, size_t rowEnd)
+    {
+        filterBand(pixels, padded, result, radius, rowBegin, rowEnd);
+    }, bandHeight);
+
+    return result;
+}
+
+} // namespace ps
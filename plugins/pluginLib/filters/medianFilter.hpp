@@ -0,0 +1,20 @@
+#ifndef PLUGINS_PLUGIN_LIB_FILTERS_MEDIAN_FILTER_HPP
+#define PLUGINS_PLUGIN_LIB_FILTERS_MEDIAN_FILTER_HPP
+
+#include "pluginLib/filters/filterGraph.hpp"
+
+#include <cstddef>
+
+namespace ps
+{
+
+// counts of the window histograms are 16 bit
+const size_t kMaxMedianRadius = 127;
+
+// Median of the (2 * radius + 1)^2 window in every color channel, alpha is kept, edges are clamped.
+// Perreault-Hebert algorithm: time per pixel doesn't depend on radius.
+Pixels2D getMedianFiltered(const Pixels2D& pixels, size_t radius);
+
+} // namespace ps
+
+#endif // PLUGINS_PLUGIN_LIB_FILTERS_MEDIAN_FILTER_HPP
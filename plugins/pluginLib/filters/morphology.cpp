@@ -0,0 +1,342 @@
+#include "morphology.hpp"
+
+#include "pluginLib/filters/filterExecutor.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+namespace ps
+{
+
+namespace
+{
+
+const size_t kDiskRectanglesCount = 4;
+
+struct MinOperation
+{
+    uint8_t operator()(uint8_t lhs, uint8_t rhs) const { return std::min(lhs, rhs); }
+};
+
+struct MaxOperation
+{
+    uint8_t operator()(uint8_t lhs, uint8_t rhs) const { return std::max(lhs, rhs); }
+};
+
+// half sizes of a rectangular element
+struct ElementRectangle
+{
+    size_t horizontal;
+    size_t vertical;
+
+    bool operator==(const ElementRectangle& other) const
+    {
+        return horizontal == other.horizontal && vertical == other.vertical;
+    }
+};
+
+std::vector<ElementRectangle> getElementRectangles(size_t radius, StructuringElement element)
+{
+    if (element == StructuringElement::Square)
+        return {{radius, radius}};
+
+    // corners lie on the circle at the middles of equal angle steps of the first quadrant
+    std::vector<ElementRectangle> rectangles;
+
+    for (size_t i = 0; i < kDiskRectanglesCount; ++i)
+    {
+        double angle = (static_cast<double>(i) + 0.5) * M_PI / (2.0 * kDiskRectanglesCount);
+
+        ElementRectangle rectangle = {static_cast<size_t>(std::lround(static_cast<double>(radius) * std::cos(angle))),
+                                      static_cast<size_t>(std::lround(static_cast<double>(radius) * std::sin(angle)))};
+
+        if (std::find(rectangles.begin(), rectangles.end(), rectangle) == rectangles.end())
+            rectangles.push_back(rectangle);
+    }
+
+    return rectangles;
+}
+
+// Window [i - radius, i + radius] cut by the line ends is covered by the suffix of the block of its
+// first value and the prefix of the block of its last one. Window inside one block either starts at
+// the block begin or ends at the block (line) end, then one of them is enough.
+template <size_t Channels, typename Operation>
+void filterRowsHorizontally(BytePlane& plane, size_t radius, Operation operation)
+{
+    assert(plane.channels == Channels);
+
+    const size_t width     = plane.width;
+    const size_t blockSize = 2 * radius + 1;
+    const size_t rowLength = width * Channels;
+
+    parallelForRows(plane.height, [&](size_t rowBegin, size_t rowEnd)
+    {
+        std::vector<uint8_t> prefix(rowLength);
+        std::vector<uint8_t> suffix(rowLength);
+
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+        {
+            uint8_t* row = plane.values.data() + y * rowLength;
+
+            for (size_t blockBegin = 0; blockBegin < width; blockBegin += blockSize)
+            {
+                size_t blockEnd = std::min(blockBegin + blockSize, width);
+
+                std::memcpy(&prefix[blockBegin * Channels], &row[blockBegin * Channels], Channels);
+
+                for (size_t i = (blockBegin + 1) * Channels; i < blockEnd * Channels; ++i)
+                    prefix[i] = operation(prefix[i - Channels], row[i]);
+
+                std::memcpy(&suffix[(blockEnd - 1) * Channels], &row[(blockEnd - 1) * Channels], Channels);
+
+                for (size_t i = (blockEnd - 1) * Channels; i-- > blockBegin * Channels;)
+                    suffix[i] = operation(suffix[i + Channels], row[i]);
+            }
+
+            for (size_t x = 0; x < width; ++x)
+            {
+                size_t first = x > radius ? x - radius : 0;
+                size_t last  = std::min(x + radius, width - 1);
+
+                const uint8_t* lastPrefix  = prefix.data() + last  * Channels;
+                const uint8_t* firstSuffix = suffix.data() + first * Channels;
+
+                uint8_t* result = row + x * Channels;
+
+                if (first % blockSize == 0)
+                    std::memcpy(result, lastPrefix, Channels);
+                else if (first / blockSize == last / blockSize)
+                    std::memcpy(result, firstSuffix, Channels);
+                else
+                    for (size_t c = 0; c < Channels; ++c)
+                        result[c] = operation(firstSuffix[c], lastPrefix[c]);
+            }
+        }
+    });
+}
+
+template <typename Operation>
+void combineRows(uint8_t* result, const uint8_t* lhs, const uint8_t* rhs, size_t length, Operation operation)
+{
+    for (size_t i = 0; i < length; ++i)
+        result[i] = operation(lhs[i], rhs[i]);
+}
+
+// same scheme as filterRowsHorizontally with whole rows as values
+template <typename Operation>
+void filterRowsVertically(BytePlane& plane, size_t radius, Operation operation)
+{
+    const size_t height    = plane.height;
+    const size_t blockSize = 2 * radius + 1;
+    const size_t rowLength = plane.width * plane.channels;
+    const size_t blocks    = (height + blockSize - 1) / blockSize;
+
+    std::vector<uint8_t> prefix(plane.values.size());
+    std::vector<uint8_t> suffix(plane.values.size());
+
+    auto rowOf = [rowLength](auto& values, size_t y) { return values.data() + y * rowLength; };
+
+    parallelForRows(blocks, [&](size_t blockBegin, size_t blockEnd)
+    {
+        for (size_t block = blockBegin; block < blockEnd; ++block)
+        {
+            size_t top    = block * blockSize;
+            size_t bottom = std::min(top + blockSize, height);
+
+            std::memcpy(rowOf(prefix, top), rowOf(plane.values, top), rowLength);
+
+            for (size_t y = top + 1; y < bottom; ++y)
+                combineRows(rowOf(prefix, y), rowOf(prefix, y - 1), rowOf(plane.values, y), rowLength, operation);
+
+            std::memcpy(rowOf(suffix, bottom - 1), rowOf(plane.values, bottom - 1), rowLength);
+
+            for (size_t y = bottom - 1; y-- > top;)
+                combineRows(rowOf(suffix, y), rowOf(suffix, y + 1), rowOf(plane.values, y), rowLength, operation);
+        }
+    });
+
+    parallelForRows(height, [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+        {
+            size_t first = y > radius ? y - radius : 0;
+            size_t last  = std::min(y + radius, height - 1);
+
+            if (first % blockSize == 0)
+                std::memcpy(rowOf(plane.values, y), rowOf(prefix, last), rowLength);
+            else if (first / blockSize == last / blockSize)
+                std::memcpy(rowOf(plane.values, y), rowOf(suffix, first), rowLength);
+            else
+                combineRows(rowOf(plane.values, y), rowOf(suffix, first), rowOf(prefix, last), rowLength, operation);
+        }
+    });
+}
+
+template <typename Operation>
+void filterRectangle(BytePlane& plane, const ElementRectangle& rectangle, Operation operation)
+{
+    if (rectangle.horizontal > 0)
+    {
+        if (plane.channels == 4)
+            filterRowsHorizontally<4>(plane, rectangle.horizontal, operation);
+        else
+            filterRowsHorizontally<1>(plane, rectangle.horizontal, operation);
+    }
+
+    if (rectangle.vertical > 0)
+        filterRowsVertically(plane, rectangle.vertical, operation);
+}
+
+// min (max) over a union of rectangles is min (max) of the results of the rectangles
+template <typename Operation>
+void filterElement(BytePlane& plane, size_t radius, StructuringElement element, Operation operation)
+{
+    std::vector<ElementRectangle> rectangles = getElementRectangles(radius, element);
+
+    BytePlane source;
+    if (rectangles.size() > 1)
+        source = plane;
+
+    filterRectangle(plane, rectangles[0], operation);
+
+    for (size_t i = 1; i < rectangles.size(); ++i)
+    {
+        BytePlane part = source;
+        filterRectangle(part, rectangles[i], operation);
+
+        combineRows(plane.values.data(), plane.values.data(), part.values.data(), plane.values.size(), operation);
+    }
+}
+
+BytePlane toPlane(const Pixels2D& pixels)
+{
+    BytePlane plane;
+
+    plane.height   = pixels.size();
+    plane.width    = pixels[0].size();
+    plane.channels = 4;
+    plane.values.resize(plane.width * plane.height * plane.channels);
+
+    parallelForRows(plane.height, [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+        {
+            uint8_t* row = plane.values.data() + y * plane.width * plane.channels;
+
+            for (const Color& color : pixels[y])
+            {
+                *row++ = color.r;
+                *row++ = color.g;
+                *row++ = color.b;
+                *row++ = color.a;
+            }
+        }
+    });
+
+    return plane;
+}
+
+Pixels2D toPixels(const BytePlane& plane)
+{
+    assert(plane.channels == 4);
+
+    Pixels2D pixels(plane.height, std::vector<Color>(plane.width));
+
+    parallelForRows(plane.height, [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+        {
+            const uint8_t* row = plane.values.data() + y * plane.width * plane.channels;
+
+            for (Color& color : pixels[y])
+            {
+                color = Color{row[0], row[1], row[2], row[3]};
+                row += 4;
+            }
+        }
+    });
+
+    return pixels;
+}
+
+} // namespace anonymous
+
+void applyMorphology(BytePlane& plane, MorphologyOperation operation, size_t radius, StructuringElement element)
+{
+    assert(plane.channels == 1 || plane.channels == 4);
+    assert(plane.values.size() == plane.width * plane.height * plane.channels);
+
+    if (radius == 0 || plane.values.empty())
+        return;
+
+    switch (operation)
+    {
+        case MorphologyOperation::Erode:
+            filterElement(plane, radius, element, MinOperation{});
+            break;
+
+        case MorphologyOperation::Dilate:
+            filterElement(plane, radius, element, MaxOperation{});
+            break;
+
+        case MorphologyOperation::Open:
+            filterElement(plane, radius, element, MinOperation{});
+            filterElement(plane, radius, element, MaxOperation{});
+            break;
+
+        case MorphologyOperation::Close:
+            filterElement(plane, radius, element, MaxOperation{});
+            filterElement(plane, radius, element, MinOperation{});
+            break;
+
+        default:
+            assert(false);
+    }
+}
+
+Pixels2D getMorphology(const Pixels2D& pixels, MorphologyOperation operation, size_t radius,
+                       StructuringElement element)
+{
+    if (pixels.empty() || pixels[0].empty() || radius == 0)
+        return pixels;
+
+    BytePlane plane = toPlane(pixels);
+    applyMorphology(plane, operation, radius, element);
+
+    return toPixels(plane);
+}
+
+SelectionMask getMorphology(const SelectionMask& mask, MorphologyOperation operation, size_t radius,
+                            StructuringElement element)
+{
+    if (mask.isEmpty() || radius == 0)
+        return mask;
+
+    // unselected margin wide enough for dilation to grow into it and for erosion
+    // after it to still see unselected pixels
+    const int margin = static_cast<int>(2 * radius + 1);
+
+    IntRect bounds = mask.getBounds();
+    vec2i origin = {bounds.pos.x - margin, bounds.pos.y - margin};
+
+    BytePlane plane;
+    plane.width  = bounds.size.x + 2 * static_cast<size_t>(margin);
+    plane.height = bounds.size.y + 2 * static_cast<size_t>(margin);
+    plane.values.assign(plane.width * plane.height, 0);
+
+    for (int y = mask.getTop(); y < mask.getBottom(); ++y)
+    {
+        uint8_t* row = plane.values.data() + static_cast<size_t>(y - origin.y) * plane.width;
+
+        for (const SelectionSpan& span : mask.getRow(y))
+            std::memset(row + (span.begin - origin.x), 255, static_cast<size_t>(span.end - span.begin));
+    }
+
+    applyMorphology(plane, operation, radius, element);
+
+    return SelectionMask::createFromPlane(origin, plane.width, plane.values);
+}
+
+} // namespace ps
@@ -0,0 +1,54 @@
+#ifndef PLUGINS_PLUGIN_LIB_FILTERS_MORPHOLOGY_HPP
+#define PLUGINS_PLUGIN_LIB_FILTERS_MORPHOLOGY_HPP
+
+#include "pluginLib/filters/filterGraph.hpp"
+#include "pluginLib/selection/selectionMask.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ps
+{
+
+enum class MorphologyOperation
+{
+    Erode,  // minimum over the structuring element
+    Dilate, // maximum over the structuring element
+    Open,   // erode, then dilate - removes bright details smaller than the element
+    Close,  // dilate, then erode - fills dark details smaller than the element
+};
+
+enum class StructuringElement
+{
+    Square,
+    Disk,   // union of 4 rectangles inscribed in the circle
+};
+
+// 8-bit values, channels (1 or 4) of a pixel are interleaved, rows are stored one after another
+struct BytePlane
+{
+    size_t width    = 0;
+    size_t height   = 0;
+    size_t channels = 1;
+
+    std::vector<uint8_t> values;
+};
+
+// Van Herk/Gil-Werman: lines are split into blocks of 2 * radius + 1 values with running minimums
+// (maximums) from both block ends, so any window is two lookups, about 3 comparisons per value and pass
+// whatever the radius. Vertical passes combine whole rows elementwise, which the compiler vectorizes.
+// Windows are cut by the plane edges.
+void applyMorphology(BytePlane& plane, MorphologyOperation operation, size_t radius, StructuringElement element);
+
+// every channel, alpha included, is processed independently
+Pixels2D getMorphology(const Pixels2D& pixels, MorphologyOperation operation, size_t radius,
+                       StructuringElement element);
+
+// pixels outside of the mask are unselected, so Dilate grows the selection by radius and Erode shrinks it
+SelectionMask getMorphology(const SelectionMask& mask, MorphologyOperation operation, size_t radius,
+                            StructuringElement element);
+
+} // namespace ps
+
+#endif // PLUGINS_PLUGIN_LIB_FILTERS_MORPHOLOGY_HPP
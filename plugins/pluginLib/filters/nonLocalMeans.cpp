@@ -0,0 +1,256 @@
+#include "nonLocalMeans.hpp"
+
+#include "pluginLib/filters/filterExecutor.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+
+namespace ps
+{
+
+namespace
+{
+
+// weights of the distances up to kMaxWeightDistance * strength^2, farther patches get none
+const size_t kWeightsCount      = 1024;
+const float  kMaxWeightDistance = 8.f;
+
+const size_t kChannels = 3;
+
+struct Accumulator
+{
+    float r = 0.f;
+    float g = 0.f;
+    float b = 0.f;
+
+    float weight    = 0.f;
+    float maxWeight = 0.f;
+};
+
+struct NonLocalMeansParameters
+{
+    long searchRadius = 0;
+    long patchRadius  = 0;
+
+    std::vector<float> weights       = {}; // by the distance divided by the strength^2
+    std::vector<float> columnFactors = {}; // distance table index per patch sum at the column
+    std::vector<float> rowFactors    = {}; // the same at the row, product of both is the factor of a pixel
+};
+
+// patches at the edges are cut, their sums are divided by the pixels they have
+std::vector<float> makePatchFactors(size_t size, long patchRadius)
+{
+    std::vector<float> factors(size);
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        long index = static_cast<long>(i);
+        long count = std::min(index + patchRadius, static_cast<long>(size) - 1) - std::max(index - patchRadius, 0l) + 1;
+
+        factors[i] = 1.f / static_cast<float>(count);
+    }
+
+    return factors;
+}
+
+// Output rows [top, bottom). Squared differences are needed for the rows of the patches around them.
+void denoiseBand(const Pixels2D& pixels, Pixels2D& result, size_t top, size_t bottom,
+                 const NonLocalMeansParameters& parameters)
+{
+    const size_t width  = pixels[0].size();
+    const size_t height = pixels.size();
+
+    const long searchRadius = parameters.searchRadius;
+    const long patchRadius  = parameters.patchRadius;
+
+    const long lastRow    = static_cast<long>(height) - 1;
+    const long lastColumn = static_cast<long>(width) - 1;
+
+    const size_t first = static_cast<size_t>(std::max(static_cast<long>(top) - patchRadius, 0l));
+    const size_t last  = std::min(bottom + static_cast<size_t>(patchRadius), height);
+
+    std::vector<uint32_t> differences((last - first) * width);
+    std::vector<uint32_t> columnSums(width);
+    std::vector<size_t> neighborColumns(width);
+
+    std::vector<Accumulator> accumulators((bottom - top) * width);
+
+    for (long offsetY = -searchRadius; offsetY <= searchRadius; ++offsetY)
+    {
+        for (long offsetX = -searchRadius; offsetX <= searchRadius; ++offsetX)
+        {
+            if (offsetX == 0 && offsetY == 0)
+                continue;
+
+            for (size_t x = 0; x < width; ++x)
+                neighborColumns[x] = static_cast<size_t>(std::clamp(static_cast<long>(x) + offsetX, 0l, lastColumn));
+
+            for (size_t y = first; y < last; ++y)
+            {
+                const std::vector<Color>& row = pixels[y];
+                const std::vector<Color>& neighborRow =
+                    pixels[static_cast<size_t>(std::clamp(static_cast<long>(y) + offsetY, 0l, lastRow))];
+
+                uint32_t* rowDifferences = differences.data() + (y - first) * width;
+
+                for (size_t x = 0; x < width; ++x)
+                {
+                    const Color& color    = row[x];
+                    const Color& neighbor = neighborRow[neighborColumns[x]];
+
+                    int differenceR = color.r - neighbor.r;
+                    int differenceG = color.g - neighbor.g;
+                    int differenceB = color.b - neighbor.b;
+
+                    rowDifferences[x] = static_cast<uint32_t>(differenceR * differenceR + differenceG * differenceG +
+                                                              differenceB * differenceB);
+                }
+            }
+
+            // vertical running sums over the patch rows, then horizontal running sums over the columns
+            std::fill(columnSums.begin(), columnSums.end(), 0);
+
+            size_t windowFirst = static_cast<size_t>(std::max(static_cast<long>(top) - patchRadius, 0l));
+            size_t windowLast  = std::min(top + static_cast<size_t>(patchRadius) + 1, height);
+
+            for (size_t y = windowFirst; y < windowLast; ++y)
+            {
+                const uint32_t* rowDifferences = differences.data() + (y - first) * width;
+
+                for (size_t x = 0; x < width; ++x)
+                    columnSums[x] += rowDifferences[x];
+            }
+
+            for (size_t y = top; y < bottom; ++y)
+            {
+                if (y > top)
+                {
+                    size_t added   = y + static_cast<size_t>(patchRadius);
+                    long   removed = static_cast<long>(y) - patchRadius - 1;
+
+                    if (added < last)
+                    {
+                        const uint32_t* rowDifferences = differences.data() + (added - first) * width;
+                        for (size_t x = 0; x < width; ++x)
+                            columnSums[x] += rowDifferences[x];
+                    }
+
+                    if (removed >= static_cast<long>(first))
+                    {
+                        const uint32_t* rowDifferences = differences.data() + (static_cast<size_t>(removed) - first) * width;
+                        for (size_t x = 0; x < width; ++x)
+                            columnSums[x] -= rowDifferences[x];
+                    }
+                }
+
+                const std::vector<Color>& neighborRow =
+                    pixels[static_cast<size_t>(std::clamp(static_cast<long>(y) + offsetY, 0l, lastRow))];
+
+                const float rowFactor = parameters.rowFactors[y];
+                Accumulator* rowAccumulators = accumulators.data() + (y - top) * width;
+
+                uint32_t patchSum = 0;
+                for (long x = 0; x < std::min(patchRadius, lastColumn + 1); ++x)
+                    patchSum += columnSums[static_cast<size_t>(x)];
+
+                for (size_t x = 0; x < width; ++x)
+                {
+                    long added   = static_cast<long>(x) + patchRadius;
+                    long removed = static_cast<long>(x) - patchRadius - 1;
+
+                    if (added <= lastColumn)
+                        patchSum += columnSums[static_cast<size_t>(added)];
+                    if (removed >= 0)
+                        patchSum -= columnSums[static_cast<size_t>(removed)];
+
+                    float position = static_cast<float>(patchSum) * rowFactor * parameters.columnFactors[x];
+                    size_t index = std::min(static_cast<size_t>(position), kWeightsCount - 1);
+
+                    // the last weight is zero
+                    if (index == kWeightsCount - 1)
+                        continue;
+
+                    float weight = parameters.weights[index];
+
+                    const Color& neighbor = neighborRow[neighborColumns[x]];
+                    Accumulator& accumulator = rowAccumulators[x];
+
+                    accumulator.r += weight * neighbor.r;
+                    accumulator.g += weight * neighbor.g;
+                    accumulator.b += weight * neighbor.b;
+
+                    accumulator.weight   += weight;
+                    accumulator.maxWeight = std::max(accumulator.maxWeight, weight);
+                }
+            }
+        }
+    }
+
+    // the pixel itself is as similar as the most similar neighbor, otherwise it would outweigh them all
+    for (size_t y = top; y < bottom; ++y)
+    {
+        const Accumulator* rowAccumulators = accumulators.data() + (y - top) * width;
+
+        for (size_t x = 0; x < width; ++x)
+        {
+            const Accumulator& accumulator = rowAccumulators[x];
+            const Color& color = pixels[y][x];
+
+            float selfWeight = accumulator.maxWeight > 0.f ? accumulator.maxWeight : 1.f;
+            float weight     = accumulator.weight + selfWeight;
+
+            auto average = [weight](float sum)
+            {
+                return static_cast<uint8_t>(std::clamp(std::lround(sum / weight), 0l, 255l));
+            };
+
+            result[y][x].r = average(accumulator.r + selfWeight * color.r);
+            result[y][x].g = average(accumulator.g + selfWeight * color.g);
+            result[y][x].b = average(accumulator.b + selfWeight * color.b);
+        }
+    }
+}
+
+} // namespace anonymous
+
+Pixels2D getNonLocalMeansDenoised(const Pixels2D& pixels, float strength, size_t searchRadius, size_t patchRadius)
+{
+    size_t height = pixels.size();
+    size_t width  = height > 0 ? pixels[0].size() : 0;
+
+    if (width == 0 || searchRadius == 0 || strength <= 0.f)
+        return pixels;
+
+    NonLocalMeansParameters parameters;
+    parameters.searchRadius = static_cast<long>(searchRadius);
+    parameters.patchRadius  = static_cast<long>(patchRadius);
+
+    parameters.weights.resize(kWeightsCount);
+    for (size_t i = 0; i + 1 < kWeightsCount; ++i)
+        parameters.weights[i] = std::exp(-static_cast<float>(i) * kMaxWeightDistance / kWeightsCount);
+
+    parameters.weights.back() = 0.f;
+
+    // table index of a patch sum: sum / (channels * pixels) / strength^2 * (count / max distance)
+    const float indexScale = static_cast<float>(kWeightsCount) /
+                             (kMaxWeightDistance * strength * strength * static_cast<float>(kChannels));
+
+    parameters.columnFactors = makePatchFactors(width, parameters.patchRadius);
+    for (float& factor : parameters.columnFactors)
+        factor *= indexScale;
+
+    parameters.rowFactors = makePatchFactors(height, parameters.patchRadius);
+
+    Pixels2D result = pixels;
+
+    parallelForRows(height, [&](size_t rowBegin, size_t rowEnd)
+    {
+        denoiseBand(pixels, result, rowBegin, rowEnd, parameters);
+    });
+
+    return result;
+}
+
+} // namespace ps
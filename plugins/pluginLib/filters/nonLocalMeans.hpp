@@ -0,0 +1,22 @@
+#ifndef PLUGINS_PLUGIN_LIB_FILTERS_NON_LOCAL_MEANS_HPP
+#define PLUGINS_PLUGIN_LIB_FILTERS_NON_LOCAL_MEANS_HPP
+
+#include "pluginLib/filters/filterGraph.hpp"
+
+#include <cstddef>
+
+namespace ps
+{
+
+// Non-local means denoising: every pixel becomes the weighted mean of the pixels in the
+// (2 * searchRadius + 1)^2 window, weights fall with the mean squared RGB difference of the
+// (2 * patchRadius + 1)^2 patches around the pixels, strength - its scale in channel values.
+// Alpha is kept, edges are clamped.
+// Darbon et al.: for every offset the squared differences of the pixels are summed over the patches
+// by running sums, so the patch size doesn't change the cost. Bands of rows are processed in parallel,
+// each with its own accumulators.
+Pixels2D getNonLocalMeansDenoised(const Pixels2D& pixels, float strength, size_t searchRadius, size_t patchRadius);
+
+} // namespace ps
+
+#endif // PLUGINS_PLUGIN_LIB_FILTERS_NON_LOCAL_MEANS_HPP
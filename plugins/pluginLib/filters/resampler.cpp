@@ -0,0 +1,282 @@
+#include "resampler.hpp"
+
+#include "pluginLib/filters/filterExecutor.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+
+namespace ps
+{
+
+namespace
+{
+
+const int     kWeightBits = 14;
+const int32_t kWeightOne  = 1 << kWeightBits;
+const int32_t kWeightHalf = kWeightOne / 2;
+
+// output pixels of one vertical pass block, their sums stay in L1 while source rows stream through
+const size_t kVerticalBlockWidth = 256;
+
+const float kPi = 3.14159265358979f;
+
+struct WeightedSums
+{
+    int32_t r = 0;
+    int32_t g = 0;
+    int32_t b = 0;
+    int32_t a = 0;
+};
+
+// source pixels [begin, begin + count) with their weights, weights of output i start at i * maxCount
+struct Contributions
+{
+    std::vector<size_t> begin;
+    std::vector<size_t> count;
+    std::vector<int32_t> weights;
+    size_t maxCount = 0;
+};
+
+float getSupport(ResampleFilter filter)
+{
+    switch (filter)
+    {
+        case ResampleFilter::Box:      return 0.5f;
+        case ResampleFilter::Nearest:  return 0.5f;
+        case ResampleFilter::Bilinear: return 1.f;
+        case ResampleFilter::Bicubic:  return 2.f;
+        case ResampleFilter::Lanczos3: return 3.f;
+
+        default:
+            assert(0 && "UNKNOWN RESAMPLE FILTER");
+            return 1.f;
+    }
+}
+
+float getSinc(float x)
+{
+    if (std::abs(x) < 1e-6f)
+        return 1.f;
+
+    return std::sin(kPi * x) / (kPi * x);
+}
+
+float getKernel(ResampleFilter filter, float x)
+{
+    float distance = std::abs(x);
+
+    switch (filter)
+    {
+        case ResampleFilter::Box:
+        case ResampleFilter::Nearest:
+            return x >= -0.5f && x < 0.5f ? 1.f : 0.f;
+
+        case ResampleFilter::Bilinear:
+            return std::max(0.f, 1.f - distance);
+
+        case ResampleFilter::Bicubic:
+        {
+            const float a = -0.5f;
+
+            if (distance < 1.f)
+                return ((a + 2.f) * distance - (a + 3.f)) * distance * distance + 1.f;
+            if (distance < 2.f)
+                return ((a * distance - 5.f * a) * distance + 8.f * a) * distance - 4.f * a;
+
+            return 0.f;
+        }
+
+        case ResampleFilter::Lanczos3:
+            return distance < 3.f ? getSinc(x) * getSinc(x / 3.f) : 0.f;
+
+        default:
+            assert(0 && "UNKNOWN RESAMPLE FILTER");
+            return 0.f;
+    }
+}
+
+// Float weights are normalized and rounded to fixed point, rounding error goes to the largest weight,
+// so flat areas stay exactly flat.
+Contributions computeContributions(size_t sourceSize, size_t resultSize, ResampleFilter filter)
+{
+    assert(sourceSize > 0 && resultSize > 0);
+
+    float scale = static_cast<float>(sourceSize) / static_cast<float>(resultSize);
+    float filterScale = filter == ResampleFilter::Nearest ? 1.f : std::max(scale, 1.f);
+    float support = getSupport(filter) * filterScale;
+
+    Contributions contributions;
+    contributions.maxCount = std::min(static_cast<size_t>(std::ceil(support)) * 2 + 1, sourceSize);
+    contributions.begin  .resize(resultSize);
+    contributions.count  .resize(resultSize);
+    contributions.weights.assign(resultSize * contributions.maxCount, 0);
+
+    std::vector<float> weights(contributions.maxCount);
+
+    for (size_t i = 0; i < resultSize; ++i)
+    {
+        float center = (static_cast<float>(i) + 0.5f) * scale;
+
+        long long left  = std::max(static_cast<long long>(std::floor(center - support)), 0ll);
+        long long right = std::min(static_cast<long long>(std::ceil (center + support)),
+                                   static_cast<long long>(sourceSize));
+
+        size_t begin = static_cast<size_t>(left);
+        size_t count = std::min(static_cast<size_t>(std::max(right - left, 1ll)), contributions.maxCount);
+
+        float sum = 0;
+        for (size_t j = 0; j < count; ++j)
+        {
+            float sourceCenter = static_cast<float>(begin + j) + 0.5f;
+            weights[j] = getKernel(filter, (sourceCenter - center) / filterScale);
+            sum += weights[j];
+        }
+
+        // nearest source pixel for kernels that missed all pixels
+        if (sum <= 0)
+        {
+            begin = std::min(static_cast<size_t>(center), sourceSize - 1);
+            count = 1;
+            weights[0] = sum = 1.f;
+        }
+
+        int32_t* fixedWeights = contributions.weights.data() + i * contributions.maxCount;
+        int32_t fixedSum = 0;
+        size_t largest = 0;
+
+        for (size_t j = 0; j < count; ++j)
+        {
+            fixedWeights[j] = static_cast<int32_t>(std::lround(weights[j] / sum * kWeightOne));
+            fixedSum += fixedWeights[j];
+
+            if (fixedWeights[j] > fixedWeights[largest])
+                largest = j;
+        }
+
+        fixedWeights[largest] += kWeightOne - fixedSum;
+
+        contributions.begin[i] = begin;
+        contributions.count[i] = count;
+    }
+
+    return contributions;
+}
+
+uint8_t normalizeChannel(int32_t sum)
+{
+    return static_cast<uint8_t>(std::clamp((sum + kWeightHalf) >> kWeightBits, 0, 255));
+}
+
+Color normalizeSums(const WeightedSums& sums)
+{
+    Color color;
+
+    color.r = normalizeChannel(sums.r);
+    color.g = normalizeChannel(sums.g);
+    color.b = normalizeChannel(sums.b);
+    color.a = normalizeChannel(sums.a);
+
+    return color;
+}
+
+void addWeighted(WeightedSums& sums, Color color, int32_t weight)
+{
+    sums.r += weight * color.r;
+    sums.g += weight * color.g;
+    sums.b += weight * color.b;
+    sums.a += weight * color.a;
+}
+
+Pixels2D resampleHorizontally(const Pixels2D& pixels, size_t width, ResampleFilter filter)
+{
+    Contributions contributions = computeContributions(pixels[0].size(), width, filter);
+    Pixels2D result(pixels.size(), std::vector<Color>(width));
+
+    parallelForRows(pixels.size(), [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+        {
+            const Color* source = pixels[y].data();
+            std::vector<Color>& resultRow = result[y];
+
+            for (size_t x = 0; x < width; ++x)
+            {
+                const Color*   taps    = source + contributions.begin[x];
+                const int32_t* weights = contributions.weights.data() + x * contributions.maxCount;
+
+                WeightedSums sums;
+
+                for (size_t k = 0; k < contributions.count[x]; ++k)
+                    addWeighted(sums, taps[k], weights[k]);
+
+                resultRow[x] = normalizeSums(sums);
+            }
+        }
+    });
+
+    return result;
+}
+
+Pixels2D resampleVertically(const Pixels2D& pixels, size_t height, ResampleFilter filter)
+{
+    size_t width = pixels[0].size();
+
+    Contributions contributions = computeContributions(pixels.size(), height, filter);
+    Pixels2D result(height, std::vector<Color>(width));
+
+    parallelForRows(height, [&](size_t rowBegin, size_t rowEnd)
+    {
+        std::vector<WeightedSums> sums(kVerticalBlockWidth);
+
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+        {
+            const int32_t* weights = contributions.weights.data() + y * contributions.maxCount;
+
+            for (size_t blockBegin = 0; blockBegin < width; blockBegin += kVerticalBlockWidth)
+            {
+                size_t blockWidth = std::min(kVerticalBlockWidth, width - blockBegin);
+                std::fill(sums.begin(), sums.begin() + static_cast<ptrdiff_t>(blockWidth), WeightedSums{});
+
+                for (size_t k = 0; k < contributions.count[y]; ++k)
+                {
+                    const Color* source = pixels[contributions.begin[y] + k].data() + blockBegin;
+
+                    for (size_t x = 0; x < blockWidth; ++x)
+                        addWeighted(sums[x], source[x], weights[k]);
+                }
+
+                Color* resultRow = result[y].data() + blockBegin;
+                for (size_t x = 0; x < blockWidth; ++x)
+                    resultRow[x] = normalizeSums(sums[x]);
+            }
+        }
+    });
+
+    return result;
+}
+
+} // namespace anonymous
+
+Pixels2D resample(const Pixels2D& pixels, const vec2u& size, ResampleFilter filter)
+{
+    size_t height = pixels.size();
+    size_t width  = height > 0 ? pixels[0].size() : 0;
+
+    if (width == 0 || size.x == 0 || size.y == 0)
+        return Pixels2D(size.y, std::vector<Color>(size.x));
+
+    if (width == size.x && height == size.y)
+        return pixels;
+
+    if (width == size.x)
+        return resampleVertically(pixels, size.y, filter);
+
+    if (height == size.y)
+        return resampleHorizontally(pixels, size.x, filter);
+
+    return resampleVertically(resampleHorizontally(pixels, size.x, filter), size.y, filter);
+}
+
+} // namespace ps
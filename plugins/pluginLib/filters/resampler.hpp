@@ -0,0 +1,25 @@
+#ifndef PLUGINS_PLUGIN_LIB_FILTERS_RESAMPLER_HPP
+#define PLUGINS_PLUGIN_LIB_FILTERS_RESAMPLER_HPP
+
+#include "pluginLib/filters/filterGraph.hpp"
+
+namespace ps
+{
+
+enum class ResampleFilter
+{
+    Box,      // average of the covered pixels, for integer downscaling
+    Nearest,
+    Bilinear,
+    Bicubic,  // Keys, a = -0.5
+    Lanczos3,
+};
+
+// Separable resampling: horizontal pass over the source rows, then vertical one over the output rows.
+// Weights of every output column and row are computed once in fixed point; downscaling widens the kernels,
+// so every source pixel contributes. Channels are filtered as they are, alpha is not premultiplied.
+Pixels2D resample(const Pixels2D& pixels, const vec2u& size, ResampleFilter filter);
+
+} // namespace ps
+
+#endif // PLUGINS_PLUGIN_LIB_FILTERS_RESAMPLER_HPP
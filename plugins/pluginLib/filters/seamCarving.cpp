@@ -0,0 +1,396 @@
+#include "seamCarving.hpp"
+
+#include "pluginLib/filters/filterExecutor.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+namespace ps
+{
+
+namespace
+{
+
+// narrower rows of the cost cone are cheaper to update on one thread
+const size_t kParallelColumns = 1024;
+
+struct CarvedPixel
+{
+    Color color;
+    int32_t cost;      // of the cheapest seam from the top row to this pixel
+    uint16_t energy;
+    uint8_t luminance; // multiplied by alpha
+};
+
+// columns [first, last) of a row
+struct ColumnRange
+{
+    size_t first = 0;
+    size_t last  = 0;
+
+    bool isEmpty() const { return first >= last; }
+
+    void add(size_t column)
+    {
+        if (isEmpty())
+        {
+            first = column;
+            last  = column + 1;
+            return;
+        }
+
+        first = std::min(first, column);
+        last  = std::max(last, column + 1);
+    }
+
+    void add(const ColumnRange& other)
+    {
+        if (other.isEmpty())
+            return;
+
+        add(other.first);
+        add(other.last - 1);
+    }
+};
+
+// transparent pixels are dark, so seams prefer to go through them
+uint8_t getCarvingLuminance(Color color)
+{
+    return static_cast<uint8_t>(getLuminance(color) * color.a / 255);
+}
+
+Pixels2D transpose(const Pixels2D& pixels)
+{
+    size_t height = pixels.size();
+    size_t width  = height > 0 ? pixels[0].size() : 0;
+
+    Pixels2D result(width, std::vector<Color>(height));
+
+    parallelForRows(width, [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t y = 0; y < height; ++y)
+        {
+            for (size_t x = rowBegin; x < rowEnd; ++x)
+                result[x][y] = pixels[y][x];
+        }
+    });
+
+    return result;
+}
+
+// Removes vertical seams. Pixels of row y are pixels_[y * stride_ + starts_[y] + column], a seam pixel
+// is removed by shifting the part of the row on its shorter side, the left part moves the start.
+class SeamCarver
+{
+public:
+    explicit SeamCarver(const Pixels2D& pixels);
+
+    // false if the job was cancelled
+    bool removeSeams(size_t count);
+
+    Pixels2D getPixels() const;
+
+private:
+    CarvedPixel* getRow(size_t y) { return pixels_.data() + y * stride_ + starts_[y]; }
+    const CarvedPixel* getRow(size_t y) const { return pixels_.data() + y * stride_ + starts_[y]; }
+
+    void updateEnergy(size_t y, ColumnRange range);
+
+    // returns the columns whose cost has changed
+    ColumnRange updateCosts(size_t y, ColumnRange range);
+    ColumnRange updateCostsPart(size_t y, size_t first, size_t last);
+
+    // cost of the cheapest seam ending in the last row, then back to the top along the cheapest neighbors
+    void findSeam();
+
+    bool removeSeam();
+
+private:
+    size_t width_;
+    size_t height_;
+    size_t stride_;
+
+    std::vector<CarvedPixel> pixels_;
+    std::vector<size_t> starts_;
+
+    std::vector<size_t> seam_; // column of every row
+};
+
+SeamCarver::SeamCarver(const Pixels2D& pixels)
+    : width_(pixels.empty() ? 0 : pixels[0].size()), height_(pixels.size()), stride_(width_),
+      pixels_(width_ * height_), starts_(height_, 0), seam_(height_, 0)
+{
+    parallelForRows(height_, [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+        {
+            CarvedPixel* row = getRow(y);
+
+            for (size_t x = 0; x < width_; ++x)
+                row[x] = CarvedPixel{pixels[y][x], 0, 0, getCarvingLuminance(pixels[y][x])};
+        }
+    });
+
+    parallelForRows(height_, [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+            updateEnergy(y, ColumnRange{0, width_});
+    });
+
+    for (size_t y = 0; y < height_; ++y)
+        updateCosts(y, ColumnRange{0, width_});
+}
+
+// |dx| + |dy| of the luminance by central differences, the borders are repeated
+void SeamCarver::updateEnergy(size_t y, ColumnRange range)
+{
+    CarvedPixel* row = getRow(y);
+    const CarvedPixel* above = getRow(y > 0 ? y - 1 : y);
+    const CarvedPixel* below = getRow(y + 1 < height_ ? y + 1 : y);
+
+    for (size_t x = range.first; x < range.last; ++x)
+    {
+        size_t left  = x > 0 ? x - 1 : x;
+        size_t right = x + 1 < width_ ? x + 1 : x;
+
+        int gradientX = std::abs(row[right].luminance - row[left].luminance);
+        int gradientY = std::abs(below[x].luminance - above[x].luminance);
+
+        row[x].energy = static_cast<uint16_t>(gradientX + gradientY);
+    }
+}
+
+ColumnRange SeamCarver::updateCostsPart(size_t y, size_t first, size_t last)
+{
+    CarvedPixel* row = getRow(y);
+    const CarvedPixel* above = y > 0 ? getRow(y - 1) : nullptr;
+
+    ColumnRange changed;
+
+    for (size_t x = first; x < last; ++x)
+    {
+        int32_t cost = row[x].energy;
+
+        if (above)
+        {
+            int32_t cheapest = above[x].cost;
+
+            if (x > 0)
+                cheapest = std::min(cheapest, above[x - 1].cost);
+            if (x + 1 < width_)
+                cheapest = std::min(cheapest, above[x + 1].cost);
+
+            cost += cheapest;
+        }
+
+        if (cost != row[x].cost)
+        {
+            row[x].cost = cost;
+            changed.add(x);
+        }
+    }
+
+    return changed;
+}
+
+ColumnRange SeamCarver::updateCosts(size_t y, ColumnRange range)
+{
+    size_t count = range.last - range.first;
+
+    if (count < kParallelColumns)
+        return updateCostsPart(y, range.first, range.last);
+
+    ColumnRange changed;
+    std::mutex changedMutex;
+
+    parallelForRows(count, [&](size_t begin, size_t end)
+    {
+        ColumnRange partChanged = updateCostsPart(y, range.first + begin, range.first + end);
+
+        std::lock_guard<std::mutex> lock(changedMutex);
+        changed.add(partChanged);
+    });
+
+    return changed;
+}
+
+void SeamCarver::findSeam()
+{
+    const CarvedPixel* lastRow = getRow(height_ - 1);
+
+    size_t column = 0;
+    for (size_t x = 1; x < width_; ++x)
+    {
+        if (lastRow[x].cost < lastRow[column].cost)
+            column = x;
+    }
+
+    seam_[height_ - 1] = column;
+
+    // ties go to the straight continuation, then to the left
+    for (size_t y = height_ - 1; y > 0; --y)
+    {
+        const CarvedPixel* above = getRow(y - 1);
+        size_t best = column;
+
+        if (column > 0 && above[column - 1].cost < above[best].cost)
+            best = column - 1;
+        if (column + 1 < width_ && above[column + 1].cost < above[best].cost)
+            best = column + 1;
+
+        column = best;
+        seam_[y - 1] = column;
+    }
+}
+
+bool SeamCarver::removeSeam()
+{
+    findSeam();
+
+    bool isFinished = parallelForRows(height_, [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+        {
+            CarvedPixel* row = getRow(y);
+            size_t x = seam_[y];
+
+            if (x < width_ / 2)
+            {
+                std::memmove(row + 1, row, x * sizeof(CarvedPixel));
+                ++starts_[y];
+            }
+            else
+            {
+                std::memmove(row + x, row + x + 1, (width_ - x - 1) * sizeof(CarvedPixel));
+            }
+        }
+    });
+
+    if (!isFinished)
+        return false;
+
+    --width_;
+
+    // Left of the seam pixels keep their columns, right of it they move by one. A pixel changes its
+    // neighbors only next to the seam of its row or between the seam columns of its row and of the
+    // rows around it, the same columns are the ones whose costs depend on other pixels of the row above.
+    std::vector<ColumnRange> changedEnergies(height_);
+
+    isFinished = parallelForRows(height_, [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+        {
+            size_t first = seam_[y];
+            size_t last  = seam_[y];
+
+            if (y > 0)
+            {
+                first = std::min(first, seam_[y - 1]);
+                last  = std::max(last, seam_[y - 1]);
+            }
+
+            if (y + 1 < height_)
+            {
+                first = std::min(first, seam_[y + 1]);
+                last  = std::max(last, seam_[y + 1]);
+            }
+
+            ColumnRange range{first > 0 ? first - 1 : 0, std::min(last + 1, width_)};
+
+            updateEnergy(y, range);
+            changedEnergies[y] = range;
+        }
+    });
+
+    if (!isFinished)
+        return false;
+
+    // costs change where the energies do and below the changed costs of the row above
+    ColumnRange changedCosts;
+
+    for (size_t y = 0; y < height_; ++y)
+    {
+        ColumnRange range = changedEnergies[y];
+
+        if (!changedCosts.isEmpty())
+        {
+            range.add(changedCosts.first > 0 ? changedCosts.first - 1 : 0);
+            range.add(std::min(changedCosts.last, width_ - 1));
+        }
+
+        range.last = std::min(range.last, width_);
+
+        changedCosts = range.isEmpty() ? ColumnRange{} : updateCosts(y, range);
+    }
+
+    return true;
+}
+
+bool SeamCarver::removeSeams(size_t count)
+{
+    assert(count < width_);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (!removeSeam())
+            return false;
+    }
+
+    return true;
+}
+
+Pixels2D SeamCarver::getPixels() const
+{
+    Pixels2D result(height_, std::vector<Color>(width_));
+
+    parallelForRows(height_, [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+        {
+            const CarvedPixel* row = getRow(y);
+
+            for (size_t x = 0; x < width_; ++x)
+                result[y][x] = row[x].color;
+        }
+    });
+
+    return result;
+}
+
+} // namespace anonymous
+
+Pixels2D carveSeams(const Pixels2D& pixels, const vec2u& size)
+{
+    size_t height = pixels.size();
+    size_t width  = height > 0 ? pixels[0].size() : 0;
+
+    assert(size.x > 0 && size.y > 0);
+
+    Pixels2D result = pixels;
+
+    if (size.x < width)
+    {
+        SeamCarver carver(result);
+        if (!carver.removeSeams(width - size.x))
+            return result;
+
+        result = carver.getPixels();
+    }
+
+    if (size.y < height)
+    {
+        SeamCarver carver(transpose(result));
+        if (!carver.removeSeams(height - size.y))
+            return result;
+
+        result = transpose(carver.getPixels());
+    }
+
+    return result;
+}
+
+} // namespace ps
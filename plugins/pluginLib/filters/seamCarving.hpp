@@ -0,0 +1,19 @@
+#ifndef PLUGINS_PLUGIN_LIB_FILTERS_SEAM_CARVING_HPP
+#define PLUGINS_PLUGIN_LIB_FILTERS_SEAM_CARVING_HPP
+
+#include "pluginLib/filters/filterGraph.hpp"
+
+namespace ps
+{
+
+// Content-aware downscaling of Avidan and Shamir: connected seams of the least gradient energy are removed
+// one by one, vertical ones for the width and then horizontal ones for the height. Transparent pixels
+// have no energy, so they go first. Sizes larger than the pixels are left as they are.
+// Rows keep their own start offsets, so a seam is removed by shifting the shorter part of every row.
+// After a seam only the energies around it are recomputed, and the seam costs are recomputed only
+// in the cone of columns below it where they actually change, wide rows of the cone in parallel.
+Pixels2D carveSeams(const Pixels2D& pixels, const vec2u& size);
+
+} // namespace ps
+
+#endif // PLUGINS_PLUGIN_LIB_FILTERS_SEAM_CARVING_HPP
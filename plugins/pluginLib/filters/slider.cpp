@@ -6,10 +6,12 @@
 namespace ps
 {
 
-NamedSlider::NamedSlider(const char* caption, float maxValue)
-    : maxValue_(maxValue)
+NamedSlider::NamedSlider(wid_t id, const char* caption, float minValue, float maxValue)
+    : minValue_(minValue), maxValue_(maxValue)
 {
-    id_ = kRadiusSliderId;
+    assert(minValue < maxValue);
+
+    id_ = id;
     
     captionFont_ = IFont::create();
     assert(captionFont_);
@@ -40,7 +42,12 @@ std::unique_ptr<IAction> NamedSlider::createAction(const IRenderWindow* renderWi
 
 float NamedSlider::getCurrentValue() const
 {
-    return slider_->getCurrentFullness() * maxValue_;
+    return minValue_ + slider_->getCurrentFullness() * (maxValue_ - minValue_);
+}
+
+void NamedSlider::setCurrentValue(float value)
+{
+    slider_->setCurrentFullness((value - minValue_) / (maxValue_ - minValue_));
 }
 
 void NamedSlider::setPos(const vec2i& pos)
@@ -6,12 +6,13 @@
 namespace ps
 {
 
-static const wid_t kRadiusSliderId = 72931;
+// sliders of filter windows get sequential ids starting from it
+static const wid_t kFirstParameterSliderId = 72931;
 
 class NamedSlider : public ABarButton
 {
 public:
-    NamedSlider(const char* caption, float maxValue);
+    NamedSlider(wid_t id, const char* caption, float minValue, float maxValue);
 
     void setSlider(std::unique_ptr<SliderX> slider);
 
@@ -23,11 +24,13 @@ public:
     void setSize(const vec2u& size) override;
 
     float getCurrentValue() const;
+    void setCurrentValue(float value);
 
 private:
     std::unique_ptr<IText> caption_;
     std::unique_ptr<IFont> captionFont_;
 
+    float minValue_;
     float maxValue_;
 
     std::unique_ptr<SliderX> slider_;
@@ -0,0 +1,141 @@
+#include "sliderFilterButton.hpp"
+
+#include "api/api_canvas.hpp"
+
+#include "pluginLib/actions/actions.hpp"
+#include "pluginLib/filters/filters.hpp"
+
+#include <cassert>
+
+namespace ps
+{
+
+namespace
+{
+
+FilterPreview::PlacedFilter ignorePlacement(FilterPreview::Filter filter)
+{
+    return [filter = std::move(filter)](const Pixels2D& pixels, const std::vector<float>& parameters,
+                                        float scale, const LayerPlacement&)
+    {
+        return filter(pixels, parameters, scale);
+    };
+}
+
+} // namespace anonymous
+
+SliderFilterButton::SliderFilterButton(std::unique_ptr<IText> name, std::unique_ptr<IFont> font, 
+                                       const std::string& title, std::vector<SliderParameters> sliders, 
+                                       FilterPreview::Filter filter, FilterPreview::Halo halo,
+                                       FilterPreview::Tiling tiling)
+    : SliderFilterButton(std::move(name), std::move(font), title, std::move(sliders),
+                         ignorePlacement(std::move(filter)), std::move(halo), std::move(tiling))
+{
+}
+
+SliderFilterButton::SliderFilterButton(std::unique_ptr<IText> name, std::unique_ptr<IFont> font, 
+                                       const std::string& title, std::vector<SliderParameters> sliders, 
+                                       FilterPreview::PlacedFilter filter, FilterPreview::Halo halo,
+                                       FilterPreview::Tiling tiling)
+    : title_(title), sliders_(std::move(sliders)), filter_(std::move(filter)), filterFactory_(),
+      halo_(std::move(halo)), tiling_(std::move(tiling))
+{
+    assert(filter_);
+    assert(halo_);
+
+    name_ = std::move(name);
+    font_ = std::move(font);
+
+    name_->setString(title_);
+}
+
+SliderFilterButton::SliderFilterButton(std::unique_ptr<IText> name, std::unique_ptr<IFont> font, 
+                                       const std::string& title, std::vector<SliderParameters> sliders, 
+                                       FilterFactory filterFactory, FilterPreview::Halo halo,
+                                       FilterPreview::Tiling tiling)
+    : title_(title), sliders_(std::move(sliders)), filter_(), filterFactory_(std::move(filterFactory)),
+      halo_(std::move(halo)), tiling_(std::move(tiling))
+{
+    assert(filterFactory_);
+    assert(halo_);
+
+    name_ = std::move(name);
+    font_ = std::move(font);
+
+    name_->setString(title_);
+}
+
+std::unique_ptr<IAction> SliderFilterButton::createAction(const IRenderWindow* renderWindow, 
+                                                          const Event& event)
+{
+    return std::make_unique<UpdateCallbackAction<SliderFilterButton>>(*this, renderWindow, event);
+}
+
+bool SliderFilterButton::update(const IRenderWindow* renderWindow, const Event& event)
+{
+    bool updateStateRes = updateState(renderWindow, event);
+
+    ICanvas* canvas = static_cast<ICanvas*>(getRootWindow()->getWindowById(kCanvasWindowId));
+    assert(canvas);
+
+    if (state_ != State::Released)
+    {
+        if (filterWindow_)
+        {
+            filterWindow_->close();
+            filterWindow_.reset();
+            preview_.cancel(canvas);
+        }
+
+        return updateStateRes;
+    }
+
+    if (updateStateRes)
+    {
+        // previous run is not finished yet
+        if (commitRun_ && !commitRun_->isDone())
+        {
+            state_ = State::Normal;
+            return true;
+        }
+
+        if (filterFactory_)
+            filter_ = ignorePlacement(filterFactory_());
+
+        preview_.begin(canvas, title_, filter_, halo_, tiling_);
+        filterWindow_ = createSlidersFilterWindow(title_.c_str(), sliders_);
+    }
+
+    assert(filterWindow_);
+
+    AActionController* actionController = getActionController();
+
+    if (!actionController->execute(filterWindow_->createAction(renderWindow, event)))
+    {
+        if (filterWindow_->isConfirmed())
+            commitRun_ = preview_.commit(canvas);
+        else
+            preview_.cancel(canvas);
+
+        filterWindow_.reset();
+        state_ = State::Normal;
+        return false;
+    }
+
+    preview_.setParameters(getSlidersValues(filterWindow_.get(), sliders_));
+    preview_.update(canvas);
+
+    return true;
+}
+
+void SliderFilterButton::draw(IRenderWindow* renderWindow)
+{
+    name_->setString(getJobTitle(title_, commitRun_.get()));
+
+    ANamedBarButton::draw(renderWindow);
+
+    if (filterWindow_)
+        filterWindow_->draw(renderWindow);
+}
+
+} // namespace ps
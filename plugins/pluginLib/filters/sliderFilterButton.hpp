@@ -0,0 +1,61 @@
+#ifndef PLUGINS_PLUGIN_LIB_FILTERS_SLIDER_FILTER_BUTTON_HPP
+#define PLUGINS_PLUGIN_LIB_FILTERS_SLIDER_FILTER_BUTTON_HPP
+
+#include "api/api_bar.hpp"
+
+#include "pluginLib/bars/ps_bar.hpp"
+#include "pluginLib/filters/filterJobs.hpp"
+#include "pluginLib/filters/filterPreview.hpp"
+#include "pluginLib/filters/filterWindows.hpp"
+#include "pluginLib/filters/tiledLayerFilter.hpp"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ps
+{
+
+// Menu button of a filter with slider parameters. Opens window with sliders, shows live preview
+// while they are dragged and applies filter to the whole layer in background on "Ok". Slider values
+// are passed to the filter in the order of sliders.
+class SliderFilterButton : public ANamedBarButton
+{
+public:
+    // makes the filter every time the window is opened, for filters with data to be loaded on each use
+    using FilterFactory = std::function<FilterPreview::Filter()>;
+
+    SliderFilterButton(std::unique_ptr<IText> name, std::unique_ptr<IFont> font, const std::string& title,
+                       std::vector<SliderParameters> sliders, FilterPreview::Filter filter,
+                       FilterPreview::Halo halo, FilterPreview::Tiling tiling = nullptr);
+    SliderFilterButton(std::unique_ptr<IText> name, std::unique_ptr<IFont> font, const std::string& title,
+                       std::vector<SliderParameters> sliders, FilterPreview::PlacedFilter filter,
+                       FilterPreview::Halo halo, FilterPreview::Tiling tiling = nullptr);
+    SliderFilterButton(std::unique_ptr<IText> name, std::unique_ptr<IFont> font, const std::string& title,
+                       std::vector<SliderParameters> sliders, FilterFactory filterFactory,
+                       FilterPreview::Halo halo, FilterPreview::Tiling tiling = nullptr);
+
+    std::unique_ptr<IAction> createAction(const IRenderWindow* renderWindow, 
+                                          const Event& event) override;
+    
+    bool update(const IRenderWindow* renderWindow, const Event& event);
+    void draw(IRenderWindow* renderWindow) override;
+
+private:
+    std::string title_;
+    std::vector<SliderParameters> sliders_;
+    FilterPreview::PlacedFilter filter_;
+    FilterFactory filterFactory_;
+    FilterPreview::Halo halo_;
+    FilterPreview::Tiling tiling_;
+
+    std::unique_ptr<FilterWindow> filterWindow_;
+    FilterPreview preview_;
+
+    std::shared_ptr<TiledLayerFilter> commitRun_;
+};
+
+} // namespace ps
+
+#endif // PLUGINS_PLUGIN_LIB_FILTERS_SLIDER_FILTER_BUTTON_HPP
@@ -0,0 +1,104 @@
+#include "summedAreaTable.hpp"
+
+#include "pluginLib/filters/filterExecutor.hpp"
+
+namespace ps
+{
+
+namespace
+{
+
+const size_t kBandRows = 64;
+
+void addSums(ChannelSums& sums, const ChannelSums& other)
+{
+    sums.r += other.r;
+    sums.g += other.g;
+    sums.b += other.b;
+    sums.a += other.a;
+}
+
+} // namespace anonymous
+
+SummedAreaTable::SummedAreaTable(const Pixels2D& pixels)
+{
+    height_ = pixels.size();
+    width_  = height_ > 0 ? pixels[0].size() : 0;
+
+    const size_t stride = width_ + 1;
+    table_.assign((height_ + 1) * stride, ChannelSums{});
+
+    if (width_ == 0)
+        return;
+
+    const size_t bandsCount = (height_ + kBandRows - 1) / kBandRows;
+
+    // every band is summed as if it was the top of the image
+    parallelForRows(bandsCount, [&](size_t bandBegin, size_t bandEnd)
+    {
+        for (size_t band = bandBegin; band < bandEnd; ++band)
+        {
+            size_t rowBegin = band * kBandRows;
+            size_t rowEnd   = std::min(rowBegin + kBandRows, height_);
+
+            for (size_t y = rowBegin; y < rowEnd; ++y)
+            {
+                const std::vector<Color>& row = pixels[y];
+                assert(row.size() == width_);
+
+                ChannelSums* sums = table_.data() + (y + 1) * stride;
+                const ChannelSums* above = y > rowBegin ? sums - stride : nullptr;
+
+                ChannelSums rowSums;
+
+                for (size_t x = 0; x < width_; ++x)
+                {
+                    rowSums.r += row[x].r;
+                    rowSums.g += row[x].g;
+                    rowSums.b += row[x].b;
+                    rowSums.a += row[x].a;
+
+                    sums[x + 1] = rowSums;
+
+                    if (above)
+                        addSums(sums[x + 1], above[x + 1]);
+                }
+            }
+        }
+    });
+
+    // last rows of the bands become absolute one after another
+    for (size_t band = 1; band < bandsCount; ++band)
+    {
+        size_t lastRow      = std::min((band + 1) * kBandRows, height_);
+        size_t lastRowAbove = band * kBandRows;
+
+        ChannelSums* sums = table_.data() + lastRow * stride;
+        const ChannelSums* above = table_.data() + lastRowAbove * stride;
+
+        for (size_t x = 1; x <= width_; ++x)
+            addSums(sums[x], above[x]);
+    }
+
+    // the rest of every band gets the last row of the band above it
+    parallelForRows(bandsCount, [&](size_t bandBegin, size_t bandEnd)
+    {
+        for (size_t band = std::max(bandBegin, size_t{1}); band < bandEnd; ++band)
+        {
+            size_t rowBegin = band * kBandRows;
+            size_t lastRow  = std::min(rowBegin + kBandRows, height_);
+
+            const ChannelSums* above = table_.data() + rowBegin * stride;
+
+            for (size_t y = rowBegin + 1; y < lastRow; ++y)
+            {
+                ChannelSums* sums = table_.data() + y * stride;
+
+                for (size_t x = 1; x <= width_; ++x)
+                    addSums(sums[x], above[x]);
+            }
+        }
+    });
+}
+
+} // namespace ps
@@ -0,0 +1,86 @@
+#ifndef PLUGINS_PLUGIN_LIB_FILTERS_SUMMED_AREA_TABLE_HPP
+#define PLUGINS_PLUGIN_LIB_FILTERS_SUMMED_AREA_TABLE_HPP
+
+#include "pluginLib/filters/filterGraph.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace ps
+{
+
+struct ChannelSums
+{
+    uint64_t r = 0;
+    uint64_t g = 0;
+    uint64_t b = 0;
+    uint64_t a = 0;
+};
+
+// Integral image: entry (x, y) holds the channel sums of [0, x) x [0, y), so any rectangle sum is four
+// lookups. Sums are 64-bit, 32-bit ones overflow starting from about 4k x 4k white pixels.
+// Built in bands of rows in parallel, then every band is offset by the sums of the bands above it.
+class SummedAreaTable
+{
+public:
+    explicit SummedAreaTable(const Pixels2D& pixels);
+
+    size_t getWidth () const { return width_;  }
+    size_t getHeight() const { return height_; }
+
+    // [left, right) x [top, bottom), has to be inside the image
+    ChannelSums rectSum(size_t left, size_t top, size_t right, size_t bottom) const
+    {
+        assert(left <= right && right <= width_);
+        assert(top <= bottom && bottom <= height_);
+
+        const ChannelSums& topLeft     = at(left,  top);
+        const ChannelSums& topRight    = at(right, top);
+        const ChannelSums& bottomLeft  = at(left,  bottom);
+        const ChannelSums& bottomRight = at(right, bottom);
+
+        ChannelSums sums;
+
+        sums.r = bottomRight.r - bottomLeft.r - topRight.r + topLeft.r;
+        sums.g = bottomRight.g - bottomLeft.g - topRight.g + topLeft.g;
+        sums.b = bottomRight.b - bottomLeft.b - topRight.b + topLeft.b;
+        sums.a = bottomRight.a - bottomLeft.a - topRight.a + topLeft.a;
+
+        return sums;
+    }
+
+    // rounded average of the part of [left, right) x [top, bottom) inside the image
+    Color rectMean(int left, int top, int right, int bottom) const
+    {
+        size_t clampedLeft = clampColumn(left), clampedRight  = clampColumn(right);
+        size_t clampedTop  = clampRow(top),     clampedBottom = clampRow(bottom);
+
+        uint64_t area = (clampedRight - clampedLeft) * (clampedBottom - clampedTop);
+        if (area == 0)
+            return Color{0, 0, 0, 0};
+
+        ChannelSums sums = rectSum(clampedLeft, clampedTop, clampedRight, clampedBottom);
+
+        auto mean = [area](uint64_t sum) { return static_cast<uint8_t>((sum + area / 2) / area); };
+
+        return Color{mean(sums.r), mean(sums.g), mean(sums.b), mean(sums.a)};
+    }
+
+private:
+    const ChannelSums& at(size_t x, size_t y) const { return table_[y * (width_ + 1) + x]; }
+
+    size_t clampColumn(int x) const { return static_cast<size_t>(std::clamp(x, 0, static_cast<int>(width_)));  }
+    size_t clampRow   (int y) const { return static_cast<size_t>(std::clamp(y, 0, static_cast<int>(height_))); }
+
+private:
+    size_t width_  = 0;
+    size_t height_ = 0;
+
+    std::vector<ChannelSums> table_; // (height_ + 1) rows of (width_ + 1) entries
+};
+
+} // namespace ps
+
+#endif // PLUGINS_PLUGIN_LIB_FILTERS_SUMMED_AREA_TABLE_HPP
@@ -0,0 +1,234 @@
+#include "tiledLayerFilter.hpp"
+
+#include "api/api_actions.hpp"
+
+#include "pluginLib/canvas/canvas.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace ps
+{
+
+namespace
+{
+
+// about 4 MB of pixels per tile
+const int kTilePixels  = 1024 * 1024;
+const int kMinTileRows = 16;
+
+IntRect makeRect(int left, int top, int right, int bottom)
+{
+    if (right <= left || bottom <= top)
+        return IntRect{vec2i{left, top}, vec2u{0, 0}};
+
+    vec2u size{static_cast<unsigned>(right - left), static_cast<unsigned>(bottom - top)};
+
+    return IntRect{vec2i{left, top}, size};
+}
+
+int getRight (const IntRect& rect) { return rect.pos.x + static_cast<int>(rect.size.x); }
+int getBottom(const IntRect& rect) { return rect.pos.y + static_cast<int>(rect.size.y); }
+
+// rows [rowBegin, rowEnd) and columns [columnBegin, columnEnd) of the pixels
+Pixels2D cropPixels(const Pixels2D& pixels, size_t rowBegin, size_t rowEnd, size_t columnBegin, size_t columnEnd)
+{
+    Pixels2D cropped;
+    cropped.reserve(rowEnd - rowBegin);
+
+    for (size_t y = rowBegin; y < rowEnd; ++y)
+    {
+        auto rowBeginIt = pixels[y].begin() + static_cast<long>(columnBegin);
+        cropped.emplace_back(rowBeginIt, rowBeginIt + static_cast<long>(columnEnd - columnBegin));
+    }
+
+    return cropped;
+}
+
+} // namespace anonymous
+
+std::shared_ptr<TiledLayerFilter> TiledLayerFilter::start(ICanvas* canvas, size_t layerIndex,
+                                                          Filter filter, size_t halo, LayerTiling tiling)
+{
+    auto tiledFilter = std::make_shared<TiledLayerFilter>(canvas, layerIndex, std::move(filter), halo, tiling);
+    tiledFilter->submitNextTile();
+
+    return tiledFilter;
+}
+
+TiledLayerFilter::TiledLayerFilter(ICanvas* canvas, size_t layerIndex, Filter filter, size_t halo,
+                                   LayerTiling tiling)
+    : canvas_(canvas), layerIndex_(layerIndex), filter_(std::move(filter)), halo_(static_cast<int>(halo))
+{
+    assert(canvas_);
+    assert(filter_);
+
+    layer_ = canvas_->getLayer(layerIndex_);
+    assert(layer_);
+
+    layerSize_ = getLayerFullSize(layer_, canvas_->getSize());
+    int width  = static_cast<int>(layerSize_.x);
+    int height = static_cast<int>(layerSize_.y);
+
+    region_ = makeRect(0, 0, width, height);
+
+    selection_ = getCanvasSelection(canvas_);
+    if (selection_.isActive())
+    {
+        IntRect bounds = selection_.getBounds();
+
+        region_ = makeRect(std::max(bounds.pos.x, 0), std::max(bounds.pos.y, 0),
+                           std::min(getRight(bounds), width), std::min(getBottom(bounds), height));
+    }
+
+    readRegion_ = makeRect(std::max(region_.pos.x - halo_, 0),          std::max(region_.pos.y - halo_, 0),
+                           std::min(getRight(region_) + halo_, width), std::min(getBottom(region_) + halo_, height));
+
+    tileRows_ = std::max(kMinTileRows, kTilePixels / std::max(static_cast<int>(readRegion_.size.x), 1));
+
+    assert(tiling.rowsAlignment > 0);
+    int alignment = static_cast<int>(tiling.rowsAlignment);
+    tileRows_ = (tileRows_ + alignment - 1) / alignment * alignment;
+
+    if (tiling.isWholeRegion)
+        tileRows_ = std::max(static_cast<int>(region_.size.y), 1);
+
+    tileBegin_ = nextRow_ = region_.pos.y;
+
+    IntRect haloAbove = makeRect(readRegion_.pos.x, readRegion_.pos.y, getRight(readRegion_), region_.pos.y);
+    haloAbove_ = getLayerRegion(layer_, haloAbove);
+
+    pastSnapshot_ = canvas_->save();
+}
+
+void TiledLayerFilter::cancel()
+{
+    if (job_)
+        job_->cancel();
+}
+
+bool TiledLayerFilter::isDone() const
+{
+    return isDone_;
+}
+
+float TiledLayerFilter::getProgress() const
+{
+    if (isDone_ || region_.size.y == 0)
+        return 1.f;
+
+    float tileProgress = job_ ? job_->getProgress() : 0.f;
+    float rowsDone = static_cast<float>(tileBegin_ - region_.pos.y) + 
+                     static_cast<float>(nextRow_ - tileBegin_) * tileProgress;
+
+    return rowsDone / static_cast<float>(region_.size.y);
+}
+
+ILayer* TiledLayerFilter::getLayer() const
+{
+    // layer may be removed while filter was running
+    if (layerIndex_ >= canvas_->getNumLayers())
+        return nullptr;
+
+    ILayer* layer = canvas_->getLayer(layerIndex_);
+
+    return layer == layer_ ? layer : nullptr;
+}
+
+void TiledLayerFilter::submitNextTile()
+{
+    ILayer* layer = getLayer();
+
+    if (!layer || region_.size.x == 0 || nextRow_ >= getBottom(region_))
+    {
+        complete();
+        return;
+    }
+
+    int rowBegin = nextRow_;
+    int rowEnd   = std::min(rowBegin + tileRows_, getBottom(region_));
+    int readEnd  = std::min(rowEnd + halo_, getBottom(readRegion_));
+
+    size_t topHalo = haloAbove_.size();
+
+    auto tile = std::make_shared<Pixels2D>(std::move(haloAbove_));
+    Pixels2D rows = getLayerRegion(layer, makeRect(readRegion_.pos.x, rowBegin, getRight(readRegion_), readEnd));
+
+    // source rows above the next tile will be overwritten by this one
+    int nextHaloBegin = rowEnd - std::min(halo_, rowEnd - rowBegin + static_cast<int>(topHalo));
+    haloAbove_.clear();
+
+    for (int y = nextHaloBegin; y < rowEnd; ++y)
+    {
+        haloAbove_.push_back(y >= rowBegin ? rows[static_cast<size_t>(y - rowBegin)] 
+                                           : (*tile)[topHalo - static_cast<size_t>(rowBegin - y)]);
+    }
+
+    tile->insert(tile->end(), std::make_move_iterator(rows.begin()), std::make_move_iterator(rows.end()));
+
+    tileBegin_ = rowBegin;
+    nextRow_   = rowEnd;
+
+    size_t columnBegin = static_cast<size_t>(region_.pos.x - readRegion_.pos.x);
+    size_t columnEnd   = columnBegin + region_.size.x;
+    size_t rowsEnd     = topHalo + static_cast<size_t>(rowEnd - rowBegin);
+
+    LayerPlacement placement{vec2i{readRegion_.pos.x, rowBegin - static_cast<int>(topHalo)}, layerSize_};
+
+    // jobs keep the run alive until the last tile is written
+    std::shared_ptr<TiledLayerFilter> self = shared_from_this();
+
+    job_ = getFilterJobsWindow()->submit(
+        [filter = filter_, selection = selection_, tile, topHalo, rowsEnd, columnBegin, columnEnd, placement,
+         pos = vec2i{region_.pos.x, rowBegin}]()
+        {
+            Pixels2D filtered = filter(*tile, placement);
+            assert(filtered.size() == tile->size());
+
+            Pixels2D result = cropPixels(filtered, topHalo, rowsEnd, columnBegin, columnEnd);
+            applySelection(selection, pos, cropPixels(*tile, topHalo, rowsEnd, columnBegin, columnEnd), result);
+
+            return result;
+        },
+        [self, rowBegin](const Pixels2D& result) { self->finishTile(rowBegin, result); },
+        [self]() { self->rollback(); });
+}
+
+void TiledLayerFilter::finishTile(int rowBegin, const Pixels2D& tile)
+{
+    ILayer* layer = getLayer();
+
+    if (!layer)
+    {
+        complete();
+        return;
+    }
+
+    setLayerRegion(layer, vec2i{region_.pos.x, rowBegin}, tile);
+    hasChanges_ = true;
+
+    submitNextTile();
+}
+
+void TiledLayerFilter::complete()
+{
+    job_.reset();
+    isDone_ = true;
+
+    if (!hasChanges_ || !getLayer())
+        return;
+
+    auto canvasSaving = std::make_unique<CanvasSaverAction>(std::move(pastSnapshot_), canvas_->save());
+    getActionController()->execute(std::move(canvasSaving));
+}
+
+void TiledLayerFilter::rollback()
+{
+    job_.reset();
+    isDone_ = true;
+
+    if (hasChanges_)
+        canvas_->restore(pastSnapshot_.get());
+}
+
+} // namespace ps
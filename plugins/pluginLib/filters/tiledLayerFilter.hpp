@@ -0,0 +1,101 @@
+#ifndef PLUGINS_PLUGIN_LIB_FILTERS_TILED_LAYER_FILTER_HPP
+#define PLUGINS_PLUGIN_LIB_FILTERS_TILED_LAYER_FILTER_HPP
+
+#include "api/api_canvas.hpp"
+
+#include "pluginLib/filters/filterGraph.hpp"
+#include "pluginLib/filters/filterJobs.hpp"
+#include "pluginLib/selection/selection.hpp"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace ps
+{
+
+using namespace psapi;
+using namespace psapi::sfm;
+
+// Where the filtered pixels are: layer position of the first pixel and size of the whole layer
+struct LayerPlacement
+{
+    vec2i pos;
+    vec2u layerSize;
+};
+
+// How the region is cut into tiles of full rows
+struct LayerTiling
+{
+    // tiles start at multiples of it from the region top, for filters working on blocks of rows
+    size_t rowsAlignment = 1;
+
+    // the whole region is one tile, for filters that need all of its pixels at once
+    bool isWholeRegion = false;
+
+    static LayerTiling alignedRows(size_t rowsAlignment) { return LayerTiling{rowsAlignment, false}; }
+    static LayerTiling wholeRegion() { return LayerTiling{1, true}; }
+};
+
+// Applies filter to the whole layer, not only to its visible part. When canvas has active selection,
+// only its bounds are processed and only the selected pixels are changed. Region is streamed in tiles
+// of full rows: every tile is read with halo pixels around it and filtered in a background job,
+// so working memory is bounded by the tile size, not by the layer size. Layer is read and written
+// only on the UI thread between the jobs. The whole run is one undoable action, cancelled run
+// restores the layer.
+class TiledLayerFilter : public std::enable_shared_from_this<TiledLayerFilter>
+{
+public:
+    // gets tile with halo and its placement, result has the same size, filter must not touch windows
+    using Filter = std::function<Pixels2D(const Pixels2D& pixels, const LayerPlacement& placement)>;
+
+    // halo - how many pixels around a pixel the filter reads
+    static std::shared_ptr<TiledLayerFilter> start(ICanvas* canvas, size_t layerIndex, 
+                                                   Filter filter, size_t halo, LayerTiling tiling = LayerTiling{});
+
+    void cancel();
+
+    bool isDone() const;
+    float getProgress() const;
+
+    // use start
+    TiledLayerFilter(ICanvas* canvas, size_t layerIndex, Filter filter, size_t halo, LayerTiling tiling);
+
+private:
+    ILayer* getLayer() const;
+
+    void submitNextTile();
+    void finishTile(int rowBegin, const Pixels2D& tile);
+
+    void complete();
+    void rollback();
+
+private:
+    ICanvas* canvas_;
+    size_t layerIndex_;
+    ILayer* layer_;
+
+    Filter filter_;
+    int halo_;
+
+    Selection selection_;
+
+    vec2u layerSize_;
+    IntRect region_;     // pixels that may change
+    IntRect readRegion_; // region with halo, clipped by the layer
+    int tileRows_ = 0;
+
+    int tileBegin_ = 0; // rows of the running job are [tileBegin_, nextRow_)
+    int nextRow_   = 0;
+    Pixels2D haloAbove_; // source rows above nextRow_, layer already has filtered ones there
+
+    std::unique_ptr<ICanvasSnapshot> pastSnapshot_;
+    std::shared_ptr<FilterJob> job_;
+
+    bool hasChanges_ = false;
+    bool isDone_     = false;
+};
+
+} // namespace ps
+
+#endif // PLUGINS_PLUGIN_LIB_FILTERS_TILED_LAYER_FILTER_HPP
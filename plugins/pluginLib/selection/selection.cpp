@@ -0,0 +1,206 @@
+#include "selection.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace ps
+{
+
+namespace
+{
+
+// sliding window sum of 2 * radius + 1 values, values outside are 0
+void boxBlurLine(const uint16_t* source, uint16_t* destination, size_t size, size_t stride, unsigned radius)
+{
+    const unsigned window = 2 * radius + 1;
+    unsigned sum = 0;
+
+    for (size_t i = 0; i < std::min(static_cast<size_t>(radius), size); ++i)
+        sum += source[i * stride];
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        if (i + radius < size)
+            sum += source[(i + radius) * stride];
+
+        destination[i * stride] = static_cast<uint16_t>((sum + window / 2) / window);
+
+        if (i >= radius)
+            sum -= source[(i - radius) * stride];
+    }
+}
+
+// binary mask blurred by box filter in both directions
+std::shared_ptr<const FeatherMask> buildFeatherMask(const SelectionMask& mask, unsigned radius)
+{
+    auto feather = std::make_shared<FeatherMask>();
+
+    IntRect maskBounds = mask.getBounds();
+    int grow = static_cast<int>(radius);
+
+    feather->bounds.pos  = maskBounds.pos - vec2i{grow, grow};
+    feather->bounds.size = maskBounds.size + vec2u{2 * radius, 2 * radius};
+
+    size_t width  = feather->bounds.size.x;
+    size_t height = feather->bounds.size.y;
+
+    std::vector<uint16_t> values(width * height, 0);
+    std::vector<uint16_t> blurred(width * height, 0);
+
+    for (size_t y = 0; y < height; ++y)
+    {
+        int maskY = feather->bounds.pos.y + static_cast<int>(y);
+
+        for (const SelectionSpan& span : mask.getRow(maskY))
+        {
+            auto begin = values.begin() + static_cast<long>(y * width) + (span.begin - feather->bounds.pos.x);
+            std::fill(begin, begin + (span.end - span.begin), uint16_t{255});
+        }
+    }
+
+    for (size_t y = 0; y < height; ++y)
+        boxBlurLine(values.data() + y * width, blurred.data() + y * width, width, 1, radius);
+
+    for (size_t x = 0; x < width; ++x)
+        boxBlurLine(blurred.data() + x, values.data() + x, height, width, radius);
+
+    feather->alpha.assign(values.begin(), values.end());
+
+    return feather;
+}
+
+} // namespace anonymous
+
+// Feather mask implementation
+
+uint8_t FeatherMask::get(const vec2i& pos) const
+{
+    vec2i local = pos - bounds.pos;
+
+    if (local.x < 0 || local.y < 0 ||
+        local.x >= static_cast<int>(bounds.size.x) || local.y >= static_cast<int>(bounds.size.y))
+        return 0;
+
+    return alpha[static_cast<size_t>(local.y) * bounds.size.x + static_cast<size_t>(local.x)];
+}
+
+// Selection implementation
+
+Selection::Selection(SelectionMask mask, unsigned featherRadius)
+    : mask_(std::move(mask)), featherRadius_(featherRadius)
+{
+    if (featherRadius_ > 0 && !mask_.isEmpty())
+        feather_ = buildFeatherMask(mask_, featherRadius_);
+}
+
+bool Selection::isActive() const
+{
+    return !mask_.isEmpty();
+}
+
+const SelectionMask& Selection::getMask() const
+{
+    return mask_;
+}
+
+unsigned Selection::getFeatherRadius() const
+{
+    return featherRadius_;
+}
+
+uint8_t Selection::getCoverage(const vec2i& pos) const
+{
+    if (!isActive())
+        return 255;
+
+    if (feather_)
+        return feather_->get(pos);
+
+    return mask_.contains(pos) ? 255 : 0;
+}
+
+IntRect Selection::getBounds() const
+{
+    return feather_ ? feather_->bounds : mask_.getBounds();
+}
+
+// Functions
+
+Selection getCanvasSelection(const ICanvas* canvas)
+{
+    auto selectableCanvas = dynamic_cast<const ISelectableCanvas*>(canvas);
+
+    return selectableCanvas ? selectableCanvas->getSelection() : Selection{};
+}
+
+void setCanvasSelection(ICanvas* canvas, const Selection& selection)
+{
+    auto selectableCanvas = dynamic_cast<ISelectableCanvas*>(canvas);
+
+    if (selectableCanvas)
+        selectableCanvas->setSelection(selection);
+}
+
+Color blendColors(Color from, Color to, uint8_t alpha)
+{
+    auto blend = [alpha](uint8_t fromChannel, uint8_t toChannel)
+    {
+        return static_cast<uint8_t>((fromChannel * (255 - alpha) + toChannel * alpha + 127) / 255);
+    };
+
+    Color result = to;
+
+    result.r = blend(from.r, to.r);
+    result.g = blend(from.g, to.g);
+    result.b = blend(from.b, to.b);
+    result.a = blend(from.a, to.a);
+
+    return result;
+}
+
+void applySelection(const Selection& selection, const vec2i& pos,
+                    const std::vector<std::vector<Color>>& original, std::vector<std::vector<Color>>& filtered)
+{
+    assert(original.size() == filtered.size());
+
+    if (!selection.isActive())
+        return;
+
+    bool isFeathered = selection.getFeatherRadius() > 0;
+
+    for (size_t y = 0; y < filtered.size(); ++y)
+    {
+        std::vector<Color>& row = filtered[y];
+        const std::vector<Color>& originalRow = original[y];
+        assert(row.size() == originalRow.size());
+
+        int layerY = pos.y + static_cast<int>(y);
+        int width  = static_cast<int>(row.size());
+
+        if (isFeathered)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                size_t index = static_cast<size_t>(x);
+                row[index] = blendColors(originalRow[index], row[index], selection.getCoverage({pos.x + x, layerY}));
+            }
+
+            continue;
+        }
+
+        // gaps between the spans get original pixels back
+        int gapBegin = 0;
+
+        for (const SelectionSpan& span : selection.getMask().getRow(layerY))
+        {
+            int gapEnd = std::clamp(span.begin - pos.x, 0, width);
+            std::copy(originalRow.begin() + gapBegin, originalRow.begin() + gapEnd, row.begin() + gapBegin);
+
+            gapBegin = std::clamp(span.end - pos.x, gapBegin, width);
+        }
+
+        std::copy(originalRow.begin() + gapBegin, originalRow.end(), row.begin() + gapBegin);
+    }
+}
+
+} // namespace ps
@@ -0,0 +1,78 @@
+#ifndef PLUGINS_PLUGIN_LIB_SELECTION_SELECTION_HPP
+#define PLUGINS_PLUGIN_LIB_SELECTION_SELECTION_HPP
+
+#include "api/api_canvas.hpp"
+#include "api/api_sfm.hpp"
+
+#include "pluginLib/selection/selectionMask.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ps
+{
+
+using namespace psapi;
+using namespace psapi::sfm;
+
+// 8-bit mask of the feathered selection inside bounds, 255 - fully selected
+struct FeatherMask
+{
+    IntRect bounds;
+    std::vector<uint8_t> alpha; // row by row
+
+    uint8_t get(const vec2i& pos) const;
+};
+
+// What tools and filters may change, in the full layer coordinates. Default selection is
+// inactive - the whole layer is editable.
+class Selection
+{
+public:
+    Selection() = default;
+    Selection(SelectionMask mask, unsigned featherRadius);
+
+    bool isActive() const;
+
+    const SelectionMask& getMask() const;
+    unsigned getFeatherRadius() const;
+
+    // 0 - pixel can't be changed, 255 - fully editable
+    uint8_t getCoverage(const vec2i& pos) const;
+
+    // pixels outside of the bounds can't be changed, inactive selection has no bounds
+    IntRect getBounds() const;
+
+private:
+    SelectionMask mask_;
+    unsigned featherRadius_ = 0;
+
+    // built once, copies of the selection share it
+    std::shared_ptr<const FeatherMask> feather_;
+};
+
+// Implemented by canvas in addition to ICanvas
+class ISelectableCanvas
+{
+public:
+    virtual const Selection& getSelection() const = 0;
+    virtual void setSelection(const Selection& selection) = 0;
+
+    virtual ~ISelectableCanvas() = default;
+};
+
+// inactive selection if canvas doesn't support selections
+Selection getCanvasSelection(const ICanvas* canvas);
+void setCanvasSelection(ICanvas* canvas, const Selection& selection);
+
+// filtered - new pixels of the region at pos. Pixels outside of the selection are restored from original,
+// ones on the feathered edge are blended with it. Unfeathered selection visits only the gaps between spans.
+void applySelection(const Selection& selection, const vec2i& pos,
+                    const std::vector<std::vector<Color>>& original, std::vector<std::vector<Color>>& filtered);
+
+Color blendColors(Color from, Color to, uint8_t alpha);
+
+} // namespace ps
+
+#endif // PLUGINS_PLUGIN_LIB_SELECTION_SELECTION_HPP
@@ -0,0 +1,62 @@
+#include "selectionLayer.hpp"
+
+#include <cassert>
+
+namespace ps
+{
+
+SelectionLayer::SelectionLayer(ILayer* layer, const Selection& selection, const vec2i& visiblePos)
+    : layer_(layer), selection_(selection), visiblePos_(visiblePos)
+{
+    assert(layer_);
+}
+
+Color SelectionLayer::getPixel(vec2i pos) const
+{
+    return layer_->getPixel(pos);
+}
+
+void SelectionLayer::setPixel(vec2i pos, Color pixel)
+{
+    uint8_t coverage = selection_.getCoverage(pos + visiblePos_);
+
+    if (coverage == 0)
+        return;
+
+    if (coverage != 255)
+        pixel = blendColors(layer_->getPixel(pos), pixel, coverage);
+
+    layer_->setPixel(pos, pixel);
+}
+
+drawable_id_t SelectionLayer::addDrawable(std::unique_ptr<Drawable> object)
+{
+    return layer_->addDrawable(std::move(object));
+}
+
+void SelectionLayer::removeDrawable(drawable_id_t id)
+{
+    layer_->removeDrawable(id);
+}
+
+void SelectionLayer::removeAllDrawables()
+{
+    layer_->removeAllDrawables();
+}
+
+vec2u SelectionLayer::getSize() const
+{
+    return layer_->getSize();
+}
+
+std::unique_ptr<ILayerSnapshot> SelectionLayer::save()
+{
+    return layer_->save();
+}
+
+void SelectionLayer::restore(ILayerSnapshot* snapshot)
+{
+    layer_->restore(snapshot);
+}
+
+} // namespace ps
@@ -0,0 +1,42 @@
+#ifndef PLUGINS_PLUGIN_LIB_SELECTION_SELECTION_LAYER_HPP
+#define PLUGINS_PLUGIN_LIB_SELECTION_SELECTION_LAYER_HPP
+
+#include "api/api_canvas.hpp"
+
+#include "pluginLib/selection/selection.hpp"
+
+namespace ps
+{
+
+using namespace psapi;
+using namespace psapi::sfm;
+
+// Layer seen by drawing tools when selection is active: pixels outside of the selection are not
+// changed, feathered edge is blended. Everything else is forwarded to the real layer.
+class SelectionLayer : public ILayer
+{
+public:
+    // visiblePos - position of the visible part inside the full layer
+    SelectionLayer(ILayer* layer, const Selection& selection, const vec2i& visiblePos);
+
+    Color getPixel(vec2i pos) const override;
+    void  setPixel(vec2i pos, Color pixel) override;
+
+    drawable_id_t addDrawable(std::unique_ptr<Drawable> object) override;
+    void removeDrawable(drawable_id_t id) override;
+    void removeAllDrawables() override;
+
+    vec2u getSize() const override;
+
+    std::unique_ptr<ILayerSnapshot> save() override;
+    void restore(ILayerSnapshot* snapshot) override;
+
+private:
+    ILayer* layer_;
+    const Selection& selection_;
+    vec2i visiblePos_;
+};
+
+} // namespace ps
+
+#endif // PLUGINS_PLUGIN_LIB_SELECTION_SELECTION_LAYER_HPP
@@ -0,0 +1,440 @@
+#include "selectionMask.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <cmath>
+
+namespace ps
+{
+
+namespace
+{
+
+const SelectionSpans kEmptyRow;
+
+// sorts spans and merges the overlapping and touching ones
+void normalizeSpans(SelectionSpans& spans)
+{
+    std::sort(spans.begin(), spans.end(), [](const SelectionSpan& lhs, const SelectionSpan& rhs)
+    {
+        return lhs.begin < rhs.begin;
+    });
+
+    SelectionSpans merged;
+
+    for (const SelectionSpan& span : spans)
+    {
+        if (span.begin >= span.end)
+            continue;
+
+        if (!merged.empty() && span.begin <= merged.back().end)
+            merged.back().end = std::max(merged.back().end, span.end);
+        else
+            merged.push_back(span);
+    }
+
+    spans.swap(merged);
+}
+
+// spans are alternating boundaries: begin of the first span, its end, begin of the second one...
+int getBoundary(const SelectionSpans& spans, size_t index)
+{
+    const SelectionSpan& span = spans[index / 2];
+    return index % 2 == 0 ? span.begin : span.end;
+}
+
+// one sweep over the boundaries of both rows
+template <typename Operation>
+SelectionSpans combineRows(const SelectionSpans& lhs, const SelectionSpans& rhs, Operation operation)
+{
+    SelectionSpans result;
+
+    size_t lhsBoundaries = 2 * lhs.size();
+    size_t rhsBoundaries = 2 * rhs.size();
+
+    size_t lhsIndex = 0;
+    size_t rhsIndex = 0;
+
+    bool inLhs = false;
+    bool inRhs = false;
+    bool inResult = false;
+
+    while (lhsIndex < lhsBoundaries || rhsIndex < rhsBoundaries)
+    {
+        int x = std::min(lhsIndex < lhsBoundaries ? getBoundary(lhs, lhsIndex) : INT_MAX,
+                         rhsIndex < rhsBoundaries ? getBoundary(rhs, rhsIndex) : INT_MAX);
+
+        while (lhsIndex < lhsBoundaries && getBoundary(lhs, lhsIndex) == x)
+        {
+            inLhs = !inLhs;
+            ++lhsIndex;
+        }
+
+        while (rhsIndex < rhsBoundaries && getBoundary(rhs, rhsIndex) == x)
+        {
+            inRhs = !inRhs;
+            ++rhsIndex;
+        }
+
+        bool inResultNow = operation(inLhs, inRhs);
+
+        if (inResultNow && !inResult)
+            result.push_back({x, x});
+        else if (!inResultNow && inResult)
+            result.back().end = x;
+
+        inResult = inResultNow;
+    }
+
+    return result;
+}
+
+SelectionSpans shrinkSpans(const SelectionSpans& spans)
+{
+    SelectionSpans shrunk;
+
+    for (const SelectionSpan& span : spans)
+    {
+        if (span.end - span.begin > 2)
+            shrunk.push_back({span.begin + 1, span.end - 1});
+    }
+
+    return shrunk;
+}
+
+} // namespace anonymous
+
+// Shapes
+
+SelectionMask SelectionMask::createRectangle(const vec2i& topLeft, const vec2i& bottomRight)
+{
+    int left   = std::min(topLeft.x, bottomRight.x);
+    int right  = std::max(topLeft.x, bottomRight.x);
+    int top    = std::min(topLeft.y, bottomRight.y);
+    int bottom = std::max(topLeft.y, bottomRight.y);
+
+    SelectionMask mask;
+    mask.top_ = top;
+    mask.rows_.assign(static_cast<size_t>(bottom - top + 1), SelectionSpans{{left, right + 1}});
+
+    return mask;
+}
+
+SelectionMask SelectionMask::createEllipse(const vec2i& topLeft, const vec2i& bottomRight)
+{
+    int left   = std::min(topLeft.x, bottomRight.x);
+    int right  = std::max(topLeft.x, bottomRight.x);
+    int top    = std::min(topLeft.y, bottomRight.y);
+    int bottom = std::max(topLeft.y, bottomRight.y);
+
+    double radiusX = static_cast<double>(right - left + 1) / 2;
+    double radiusY = static_cast<double>(bottom - top + 1) / 2;
+
+    double centerX = left + radiusX;
+    double centerY = top  + radiusY;
+
+    SelectionMask mask;
+    mask.top_ = top;
+    mask.rows_.resize(static_cast<size_t>(bottom - top + 1));
+
+    for (int y = top; y <= bottom; ++y)
+    {
+        double dy = (y + 0.5 - centerY) / radiusY;
+        if (std::abs(dy) >= 1)
+            continue;
+
+        double halfWidth = radiusX * std::sqrt(1 - dy * dy);
+
+        int begin = static_cast<int>(std::lround(centerX - halfWidth));
+        int end   = static_cast<int>(std::lround(centerX + halfWidth));
+
+        if (begin < end)
+            mask.rows_[static_cast<size_t>(y - top)].push_back({begin, end});
+    }
+
+    mask.trim();
+
+    return mask;
+}
+
+SelectionMask SelectionMask::createPolygon(const std::vector<vec2i>& points)
+{
+    SelectionMask mask;
+
+    if (points.size() < 3)
+        return mask;
+
+    auto [minPoint, maxPoint] = std::minmax_element(points.begin(), points.end(), 
+                                                    [](const vec2i& lhs, const vec2i& rhs) { return lhs.y < rhs.y; });
+
+    int top    = minPoint->y;
+    int bottom = maxPoint->y;
+
+    mask.top_ = top;
+    mask.rows_.resize(static_cast<size_t>(bottom - top + 1));
+
+    std::vector<double> crossings;
+
+    for (int y = top; y <= bottom; ++y)
+    {
+        // pixel centers are sampled
+        double scanY = y + 0.5;
+        crossings.clear();
+
+        for (size_t i = 0; i < points.size(); ++i)
+        {
+            const vec2i& from = points[i];
+            const vec2i& to   = points[(i + 1) % points.size()];
+
+            if ((from.y <= scanY) == (to.y <= scanY))
+                continue;
+
+            double t = (scanY - from.y) / static_cast<double>(to.y - from.y);
+            crossings.push_back(from.x + t * (to.x - from.x));
+        }
+
+        std::sort(crossings.begin(), crossings.end());
+
+        SelectionSpans& row = mask.rows_[static_cast<size_t>(y - top)];
+
+        for (size_t i = 0; i + 1 < crossings.size(); i += 2)
+        {
+            row.push_back({static_cast<int>(std::lround(crossings[i])), 
+                           static_cast<int>(std::lround(crossings[i + 1]))});
+        }
+
+        normalizeSpans(row);
+    }
+
+    mask.trim();
+
+    return mask;
+}
+
+SelectionMask SelectionMask::createFromPlane(const vec2i& pos, size_t width, const std::vector<uint8_t>& values)
+{
+    SelectionMask mask;
+
+    if (width == 0)
+        return mask;
+
+    assert(values.size() % width == 0);
+
+    mask.top_ = pos.y;
+    mask.rows_.resize(values.size() / width);
+
+    for (size_t y = 0; y < mask.rows_.size(); ++y)
+    {
+        const uint8_t* row = values.data() + y * width;
+        SelectionSpans& spans = mask.rows_[y];
+
+        size_t x = 0;
+
+        while (x < width)
+        {
+            while (x < width && row[x] == 0)
+                ++x;
+
+            size_t begin = x;
+
+            while (x < width && row[x] != 0)
+                ++x;
+
+            if (begin < x)
+                spans.push_back({pos.x + static_cast<int>(begin), pos.x + static_cast<int>(x)});
+        }
+    }
+
+    mask.trim();
+
+    return mask;
+}
+
+// Boolean operations
+
+template <typename Operation>
+SelectionMask SelectionMask::combine(const SelectionMask& lhs, const SelectionMask& rhs, Operation operation)
+{
+    SelectionMask result;
+
+    if (lhs.isEmpty() && rhs.isEmpty())
+        return result;
+
+    int top    = std::min(lhs.isEmpty() ? INT_MAX : lhs.getTop(),    rhs.isEmpty() ? INT_MAX : rhs.getTop());
+    int bottom = std::max(lhs.isEmpty() ? INT_MIN : lhs.getBottom(), rhs.isEmpty() ? INT_MIN : rhs.getBottom());
+
+    result.top_ = top;
+    result.rows_.resize(static_cast<size_t>(bottom - top));
+
+    for (int y = top; y < bottom; ++y)
+        result.rows_[static_cast<size_t>(y - top)] = combineRows(lhs.getRow(y), rhs.getRow(y), operation);
+
+    result.trim();
+
+    return result;
+}
+
+SelectionMask SelectionMask::unite(const SelectionMask& other) const
+{
+    return combine(*this, other, [](bool inLhs, bool inRhs) { return inLhs || inRhs; });
+}
+
+SelectionMask SelectionMask::subtract(const SelectionMask& other) const
+{
+    return combine(*this, other, [](bool inLhs, bool inRhs) { return inLhs && !inRhs; });
+}
+
+SelectionMask SelectionMask::intersect(const SelectionMask& other) const
+{
+    return combine(*this, other, [](bool inLhs, bool inRhs) { return inLhs && inRhs; });
+}
+
+SelectionMask SelectionMask::clip(const vec2u& size) const
+{
+    if (size.x == 0 || size.y == 0)
+        return SelectionMask{};
+
+    vec2i bottomRight{static_cast<int>(size.x) - 1, static_cast<int>(size.y) - 1};
+
+    return intersect(createRectangle(vec2i{0, 0}, bottomRight));
+}
+
+SelectionMask SelectionMask::getOutline() const
+{
+    SelectionMask eroded;
+
+    if (isEmpty())
+        return eroded;
+
+    eroded.top_ = top_;
+    eroded.rows_.resize(rows_.size());
+
+    auto intersectRows = [](bool inLhs, bool inRhs) { return inLhs && inRhs; };
+
+    for (int y = getTop(); y < getBottom(); ++y)
+    {
+        SelectionSpans inner = combineRows(shrinkSpans(getRow(y)), getRow(y - 1), intersectRows);
+        eroded.rows_[static_cast<size_t>(y - top_)] = combineRows(inner, getRow(y + 1), intersectRows);
+    }
+
+    eroded.trim();
+
+    return subtract(eroded);
+}
+
+// Queries
+
+bool SelectionMask::operator==(const SelectionMask& other) const
+{
+    auto spansEqual = [](const SelectionSpans& lhs, const SelectionSpans& rhs)
+    {
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                          [](const SelectionSpan& a, const SelectionSpan& b)
+                          {
+                              return a.begin == b.begin && a.end == b.end;
+                          });
+    };
+
+    if (isEmpty() || other.isEmpty())
+        return isEmpty() && other.isEmpty();
+
+    return top_ == other.top_ && 
+           std::equal(rows_.begin(), rows_.end(), other.rows_.begin(), other.rows_.end(), spansEqual);
+}
+
+bool SelectionMask::operator!=(const SelectionMask& other) const
+{
+    return !(*this == other);
+}
+
+bool SelectionMask::isEmpty() const
+{
+    return rows_.empty();
+}
+
+bool SelectionMask::contains(const vec2i& pos) const
+{
+    const SelectionSpans& row = getRow(pos.y);
+
+    auto next = std::upper_bound(row.begin(), row.end(), pos.x, [](int x, const SelectionSpan& span)
+    {
+        return x < span.begin;
+    });
+
+    return next != row.begin() && pos.x < std::prev(next)->end;
+}
+
+size_t SelectionMask::getArea() const
+{
+    size_t area = 0;
+
+    for (const SelectionSpans& row : rows_)
+        for (const SelectionSpan& span : row)
+            area += static_cast<size_t>(span.end - span.begin);
+
+    return area;
+}
+
+IntRect SelectionMask::getBounds() const
+{
+    if (isEmpty())
+        return IntRect{};
+
+    int left  = INT_MAX;
+    int right = INT_MIN;
+
+    for (const SelectionSpans& row : rows_)
+    {
+        if (row.empty())
+            continue;
+
+        left  = std::min(left,  row.front().begin);
+        right = std::max(right, row.back().end);
+    }
+
+    vec2u size{static_cast<unsigned>(right - left), static_cast<unsigned>(rows_.size())};
+
+    return IntRect{vec2i{left, top_}, size};
+}
+
+int SelectionMask::getTop() const
+{
+    return top_;
+}
+
+int SelectionMask::getBottom() const
+{
+    return top_ + static_cast<int>(rows_.size());
+}
+
+const SelectionSpans& SelectionMask::getRow(int y) const
+{
+    if (y < getTop() || y >= getBottom())
+        return kEmptyRow;
+
+    return rows_[static_cast<size_t>(y - top_)];
+}
+
+void SelectionMask::trim()
+{
+    auto isNotEmpty = [](const SelectionSpans& row) { return !row.empty(); };
+
+    auto first = std::find_if(rows_.begin(), rows_.end(), isNotEmpty);
+
+    if (first == rows_.end())
+    {
+        rows_.clear();
+        top_ = 0;
+        return;
+    }
+
+    auto last = std::find_if(rows_.rbegin(), rows_.rend(), isNotEmpty);
+
+    top_ += static_cast<int>(first - rows_.begin());
+
+    rows_.erase(last.base(), rows_.end());
+    rows_.erase(rows_.begin(), first);
+}
+
+} // namespace ps
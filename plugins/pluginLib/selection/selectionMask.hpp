@@ -0,0 +1,81 @@
+#ifndef PLUGINS_PLUGIN_LIB_SELECTION_SELECTION_MASK_HPP
+#define PLUGINS_PLUGIN_LIB_SELECTION_SELECTION_MASK_HPP
+
+#include "api/api_sfm.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ps
+{
+
+using namespace psapi::sfm;
+
+// selected pixels [begin, end) of one row
+struct SelectionSpan
+{
+    int begin;
+    int end;
+};
+
+using SelectionSpans = std::vector<SelectionSpan>;
+
+// Binary mask stored as run-length spans per row. Spans of a row are sorted and neither overlap
+// nor touch, so boolean operations are one linear merge per row and iterating the selected pixels
+// costs in proportion to the selected area, not to the layer size.
+class SelectionMask
+{
+public:
+    SelectionMask() = default;
+
+    // corners are included
+    static SelectionMask createRectangle(const vec2i& topLeft, const vec2i& bottomRight);
+    static SelectionMask createEllipse  (const vec2i& topLeft, const vec2i& bottomRight);
+
+    // closed polygon, filled by the even-odd rule
+    static SelectionMask createPolygon(const std::vector<vec2i>& points);
+
+    // values - rows of width bytes with the top left one at pos, nonzero ones are selected
+    static SelectionMask createFromPlane(const vec2i& pos, size_t width, const std::vector<uint8_t>& values);
+
+    SelectionMask unite    (const SelectionMask& other) const;
+    SelectionMask subtract (const SelectionMask& other) const;
+    SelectionMask intersect(const SelectionMask& other) const;
+
+    // only the pixels inside [0, size)
+    SelectionMask clip(const vec2u& size) const;
+
+    // selected pixels that have unselected 4-neighbor
+    SelectionMask getOutline() const;
+
+    bool operator==(const SelectionMask& other) const;
+    bool operator!=(const SelectionMask& other) const;
+
+    bool isEmpty() const;
+    bool contains(const vec2i& pos) const;
+    size_t getArea() const;
+
+    // smallest rectangle with all the selected pixels, empty mask has empty bounds
+    IntRect getBounds() const;
+
+    int getTop() const;
+    int getBottom() const; // first row after the mask
+
+    // rows outside of the mask are empty
+    const SelectionSpans& getRow(int y) const;
+
+private:
+    template <typename Operation>
+    static SelectionMask combine(const SelectionMask& lhs, const SelectionMask& rhs, Operation operation);
+
+    void trim();
+
+private:
+    int top_ = 0;
+    std::vector<SelectionSpans> rows_; // row top_ + i
+};
+
+} // namespace ps
+
+#endif // PLUGINS_PLUGIN_LIB_SELECTION_SELECTION_MASK_HPP
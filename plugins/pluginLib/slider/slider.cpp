@@ -8,6 +8,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <string>
 
 using namespace psapi;
@@ -159,4 +160,12 @@ float SliderX::getCurrentFullness() const
     return static_cast<float>(fillColorShapeSize_.x) / static_cast<float>(fillColorShapeMaxSize_.x);
 }
 
+void SliderX::setCurrentFullness(float fullness)
+{
+    fullness = std::clamp(fullness, 0.f, 1.f);
+
+    fillColorShapeSize_.x = static_cast<unsigned>(std::lround(fullness * static_cast<float>(fillColorShapeMaxSize_.x)));
+    fillColorShape_->setSize(fillColorShapeSize_);
+}
+
 } // namespace ps
\ No newline at end of file
@@ -37,6 +37,7 @@ public:
     void setSize(const vec2u& size) override;
 
     float getCurrentFullness() const;
+    void setCurrentFullness(float fullness);
 
 public:
     static const unsigned characterSize_ = 15;
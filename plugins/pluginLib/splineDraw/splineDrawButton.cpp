@@ -1,6 +1,9 @@
 #include "splineDrawButton.hpp"
 
 #include "pluginLib/actions/actions.hpp"
+#include "pluginLib/canvas/canvas.hpp"
+#include "pluginLib/selection/selection.hpp"
+#include "pluginLib/selection/selectionLayer.hpp"
 
 #include <iostream>
 
@@ -71,10 +74,16 @@ bool SplineDrawButton::drawTrace(ICanvas* canvas)
     size_t activeLayerIndex = canvas->getActiveLayerIndex();
     ILayer* activeLayer = canvas->getLayer(activeLayerIndex);
 
+    // with active selection points are drawn only inside of it
+    Selection selection = getCanvasSelection(canvas);
+    SelectionLayer selectionLayer(activeLayer, selection, getLayerVisiblePos(activeLayer));
+
+    ILayer* layer = selection.isActive() ? &selectionLayer : activeLayer;
+
     for (double interpolatedPos = 1; interpolatedPos < 2; interpolatedPos += 0.01)
     {
         vec2d interpolatedPoint = interpolator_[interpolatedPos];
-        drawPoint(canvas, activeLayer, 
+        drawPoint(canvas, layer, 
                   vec2i{static_cast<int>(interpolatedPoint.x), static_cast<int>(interpolatedPoint.y)});
     }
 
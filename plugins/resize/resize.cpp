@@ -0,0 +1,257 @@
+#include "resize.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "api/api_sfm.hpp"
+#include "api/api_photoshop.hpp"
+#include "api/api_bar.hpp"
+#include "api/api_canvas.hpp"
+
+#include "pluginLib/actions/actions.hpp"
+#include "pluginLib/bars/ps_bar.hpp"
+#include "pluginLib/canvas/canvas.hpp"
+#include "pluginLib/filters/filterJobs.hpp"
+#include "pluginLib/filters/filterWindows.hpp"
+#include "pluginLib/filters/resampler.hpp"
+#include "pluginLib/filters/seamCarving.hpp"
+
+using namespace ps;
+using namespace psapi;
+using namespace psapi::sfm;
+
+namespace
+{
+
+const char* const kResizeTitle        = "Resize Layer";
+const char* const kContentAwareTitle  = "Content-Aware Scale";
+
+// indexed by the "Method" slider
+const ResampleFilter kResizeFilters[] = {
+    ResampleFilter::Nearest,
+    ResampleFilter::Bilinear,
+    ResampleFilter::Bicubic,
+    ResampleFilter::Lanczos3,
+};
+
+const size_t kResizeFiltersCount = sizeof(kResizeFilters) / sizeof(kResizeFilters[0]);
+
+// Layer keeps its size, resized image is placed at the top left corner,
+// the part that doesn't fit is cropped and the freed part becomes transparent.
+// The first two sliders are the width and the height in percents, the rest go to the resizer.
+class ResizeLayerButton : public ANamedBarButton
+{
+public:
+    using Resizer = std::function<Pixels2D(const Pixels2D& pixels, const vec2u& size,
+                                           const std::vector<float>& parameters)>;
+
+    ResizeLayerButton(std::unique_ptr<IText> name, std::unique_ptr<IFont> font, const std::string& title,
+                      std::vector<SliderParameters> sliders, Resizer resizer);
+
+    std::unique_ptr<IAction> createAction(const IRenderWindow* renderWindow,
+                                          const Event& event) override;
+
+    bool update(const IRenderWindow* renderWindow, const Event& event);
+    void draw(IRenderWindow* renderWindow) override;
+
+private:
+    void resize(ICanvas* canvas, const std::vector<float>& parameters);
+
+private:
+    std::string title_;
+    std::vector<SliderParameters> sliders_;
+    Resizer resizer_;
+
+    std::unique_ptr<FilterWindow> resizeWindow_;
+
+    std::shared_ptr<FilterJob> job_;
+};
+
+unsigned getScaledSize(unsigned size, float percents)
+{
+    long scaled = std::lround(static_cast<float>(size) * percents / 100.f);
+
+    return static_cast<unsigned>(std::max(scaled, 1l));
+}
+
+Pixels2D placeOnFrame(Pixels2D pixels, const vec2u& frameSize)
+{
+    const Color transparent{0, 0, 0, 0};
+
+    pixels.resize(frameSize.y);
+
+    for (std::vector<Color>& row : pixels)
+        row.resize(frameSize.x, transparent);
+
+    return pixels;
+}
+
+// parameters - method
+Pixels2D resampleLayer(const Pixels2D& pixels, const vec2u& size, const std::vector<float>& parameters)
+{
+    assert(parameters.size() == 3);
+
+    long method = std::clamp(std::lround(parameters[2]), 0l, static_cast<long>(kResizeFiltersCount - 1));
+
+    return resample(pixels, size, kResizeFilters[method]);
+}
+
+// only shrinks, seams can't be added
+Pixels2D carveLayer(const Pixels2D& pixels, const vec2u& size, const std::vector<float>& /* parameters */)
+{
+    return carveSeams(pixels, size);
+}
+
+ResizeLayerButton::ResizeLayerButton(std::unique_ptr<IText> name, std::unique_ptr<IFont> font,
+                                     const std::string& title, std::vector<SliderParameters> sliders,
+                                     Resizer resizer)
+    : title_(title), sliders_(std::move(sliders)), resizer_(std::move(resizer))
+{
+    name_ = std::move(name);
+    font_ = std::move(font);
+
+    name_->setString(title_);
+}
+
+std::unique_ptr<IAction> ResizeLayerButton::createAction(const IRenderWindow* renderWindow,
+                                                         const Event& event)
+{
+    return std::make_unique<UpdateCallbackAction<ResizeLayerButton>>(*this, renderWindow, event);
+}
+
+bool ResizeLayerButton::update(const IRenderWindow* renderWindow, const Event& event)
+{
+    bool updateStateRes = updateState(renderWindow, event);
+
+    if (state_ != State::Released)
+    {
+        if (resizeWindow_)
+        {
+            resizeWindow_->close();
+            resizeWindow_.reset();
+        }
+
+        return updateStateRes;
+    }
+
+    if (updateStateRes)
+        resizeWindow_ = createSlidersFilterWindow(title_.c_str(), sliders_);
+
+    assert(resizeWindow_);
+
+    AActionController* actionController = getActionController();
+
+    if (!actionController->execute(resizeWindow_->createAction(renderWindow, event)))
+    {
+        if (resizeWindow_->isConfirmed())
+        {
+            ICanvas* canvas = static_cast<ICanvas*>(getRootWindow()->getWindowById(kCanvasWindowId));
+            assert(canvas);
+
+            resize(canvas, getSlidersValues(resizeWindow_.get(), sliders_));
+        }
+
+        resizeWindow_.reset();
+        state_ = State::Normal;
+        return false;
+    }
+
+    return true;
+}
+
+void ResizeLayerButton::resize(ICanvas* canvas, const std::vector<float>& parameters)
+{
+    assert(parameters.size() >= 2);
+
+    if (job_ && !job_->isDone())
+        return;
+
+    size_t layerIndex = canvas->getActiveLayerIndex();
+    const ILayer* layer = canvas->getLayer(layerIndex);
+    assert(layer);
+
+    vec2u fullSize = getLayerFullSize(layer, canvas->getSize());
+    vec2u newSize  = {getScaledSize(fullSize.x, parameters[0]), getScaledSize(fullSize.y, parameters[1])};
+
+    auto source = std::make_shared<Pixels2D>(getLayerRegion(layer, IntRect{{0, 0}, fullSize}));
+
+    job_ = getFilterJobsWindow()->submit(
+        [source, newSize, fullSize, resizer = resizer_, parameters]()
+        {
+            return placeOnFrame(resizer(*source, newSize, parameters), fullSize);
+        },
+        [canvas, layerIndex](const Pixels2D& result)
+        {
+            if (layerIndex >= canvas->getNumLayers())
+                return;
+
+            auto saving = std::make_unique<CanvasSaverAction>();
+            saving->setPastSnapshot(canvas->save());
+
+            setLayerRegion(canvas->getLayer(layerIndex), vec2i{0, 0}, result);
+
+            saving->setFutureSnapshot(canvas->save());
+            getActionController()->execute(std::move(saving));
+        });
+}
+
+void ResizeLayerButton::draw(IRenderWindow* renderWindow)
+{
+    std::string title = title_;
+
+    if (job_ && !job_->isDone())
+        title += " " + std::to_string(static_cast<int>(job_->getProgress() * 100.f)) + "%";
+
+    name_->setString(title);
+
+    ANamedBarButton::draw(renderWindow);
+
+    if (resizeWindow_)
+        resizeWindow_->draw(renderWindow);
+}
+
+void addResizeButton(IMenuButton* menu, const std::string& title, std::vector<SliderParameters> sliders,
+                     ResizeLayerButton::Resizer resizer)
+{
+    std::unique_ptr<IText> text = IText::create();
+    std::unique_ptr<IFont> font = IFont::create();
+    font->loadFromFile("assets/fonts/arial.ttf");
+    text->setFont(font.get());
+
+    menu->addMenuItem(std::make_unique<ResizeLayerButton>(std::move(text), std::move(font), title,
+                                                          std::move(sliders), std::move(resizer)));
+}
+
+} // namespace anonymous
+
+bool onLoadPlugin()
+{
+    IWindowContainer* rootWindow = getRootWindow();
+    assert(rootWindow);
+    auto layerMenu = dynamic_cast<IMenuButton*>(rootWindow->getWindowById(kMenuLayerId));
+    assert(layerMenu);
+
+    const float maxMethod = static_cast<float>(kResizeFiltersCount - 1);
+
+    addResizeButton(layerMenu, kResizeTitle,
+                    {{"Width %: ", 10, 400, 100},
+                     {"Height %: ", 10, 400, 100},
+                     {"Method: ", 0, maxMethod, maxMethod}},
+                    resampleLayer);
+
+    addResizeButton(layerMenu, kContentAwareTitle,
+                    {{"Width %: ", 10, 100, 100},
+                     {"Height %: ", 10, 100, 100}},
+                    carveLayer);
+
+    return true;
+}
+
+void onUnloadPlugin()
+{
+    return;
+}
@@ -0,0 +1,12 @@
+#ifndef PLUGINS_RESIZE_RESIZE_HPP
+#define PLUGINS_RESIZE_RESIZE_HPP
+
+extern "C"
+{
+
+bool onLoadPlugin();
+void onUnloadPlugin();
+
+}
+
+#endif // PLUGINS_RESIZE_RESIZE_HPP
@@ -0,0 +1,251 @@
+#include "selectionTools.hpp"
+
+#include <cassert>
+#include <vector>
+
+#include "api/api_sfm.hpp"
+#include "api/api_photoshop.hpp"
+#include "api/api_bar.hpp"
+#include "api/api_canvas.hpp"
+
+#include "pluginLib/actions/actions.hpp"
+#include "pluginLib/canvas/canvas.hpp"
+#include "pluginLib/selection/selection.hpp"
+#include "pluginLib/selection/selectionMask.hpp"
+#include "pluginLib/toolbar/toolbarButton.hpp"
+
+using namespace ps;
+using namespace psapi;
+using namespace psapi::sfm;
+
+namespace
+{
+
+// Shift adds to the selection, Alt subtracts, both keep only the intersection
+enum class SelectionOperation
+{
+    Replace,
+    Unite,
+    Subtract,
+    Intersect,
+};
+
+SelectionOperation getSelectionOperation()
+{
+    bool shift = Keyboard::isKeyPressed(Keyboard::Key::LShift) || Keyboard::isKeyPressed(Keyboard::Key::RShift);
+    bool alt   = Keyboard::isKeyPressed(Keyboard::Key::LAlt)   || Keyboard::isKeyPressed(Keyboard::Key::RAlt);
+
+    if (shift && alt)
+        return SelectionOperation::Intersect;
+    if (shift)
+        return SelectionOperation::Unite;
+    if (alt)
+        return SelectionOperation::Subtract;
+
+    return SelectionOperation::Replace;
+}
+
+SelectionMask applySelectionOperation(const SelectionMask& current, const SelectionMask& mask, 
+                                      SelectionOperation operation)
+{
+    switch (operation)
+    {
+        case SelectionOperation::Unite:     return current.unite(mask);
+        case SelectionOperation::Subtract:  return current.subtract(mask);
+        case SelectionOperation::Intersect: return current.intersect(mask);
+
+        case SelectionOperation::Replace:
+        default:
+            return mask;
+    }
+}
+
+// Drag on the canvas selects the shape of the mouse path, click without drag removes the selection.
+// Thickness option is the feather radius.
+class SelectionButton : public AInstrumentButton
+{
+public:
+    SelectionButton(std::unique_ptr<ISprite> sprite, std::unique_ptr<ITexture> texture);
+
+    std::unique_ptr<IAction> createAction(const IRenderWindow* renderWindow, const Event& event) override;
+    bool update(const IRenderWindow* renderWindow, const Event& event);
+    void draw(IRenderWindow* renderWindow) override;
+
+protected:
+    // points - mouse path in the full layer coordinates
+    virtual SelectionMask createMask(const std::vector<vec2i>& points) const = 0;
+
+private:
+    void drawPreview(ILayer* tempLayer, const vec2i& visiblePos);
+    void erasePreview(ILayer* tempLayer);
+    void finishSelection(ICanvas* canvas, ILayer* activeLayer);
+
+private:
+    bool isSelecting_ = false;
+    SelectionOperation operation_ = SelectionOperation::Replace;
+    std::vector<vec2i> points_;
+
+    SelectionMask previewOutline_;
+    vec2i previewVisiblePos_;
+};
+
+SelectionButton::SelectionButton(std::unique_ptr<ISprite> sprite, std::unique_ptr<ITexture> texture)
+{
+    mainSprite_ = std::move(sprite);
+    mainTexture_ = std::move(texture);
+}
+
+std::unique_ptr<IAction> SelectionButton::createAction(const IRenderWindow* renderWindow, const Event& event)
+{
+    return std::make_unique<UpdateCallbackAction<SelectionButton>>(*this, renderWindow, event);
+}
+
+bool SelectionButton::update(const IRenderWindow* renderWindow, const Event& event)
+{
+    State prevState = state_;
+    bool updateStateRes = updateState(renderWindow, event);
+
+    updateOptionsBar(state_, prevState);
+
+    if (state_ != State::Released)
+        return updateStateRes;
+
+    ICanvas* canvas = static_cast<ICanvas*>(getRootWindow()->getWindowById(kCanvasWindowId));
+    assert(canvas);
+
+    ILayer* activeLayer = canvas->getLayer(canvas->getActiveLayerIndex());
+    vec2i visiblePos = getLayerVisiblePos(activeLayer);
+
+    if (!canvas->isPressedLeftMouseButton())
+    {
+        if (isSelecting_)
+            finishSelection(canvas, activeLayer);
+
+        return updateStateRes;
+    }
+
+    if (!isSelecting_)
+    {
+        isSelecting_ = true;
+        operation_ = getSelectionOperation();
+        points_.clear();
+    }
+
+    vec2i mousePos = canvas->getMousePosition() + visiblePos;
+
+    if (points_.empty() || points_.back().x != mousePos.x || points_.back().y != mousePos.y)
+    {
+        points_.push_back(mousePos);
+        drawPreview(canvas->getTempLayer(), visiblePos);
+    }
+
+    return true;
+}
+
+void SelectionButton::draw(IRenderWindow* renderWindow)
+{
+    ASpritedBarButton::draw(renderWindow);
+}
+
+void SelectionButton::drawPreview(ILayer* tempLayer, const vec2i& visiblePos)
+{
+    erasePreview(tempLayer);
+
+    previewOutline_ = createMask(points_).getOutline();
+    previewVisiblePos_ = visiblePos;
+
+    const Color previewColor{0, 0, 0, 255};
+
+    for (int y = previewOutline_.getTop(); y < previewOutline_.getBottom(); ++y)
+        for (const SelectionSpan& span : previewOutline_.getRow(y))
+            for (int x = span.begin; x < span.end; ++x)
+                tempLayer->setPixel(vec2i{x, y} - visiblePos, previewColor);
+}
+
+void SelectionButton::erasePreview(ILayer* tempLayer)
+{
+    const Color transparent{0, 0, 0, 0};
+
+    for (int y = previewOutline_.getTop(); y < previewOutline_.getBottom(); ++y)
+        for (const SelectionSpan& span : previewOutline_.getRow(y))
+            for (int x = span.begin; x < span.end; ++x)
+                tempLayer->setPixel(vec2i{x, y} - previewVisiblePos_, transparent);
+
+    previewOutline_ = SelectionMask{};
+}
+
+void SelectionButton::finishSelection(ICanvas* canvas, ILayer* activeLayer)
+{
+    erasePreview(canvas->getTempLayer());
+    isSelecting_ = false;
+
+    // click without drag
+    if (points_.size() < 2 && operation_ == SelectionOperation::Replace)
+    {
+        setCanvasSelection(canvas, Selection{});
+        return;
+    }
+
+    SelectionMask mask = createMask(points_).clip(getLayerFullSize(activeLayer, canvas->getSize()));
+    mask = applySelectionOperation(getCanvasSelection(canvas).getMask(), mask, operation_);
+
+    assert(thicknessOption_);
+    unsigned featherRadius = static_cast<unsigned>(thicknessOption_->getThickness());
+
+    setCanvasSelection(canvas, Selection{std::move(mask), featherRadius});
+}
+
+class RectangleSelectionButton : public SelectionButton
+{
+public:
+    using SelectionButton::SelectionButton;
+
+protected:
+    SelectionMask createMask(const std::vector<vec2i>& points) const override
+    {
+        assert(!points.empty());
+        return SelectionMask::createRectangle(points.front(), points.back());
+    }
+};
+
+class EllipseSelectionButton : public SelectionButton
+{
+public:
+    using SelectionButton::SelectionButton;
+
+protected:
+    SelectionMask createMask(const std::vector<vec2i>& points) const override
+    {
+        assert(!points.empty());
+        return SelectionMask::createEllipse(points.front(), points.back());
+    }
+};
+
+// mouse path is closed by the straight line to its beginning
+class LassoSelectionButton : public SelectionButton
+{
+public:
+    using SelectionButton::SelectionButton;
+
+protected:
+    SelectionMask createMask(const std::vector<vec2i>& points) const override
+    {
+        return SelectionMask::createPolygon(points);
+    }
+};
+
+} // namespace anonymous
+
+bool onLoadPlugin()
+{
+    using namespace instrument_button_functions;
+
+    return instrumentButtonOnLoadPlugin<RectangleSelectionButton>("assets/textures/rectSelection.png")    &&
+           instrumentButtonOnLoadPlugin<EllipseSelectionButton>  ("assets/textures/ellipseSelection.png") &&
+           instrumentButtonOnLoadPlugin<LassoSelectionButton>    ("assets/textures/lassoSelection.png");
+}
+
+void onUnloadPlugin()
+{
+    return;
+}
@@ -0,0 +1,12 @@
+#ifndef PLUGINS_SELECTION_TOOLS_SELECTION_TOOLS_HPP
+#define PLUGINS_SELECTION_TOOLS_SELECTION_TOOLS_HPP
+
+extern "C"
+{
+
+bool onLoadPlugin();
+void onUnloadPlugin();
+
+}
+
+#endif // PLUGINS_SELECTION_TOOLS_SELECTION_TOOLS_HPP
@@ -4,20 +4,20 @@
 
 #include <string>
 #include <cassert>
+#include <cmath>
 
 #include "api/api_sfm.hpp"
 #include "api/api_photoshop.hpp"
 #include "api/api_bar.hpp"
 #include "api/api_canvas.hpp"
 
-#include "pluginLib/actions/actions.hpp"
 #include "pluginLib/canvas/canvas.hpp"
 #include "pluginLib/bars/ps_bar.hpp"
 #include "pluginLib/windows/windows.hpp"
 
 #include "pluginLib/filters/filters.hpp"
-
-#include <iostream>
+#include "pluginLib/filters/gaussianBlur.hpp"
+#include "pluginLib/filters/sliderFilterButton.hpp"
 
 using namespace ps;
 using namespace psapi;
@@ -26,52 +26,24 @@ using namespace psapi::sfm;
 namespace
 {
 
-class BasReliefButton : public ANamedBarButton 
-{
-public:
-    BasReliefButton(std::unique_ptr<IText> name, std::unique_ptr<IFont> font);
-
-    std::unique_ptr<IAction> createAction(const IRenderWindow* renderWindow, 
-                                          const Event& event) override;
-    
-    bool update(const IRenderWindow* renderWindow, const Event& event);
-};
+const char* const kUnsharpMaskTitle = "Unsharp Mask";
 
-BasReliefButton::BasReliefButton(std::unique_ptr<IText> name, std::unique_ptr<IFont> font)
+// parameters - amount in percents, radius, threshold in levels
+std::vector<std::vector<Color>> unsharpMaskFilter(const std::vector<std::vector<Color>>& pixels,
+                                                  const std::vector<float>& parameters, float scale)
 {
-    name_ = std::move(name);
-    font_ = std::move(font);
-}
+    assert(parameters.size() == 3);
 
-std::unique_ptr<IAction> BasReliefButton::createAction(const IRenderWindow* renderWindow, 
-                                                        const Event& event)
-{
-    return std::make_unique<UpdateCallbackAction<BasReliefButton>>(*this, renderWindow, event);
+    int threshold = static_cast<int>(std::lround(parameters[2]));
+
+    return getUnsharpMasked(pixels, parameters[0], parameters[1] * scale, threshold);
 }
 
-bool BasReliefButton::update(const IRenderWindow* renderWindow, const Event& event)
+size_t unsharpMaskHalo(const std::vector<float>& parameters)
 {
-    bool updateStateRes = updateState(renderWindow, event);
-
-    if (state_ != State::Released)
-        return updateStateRes;
+    assert(parameters.size() == 3);
 
-    ICanvas* canvas = static_cast<ICanvas*>(getRootWindow()->getWindowById(kCanvasWindowId));
-    assert(canvas);
-    
-    size_t activeLayerIndex = canvas->getActiveLayerIndex();
-    ILayer* activeLayer = canvas->getLayer(activeLayerIndex);
-
-    vec2u canvasSize = canvas->getSize();
-
-    std::vector<std::vector<Color>> pixels = getLayerScreenIn2D(activeLayer, canvasSize);
-    std::vector<std::vector<Color>> masked = getUnsharpMasked(pixels);
-    
-    copyPixelsToLayer(activeLayer, masked);
-    
-    state_ = State::Normal;
-
-    return true;
+    return getGaussianReach(parameters[1]);
 }
 
 } // namespace anonymous
@@ -82,9 +54,16 @@ bool onLoadPlugin()
     std::unique_ptr<IFont> font = IFont::create();
     font->loadFromFile("assets/fonts/arial.ttf");
     text->setFont(font.get());
-    text->setString("Unsharp Mask");
-    
-    auto button = std::make_unique<BasReliefButton>(std::move(text), std::move(font));
+
+    const float maxAmount    = 500;
+    const float maxRadius    = 50;
+    const float maxThreshold = 255;
+    std::vector<SliderParameters> sliders = {{"Amount %: ",  0, maxAmount,    100},
+                                             {"Radius: ",    1, maxRadius,    2},
+                                             {"Threshold: ", 0, maxThreshold, 0}};
+
+    auto button = std::make_unique<SliderFilterButton>(std::move(text), std::move(font), kUnsharpMaskTitle,
+                                                       std::move(sliders), unsharpMaskFilter, unsharpMaskHalo);
 
     IWindowContainer* rootWindow = getRootWindow();
     assert(rootWindow);
@@ -100,4 +79,3 @@ void onUnloadPlugin()
 {
     return;
 }
-
@@ -49,6 +49,7 @@ int main()
     loadPlugin("libs/lib_line.dylib");
     loadPlugin("libs/lib_ellipse.dylib");
     loadPlugin("libs/lib_rectangle.dylib");
+    loadPlugin("libs/lib_selection_tools.dylib");
     loadPlugin("libs/lib_negative_filter.dylib");
     loadPlugin("libs/lib_blur_filter.dylib");
     loadPlugin("libs/lib_file_loader.dylib");
@@ -56,6 +57,18 @@ int main()
     loadPlugin("libs/lib_bas_relief.dylib");
     loadPlugin("libs/lib_unsharp_mask.dylib");
     loadPlugin("libs/lib_brightness.dylib");
+    loadPlugin("libs/lib_convolution_filters.dylib");
+    loadPlugin("libs/lib_median_filter.dylib");
+    loadPlugin("libs/lib_mosaic.dylib");
+    loadPlugin("libs/lib_adaptive_threshold.dylib");
+    loadPlugin("libs/lib_morphology.dylib");
+    loadPlugin("libs/lib_indexed_color.dylib");
+    loadPlugin("libs/lib_color_lookup.dylib");
+    loadPlugin("libs/lib_levels.dylib");
+    loadPlugin("libs/lib_hue_saturation.dylib");
+    loadPlugin("libs/lib_resize.dylib");
+    loadPlugin("libs/lib_free_transform.dylib");
+    loadPlugin("libs/lib_layer_effects.dylib");
 
     IRenderWindow* renderWindow = rootWindow->getRenderWindow();
     assert(renderWindow);